@@ -0,0 +1,35 @@
+/***********************************************************************
+ * Header:
+ *    ALLOCATOR STATS
+ * Summary:
+ *    What a node allocator is holding, in the same shape for every
+ *    allocator that can tell. The gap between bytes_requested and
+ *    bytes_in_blocks is rounding; the gap between bytes_in_blocks and
+ *    bytes_reserved is memory taken from the system and not in use,
+ *    either freed and waiting for reuse or never handed out.
+ *
+ *    This will contain the class definition of:
+ *        allocator_stats : A snapshot of an allocator's memory
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>     // for size_t
+
+namespace custom
+{
+
+/**************************************************
+ * ALLOCATOR STATS
+ * A snapshot, taken by the allocator's stats()
+ **************************************************/
+struct allocator_stats
+{
+   size_t live_blocks;      // handed out and not yet freed
+   size_t peak_blocks;      // the most that were ever live at once
+   size_t bytes_requested;  // what the live blocks were asked to hold
+   size_t bytes_in_blocks;  // what the live blocks take up, rounding included
+   size_t bytes_reserved;   // taken from the system, live or not
+};
+
+} // namespace custom
@@ -0,0 +1,79 @@
+/***********************************************************************
+ * Header:
+ *    BENCH ALLOCATOR
+ * Summary:
+ *    Compare std::allocator with magazine_allocator when many threads
+ *    each build and tear down their own lists at the same time. With
+ *    std::allocator every node goes through the global heap; with
+ *    magazine_allocator nearly every node comes from the thread's own
+ *    cache.
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"          // timing harness
+#include "list.h"               // the list being filled
+#include "magazineAllocator.h"  // allocator under test
+
+#include <cstdio>               // for printf
+#include <memory>               // for std::allocator
+
+/**************************************************
+ * PRODUCE
+ * One producer thread: fill a list, empty it from
+ * the front so nodes are freed in a different order
+ * than they were allocated, and repeat
+ **************************************************/
+template <typename A>
+void benchProduce(size_t numItems, int numRounds)
+{
+   custom::list<int, A> l;
+   for (int round = 0; round < numRounds; round++)
+   {
+      for (size_t i = 0; i < numItems; i++)
+         l.push_back((int)i);
+      l.remove_if([](int value) { return value % 2 == 0; });
+      for (size_t i = 0; i < numItems / 2; i++)
+         l.push_back((int)i);
+      l.clear();
+   }
+}
+
+/**************************************************
+ * BENCH ALLOCATOR
+ * 1, 8 and 32 producers, each with its own list
+ **************************************************/
+inline void benchAllocator()
+{
+   const size_t numItems  = 100000;
+   const int    numRounds = 4;
+   const unsigned int threadCounts[] = { 1, 8, 32 };
+
+   printf("Allocator: %d rounds of %d pushes per producer thread\n",
+          numRounds, (int)(numItems + numItems / 2));
+   for (unsigned int numThreads : threadCounts)
+   {
+      double items = (double)numThreads * numRounds * (numItems + numItems / 2);
+      char name[64];
+
+      double seconds = custom::bench::bestOf(3, [&]()
+      {
+         return custom::bench::timeThreads(numThreads, [&](unsigned int)
+         {
+            benchProduce<std::allocator<int>>(numItems, numRounds);
+         });
+      });
+      snprintf(name, sizeof(name), "%-26s %2u threads", "std::allocator", numThreads);
+      custom::bench::report(name, seconds, items);
+
+      seconds = custom::bench::bestOf(3, [&]()
+      {
+         return custom::bench::timeThreads(numThreads, [&](unsigned int)
+         {
+            benchProduce<custom::magazine_allocator<int>>(numItems, numRounds);
+         });
+      });
+      snprintf(name, sizeof(name), "%-26s %2u threads", "custom::magazine_allocator", numThreads);
+      custom::bench::report(name, seconds, items);
+   }
+}
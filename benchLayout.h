@@ -0,0 +1,121 @@
+/***********************************************************************
+ * Header:
+ *    BENCH LAYOUT
+ * Summary:
+ *    Compare the three node layouts for a 256-byte payload. Counting
+ *    the nodes only follows pNext, so it should cost one cache line
+ *    per node when the links share the node with the payload, and far
+ *    less when the payload lives out of line and the nodes are packed
+ *    together. Summing a field of every payload shows the price of the
+ *    extra hop the out-of-line layout pays when the data is wanted.
+ *
+ *    Nodes and payloads only end up apart when the allocator keeps
+ *    blocks of different sizes apart, so every layout is timed with
+ *    both std::allocator and magazine_allocator.
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"          // timing harness
+#include "list.h"               // the list being walked
+#include "magazineAllocator.h"  // size-segregated allocator
+
+#include <cstdint>              // for std::uint64_t
+#include <cstdio>               // for printf
+#include <memory>               // for std::allocator
+
+/**************************************************
+ * RECORD
+ * A 256-byte payload. Each Layout gets its own type
+ * so node_layout can be specialized for it
+ **************************************************/
+template <typename Layout>
+struct BenchRecord
+{
+   std::uint64_t key;
+   char          pad[248];
+};
+
+namespace custom
+{
+template <typename Layout>
+struct node_layout <BenchRecord<Layout>>
+{
+   typedef Layout type;
+};
+}
+
+/**************************************************
+ * WALK
+ * Fill a list, then time a pure link walk and a walk
+ * that reads every payload
+ **************************************************/
+template <typename Layout, typename A>
+void benchWalk(const char * layoutName, const char * allocName,
+               size_t numItems, int numWalks)
+{
+   typedef BenchRecord<Layout> Record;
+   custom::list<Record, typename std::allocator_traits<A>::template rebind_alloc<Record>> l;
+   l.push_back_n(numItems, [&]()
+   {
+      static std::uint64_t key = 0;
+      Record r;
+      r.key = key++;
+      return r;
+   });
+
+   volatile size_t sink = 0;
+   double items = (double)numItems * numWalks;
+   char name[64];
+
+   double seconds = custom::bench::bestOf(3, [&]()
+   {
+      return custom::bench::timeOnce([&]()
+      {
+         for (int walk = 0; walk < numWalks; walk++)
+         {
+            size_t num = 0;
+            for (auto it = l.cbegin(); it != l.cend(); ++it)
+               num++;
+            sink = num;
+         }
+      });
+   });
+   snprintf(name, sizeof(name), "count %-20s %-10s", layoutName, allocName);
+   custom::bench::report(name, seconds, items);
+
+   seconds = custom::bench::bestOf(3, [&]()
+   {
+      return custom::bench::timeOnce([&]()
+      {
+         for (int walk = 0; walk < numWalks; walk++)
+         {
+            std::uint64_t sum = 0;
+            for (const Record & r : l)
+               sum += r.key;
+            sink = (size_t)sum;
+         }
+      });
+   });
+   snprintf(name, sizeof(name), "sum   %-20s %-10s", layoutName, allocName);
+   custom::bench::report(name, seconds, items);
+}
+
+/**************************************************
+ * BENCH LAYOUT
+ * Every layout with each allocator
+ **************************************************/
+inline void benchLayout()
+{
+   const size_t numItems = 200000;
+   const int    numWalks = 10;
+
+   printf("Layout: %d walks of %d nodes with a %d-byte payload\n",
+          numWalks, (int)numItems, (int)sizeof(BenchRecord<custom::links_first>));
+   benchWalk<custom::payload_first,       std::allocator<int>>("payload_first",       "std",      numItems, numWalks);
+   benchWalk<custom::links_first,         std::allocator<int>>("links_first",         "std",      numItems, numWalks);
+   benchWalk<custom::payload_out_of_line, std::allocator<int>>("payload_out_of_line", "std",      numItems, numWalks);
+   benchWalk<custom::payload_first,       custom::magazine_allocator<int>>("payload_first",       "magazine", numItems, numWalks);
+   benchWalk<custom::links_first,         custom::magazine_allocator<int>>("links_first",         "magazine", numItems, numWalks);
+   benchWalk<custom::payload_out_of_line, custom::magazine_allocator<int>>("payload_out_of_line", "magazine", numItems, numWalks);
+}
@@ -0,0 +1,106 @@
+/***********************************************************************
+ * Header:
+ *    BENCH RECLAMATION
+ * Summary:
+ *    Churn a lock-free stack from 32 threads, each pushing and popping
+ *    as fast as it can, once over each reclamation domain. Alongside
+ *    the throughput, a monitor samples how many popped nodes are
+ *    waiting to be freed, which is the memory the domain costs.
+ *
+ *    Each domain is then run again with one more thread stalled in the
+ *    middle of an operation, the way a preempted thread would be. Hazard
+ *    pointers let it pin only the node it published, so the backlog
+ *    stays bounded; epochs cannot move on past it, so the backlog grows
+ *    with every pop until it wakes.
+ ************************************************************************/
+
+#pragma once
+
+#include "benchmark.h"       // timing harness
+#include "lockfreeStack.h"   // the container being churned
+#include "reclamation.h"     // the domains being compared
+
+#include <atomic>            // for std::atomic
+#include <chrono>            // for std::chrono::milliseconds
+#include <cstdio>            // for printf
+#include <thread>            // for std::thread
+
+/**************************************************
+ * CHURN
+ * numThreads threads each push and pop numOps times
+ * while a monitor records the largest backlog
+ **************************************************/
+template <typename Domain>
+void benchChurn(const char * name, unsigned int numThreads, int numOps, bool stall)
+{
+   Domain domain;
+   custom::lockfree_stack<int, Domain> s(domain);
+   for (int i = 0; i < 1000; i++)
+      s.push(i);
+
+   std::atomic<bool> done(false);
+   std::atomic<bool> stalled(false);
+   size_t peak = 0;
+
+   // a thread caught part way through an operation until the run ends
+   std::thread staller([&]()
+   {
+      if (!stall)
+         return;
+      std::atomic<int *> src(nullptr);
+      int value = 0;
+      src.store(&value);
+      typename Domain::guard g(domain);
+      g.protect(0, src);
+      stalled = true;
+      while (!done)
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   });
+   while (stall && !stalled)
+      std::this_thread::yield();
+
+   std::thread monitor([&]()
+   {
+      while (!done)
+      {
+         size_t num = domain.num_pending();
+         if (num > peak)
+            peak = num;
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+   });
+
+   double seconds = custom::bench::timeThreads(numThreads, [&](unsigned int)
+   {
+      int value;
+      for (int i = 0; i < numOps; i++)
+      {
+         s.push(i);
+         s.pop(value);
+      }
+   });
+
+   done = true;
+   staller.join();
+   monitor.join();
+   custom::bench::report(name, seconds, 2.0 * numThreads * numOps);
+   printf("   %-40s %10d nodes waiting at most, %d at the end\n",
+          "", (int)peak, (int)domain.num_pending());
+}
+
+/**************************************************
+ * BENCH RECLAMATION
+ * Both domains, with and without a stalled thread
+ **************************************************/
+inline void benchReclamation()
+{
+   const unsigned int numThreads = 32;
+   const int          numOps     = 100000;
+
+   printf("Reclamation: %u threads each pushing and popping %d times\n",
+          numThreads, numOps);
+   benchChurn<custom::hazard_domain>("hazard pointers",          numThreads, numOps, false);
+   benchChurn<custom::epoch_domain> ("epochs",                   numThreads, numOps, false);
+   benchChurn<custom::hazard_domain>("hazard pointers, stalled", numThreads, numOps, true);
+   benchChurn<custom::epoch_domain> ("epochs, stalled",          numThreads, numOps, true);
+}
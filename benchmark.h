@@ -0,0 +1,111 @@
+/***********************************************************************
+ * Header:
+ *    BENCHMARK
+ * Summary:
+ *    A small timing harness for the benchmark driver. A benchmark is
+ *    a function that does some work and is timed a few times; the
+ *    fastest run is reported, since the slower ones mostly measure
+ *    whatever else the machine was doing.
+ *
+ *    This will contain the definitions of:
+ *        timeOnce    : how long one call of a function takes
+ *        timeThreads : run a function on several threads at once
+ *        bestOf      : the fastest of several timings
+ *        report      : print one line of results
+ ************************************************************************/
+
+#pragma once
+
+#include <chrono>              // for std::chrono::steady_clock
+#include <condition_variable>  // for std::condition_variable
+#include <cstdio>              // for printf
+#include <mutex>               // for std::mutex
+#include <thread>              // for std::thread
+#include <vector>              // for std::vector
+
+namespace custom
+{
+namespace bench
+{
+
+/**************************************************
+ * TIME ONCE
+ * Call f() and return how many seconds it took
+ **************************************************/
+template <typename F>
+double timeOnce(F f)
+{
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   f();
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   return elapsed.count();
+}
+
+/**************************************************
+ * TIME THREADS
+ * Call f(threadIndex) on numThreads threads that
+ * all start together, and return the seconds until
+ * the last one is done. Thread startup is not timed
+ **************************************************/
+template <typename F>
+double timeThreads(unsigned int numThreads, F f)
+{
+   std::vector<std::thread> threads;
+   threads.reserve(numThreads);
+   std::mutex lock;
+   std::condition_variable go;
+   bool started = false;
+
+   for (unsigned int i = 0; i < numThreads; i++)
+      threads.emplace_back([&, i]()
+      {
+         {
+            std::unique_lock<std::mutex> guard(lock);
+            go.wait(guard, [&]() { return started; });
+         }
+         f(i);
+      });
+
+   std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      started = true;
+   }
+   go.notify_all();
+   for (std::thread & t : threads)
+      t.join();
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+   return elapsed.count();
+}
+
+/**************************************************
+ * BEST OF
+ * Call time() numRuns times and return the smallest
+ * number of seconds it reported
+ **************************************************/
+template <typename F>
+double bestOf(int numRuns, F time)
+{
+   double best = time();
+   for (int run = 1; run < numRuns; run++)
+   {
+      double seconds = time();
+      if (seconds < best)
+         best = seconds;
+   }
+   return best;
+}
+
+/**************************************************
+ * REPORT
+ * One line of results: what was measured, how long
+ * it took, and the rate in millions of items per second
+ **************************************************/
+inline void report(const char * name, double seconds, double numItems)
+{
+   printf("   %-40s %10.2f ms %10.2f M items/s\n",
+          name, seconds * 1000.0, numItems / seconds / 1.0e6);
+}
+
+} // namespace bench
+} // namespace custom
@@ -0,0 +1,479 @@
+/***********************************************************************
+ * Header:
+ *    CHANNEL
+ * Summary:
+ *    A queue between coroutines. A stage hands an item to the next one
+ *    with co_await ch.send(value) and takes one with co_await ch.recv().
+ *    When the buffer is full the sender is suspended, and when it is
+ *    empty the receiver is. Neither blocks the thread it runs on, so
+ *    thousands of stages can share a handful of threads.
+ *
+ *    Items wait in a custom::list. A channel may be given a capacity
+ *    so that a fast producer is held back until the consumer catches
+ *    up; by default it is unbounded.
+ *
+ *    A suspended coroutine is resumed on whichever thread made it
+ *    ready: the sender that filled an empty channel, the receiver that
+ *    drained a full one, or the caller of close(). It is resumed after
+ *    the channel's lock is released, so it may use the channel again
+ *    at once.
+ *
+ *    Waking is a hand-off. The first wake on a thread resumes the woken
+ *    coroutine and then drains a per-thread ready queue. A wake from
+ *    inside that queues the waker and transfers straight to the woken
+ *    coroutine with symmetric transfer. A waiting coroutine transfers
+ *    to the next ready one. So a pipeline of any length runs at the
+ *    same stack depth, wherever the compiler makes that transfer a
+ *    tail call: clang always does, GCC only when optimizing.
+ *
+ *    A channel must outlive every coroutine waiting on it.
+ *
+ *    This needs C++20 coroutines. Without them this header is empty.
+ *
+ *    This will contain the class definition of:
+ *        handoff               : Who runs next when a coroutine wakes another
+ *        channel               : A queue between coroutines
+ *        channel::SendAwaiter  : What co_await ch.send(value) waits on
+ *        channel::RecvAwaiter  : What co_await ch.recv() waits on
+ ************************************************************************/
+
+#pragma once
+
+#ifdef __has_include
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define CHANNEL_HAS_COROUTINES
+#endif
+#endif
+
+#ifdef CHANNEL_HAS_COROUTINES
+
+#include <coroutine>   // for std::coroutine_handle
+#include <cstddef>     // for size_t
+#include <limits>      // for std::numeric_limits
+#include <mutex>       // for std::mutex
+#include <optional>    // for std::optional
+#include <utility>     // for std::move
+#include "list.h"      // for list
+
+namespace custom
+{
+
+/**************************************************
+ * HANDOFF
+ * Resumes the coroutines a channel wakes without
+ * nesting one resumption inside another
+ **************************************************/
+class handoff
+{
+public:
+   // h carries on and hWake is ready too: what to resume now
+   static std::coroutine_handle<> wake(std::coroutine_handle<> h,
+                                       std::coroutine_handle<> hWake);
+
+   // the same, from code that is not a coroutine
+   static void wake(std::coroutine_handle<> hWake);
+
+   // h is waiting: what to resume instead
+   static std::coroutine_handle<> idle();
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   static void run(std::coroutine_handle<> hWake);
+
+   static inline thread_local bool running = false;                  // run() is on the stack
+   static inline thread_local list <std::coroutine_handle<>> ready;   // for run() to resume in turn
+};
+
+/*****************************************
+ * HANDOFF :: WAKE
+ * Inside run(), queue the waker and transfer to the
+ * woken coroutine. Otherwise run the woken one here
+ * and carry on once everything it woke is done
+ ****************************************/
+inline std::coroutine_handle<> handoff::wake(std::coroutine_handle<> h,
+                                             std::coroutine_handle<> hWake)
+{
+   if (!hWake)
+      return h;
+   if (running)
+   {
+      ready.push_back(h);
+      return hWake;
+   }
+   run(hWake);
+   return h;
+}
+
+inline void handoff::wake(std::coroutine_handle<> hWake)
+{
+   if (!hWake)
+      return;
+   if (running)
+      ready.push_back(hWake);
+   else
+      run(hWake);
+}
+
+/*****************************************
+ * HANDOFF :: IDLE
+ * A waiting coroutine gives the thread to the next
+ * ready one, or back to whoever resumed it
+ ****************************************/
+inline std::coroutine_handle<> handoff::idle()
+{
+   if (running && !ready.empty())
+   {
+      std::coroutine_handle<> h = ready.front();
+      ready.pop_front();
+      return h;
+   }
+   return std::noop_coroutine();
+}
+
+/*****************************************
+ * HANDOFF :: RUN
+ * Resume hWake, then everything queued while it ran
+ ****************************************/
+inline void handoff::run(std::coroutine_handle<> hWake)
+{
+   running = true;
+   hWake.resume();
+   while (!ready.empty())
+   {
+      std::coroutine_handle<> h = ready.front();
+      ready.pop_front();
+      h.resume();
+   }
+   running = false;
+}
+
+/**************************************************
+ * CHANNEL
+ * A buffered queue whose send and receive suspend
+ * the calling coroutine instead of blocking
+ **************************************************/
+template <typename T, typename A = std::allocator<T>>
+class channel
+{
+public:
+   class SendAwaiter;
+   class RecvAwaiter;
+
+   // a channel that never makes a sender wait
+   static constexpr size_t UNBOUNDED = std::numeric_limits<size_t>::max();
+
+   //
+   // Construct
+   //
+
+   channel(size_t capacity = UNBOUNDED, const A & a = A());
+   channel(const channel &) = delete;
+   channel & operator = (const channel &) = delete;
+
+   //
+   // Send and receive
+   //
+
+   // co_await gives true once the item is in, false if the channel is closed
+   SendAwaiter send(T value) { return SendAwaiter(this, std::move(value)); }
+
+   // co_await gives the next item, or nothing once the channel is closed and drained
+   RecvAwaiter recv()        { return RecvAwaiter(this); }
+
+   // the same, for code that is not a coroutine and cannot wait
+   bool             try_send(T value);
+   std::optional<T> try_recv();
+
+   // wake every waiting coroutine; later sends fail, receives drain what is left
+   void close();
+
+   //
+   // Status
+   //
+
+   size_t size()      const;
+   bool   empty()     const { return size() == 0; }
+   bool   is_closed() const;
+   size_t capacity()  const { return maxItems; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+
+   // waiters are kept in the order they arrived, linked through their pNext
+   template <class Waiter>
+   struct WaitQueue
+   {
+      WaitQueue() : pHead(nullptr), pTail(nullptr) { }
+      bool empty() const { return pHead == nullptr; }
+      void push(Waiter * p)
+      {
+         p->pNext = nullptr;
+         (pTail ? pTail->pNext : pHead) = p;
+         pTail = p;
+      }
+      Waiter * pop()
+      {
+         Waiter * p = pHead;
+         pHead = p->pNext;
+         if (pHead == nullptr)
+            pTail = nullptr;
+         return p;
+      }
+      Waiter * pHead;
+      Waiter * pTail;
+   };
+
+   bool trySend(T & value, std::coroutine_handle<> & hWake);
+   bool tryRecv(std::optional<T> & slot, std::coroutine_handle<> & hWake);
+
+   mutable std::mutex       lock;       // guards everything below
+   list <T, A>              buffer;     // items sent but not yet received
+   size_t                   maxItems;   // the most buffer may hold
+   bool                     closed;     // no more sends
+   WaitQueue<SendAwaiter>   senders;    // waiting for room in buffer
+   WaitQueue<RecvAwaiter>   receivers;  // waiting for an item
+};
+
+/*************************************************
+ * CHANNEL SEND AWAITER
+ * Holds the item until there is room for it
+ ************************************************/
+template <typename T, typename A>
+class channel <T, A> ::SendAwaiter
+{
+   friend class channel <T, A>;
+public:
+   SendAwaiter(channel * pChannel, T && value) :
+      pChannel(pChannel), value(std::move(value)), sent(false), pNext(nullptr) { }
+
+   bool await_ready() const noexcept { return false; }
+
+   // deliver the item now if possible, otherwise wait in line
+   std::coroutine_handle<> await_suspend(std::coroutine_handle<> h)
+   {
+      std::coroutine_handle<> hWake;
+      {
+         std::lock_guard<std::mutex> guard(pChannel->lock);
+         if (!pChannel->trySend(value, hWake))
+         {
+            if (!pChannel->closed)
+            {
+               hSuspended = h;
+               pChannel->senders.push(this);
+               return handoff::idle();
+            }
+         }
+         else
+            sent = true;
+      }
+      return handoff::wake(h, hWake);
+   }
+
+   bool await_resume() const noexcept { return sent; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   channel * pChannel;
+   T value;
+   bool sent;
+   std::coroutine_handle<> hSuspended;
+   SendAwaiter * pNext;
+};
+
+/*************************************************
+ * CHANNEL RECV AWAITER
+ * Somewhere for a sender to leave the next item
+ ************************************************/
+template <typename T, typename A>
+class channel <T, A> ::RecvAwaiter
+{
+   friend class channel <T, A>;
+public:
+   RecvAwaiter(channel * pChannel) : pChannel(pChannel), pNext(nullptr) { }
+
+   bool await_ready() const noexcept { return false; }
+
+   // take an item now if there is one, otherwise wait in line
+   std::coroutine_handle<> await_suspend(std::coroutine_handle<> h)
+   {
+      std::coroutine_handle<> hWake;
+      {
+         std::lock_guard<std::mutex> guard(pChannel->lock);
+         if (!pChannel->tryRecv(slot, hWake) && !pChannel->closed)
+         {
+            hSuspended = h;
+            pChannel->receivers.push(this);
+            return handoff::idle();
+         }
+      }
+      return handoff::wake(h, hWake);
+   }
+
+   std::optional<T> await_resume() { return std::move(slot); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   channel * pChannel;
+   std::optional<T> slot;
+   std::coroutine_handle<> hSuspended;
+   RecvAwaiter * pNext;
+};
+
+/*****************************************
+ * CHANNEL :: CONSTRUCTOR
+ * A capacity of zero could never hold an item
+ ****************************************/
+template <typename T, typename A>
+channel <T, A> ::channel(size_t capacity, const A & a) :
+   buffer(a), maxItems(capacity), closed(false)
+{
+   if (capacity == 0)
+      throw "ERROR: a channel needs room for at least one item";
+}
+
+/*****************************************
+ * CHANNEL :: TRY SEND
+ * Called with the lock held. Hand value straight to
+ * a waiting receiver, or else buffer it if there is
+ * room. The receiver to resume, if any, is left in
+ * hWake for the caller to resume once unlocked
+ *     OUTPUT : whether value was taken
+ *     COST   : O(1)
+ ****************************************/
+template <typename T, typename A>
+bool channel <T, A> ::trySend(T & value, std::coroutine_handle<> & hWake)
+{
+   if (closed)
+      return false;
+
+   if (!receivers.empty())
+   {
+      RecvAwaiter * pReceiver = receivers.pop();
+      pReceiver->slot.emplace(std::move(value));
+      hWake = pReceiver->hSuspended;
+      return true;
+   }
+
+   if (buffer.size() < maxItems)
+   {
+      buffer.push_back(std::move(value));
+      return true;
+   }
+   return false;
+}
+
+/*****************************************
+ * CHANNEL :: TRY RECV
+ * Called with the lock held. Take the oldest item,
+ * and let the first waiting sender take its place
+ *     OUTPUT : whether slot was filled
+ *     COST   : O(1)
+ ****************************************/
+template <typename T, typename A>
+bool channel <T, A> ::tryRecv(std::optional<T> & slot, std::coroutine_handle<> & hWake)
+{
+   if (buffer.empty())
+      return false;
+
+   slot.emplace(std::move(buffer.front()));
+   buffer.pop_front();
+
+   if (!senders.empty())
+   {
+      SendAwaiter * pSender = senders.pop();
+      buffer.push_back(std::move(pSender->value));
+      pSender->sent = true;
+      hWake = pSender->hSuspended;
+   }
+   return true;
+}
+
+/*****************************************
+ * CHANNEL :: TRY SEND and TRY RECV
+ * The same as send() and recv(), but they return at
+ * once when they would have to wait
+ ****************************************/
+template <typename T, typename A>
+bool channel <T, A> ::try_send(T value)
+{
+   std::coroutine_handle<> hWake;
+   bool sent;
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      sent = trySend(value, hWake);
+   }
+   handoff::wake(hWake);
+   return sent;
+}
+
+template <typename T, typename A>
+std::optional<T> channel <T, A> ::try_recv()
+{
+   std::optional<T> slot;
+   std::coroutine_handle<> hWake;
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      tryRecv(slot, hWake);
+   }
+   handoff::wake(hWake);
+   return slot;
+}
+
+/*****************************************
+ * CHANNEL :: CLOSE
+ * Waiting senders give up and waiting receivers
+ * find nothing. Items already buffered can still
+ * be received
+ *     COST : O(number of waiters)
+ ****************************************/
+template <typename T, typename A>
+void channel <T, A> ::close()
+{
+   WaitQueue<SendAwaiter> sendersWoken;
+   WaitQueue<RecvAwaiter> receiversWoken;
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      closed = true;
+      std::swap(sendersWoken, senders);
+      std::swap(receiversWoken, receivers);
+   }
+
+   // a woken coroutine may free its awaiter, so step past it first
+   while (!sendersWoken.empty())
+      handoff::wake(sendersWoken.pop()->hSuspended);
+   while (!receiversWoken.empty())
+      handoff::wake(receiversWoken.pop()->hSuspended);
+}
+
+/*****************************************
+ * CHANNEL :: SIZE and IS CLOSED
+ ****************************************/
+template <typename T, typename A>
+size_t channel <T, A> ::size() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return buffer.size();
+}
+
+template <typename T, typename A>
+bool channel <T, A> ::is_closed() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return closed;
+}
+
+} // namespace custom
+
+#endif // CHANNEL_HAS_COROUTINES
@@ -0,0 +1,279 @@
+/***********************************************************************
+ * Header:
+ *    COW LIST
+ * Summary:
+ *    A list whose copies share one chain of nodes until one of them
+ *    changes it. Copying is O(1): it bumps a reference count. The
+ *    first change made through a copy that still shares its chain
+ *    clones the chain, O(n), and from then on that copy has its own.
+ *    A list that is handed to many readers and almost never written
+ *    is therefore copied for almost nothing.
+ *
+ *    Reading goes through const iterators only. Handing out a mutable
+ *    iterator would let a write slip past the clone, so every change
+ *    goes through a member that clones first: the push, pop and remove
+ *    members, or edit(), which passes the list itself to a function.
+ *
+ *    The count is atomic, so copies that share a chain may be read,
+ *    copied and changed on different threads at once, just like
+ *    std::shared_ptr. One cow_list object is not safe to change on one
+ *    thread while another thread uses it.
+ *
+ *    This will contain the class definition of:
+ *        cow_list : A list with copy-on-write sharing
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>             // for std::atomic
+#include <cstddef>            // for size_t
+#include <initializer_list>   // for std::initializer_list
+#include <utility>            // for std::move and std::swap
+#include "list.h"             // for list
+
+namespace custom
+{
+
+/**************************************************
+ * COW LIST
+ * A handle to a shared, reference-counted list
+ **************************************************/
+template <typename T, typename A = std::allocator<T>>
+class cow_list
+{
+public:
+   typedef typename list <T, A> ::const_iterator         const_iterator;
+   typedef typename list <T, A> ::const_reverse_iterator const_reverse_iterator;
+
+   //
+   // Construct
+   //
+
+   cow_list() : pBody(nullptr) { }
+   cow_list(const cow_list & rhs) : pBody(rhs.pBody) { share(); }
+   cow_list(cow_list && rhs) noexcept : pBody(rhs.pBody) { rhs.pBody = nullptr; }
+   cow_list(size_t num, const T & t) : pBody(new Body(list <T, A> (num, t))) { }
+   cow_list(const std::initializer_list<T> & il) : pBody(new Body(list <T, A> (il))) { }
+   template <class Iterator>
+   cow_list(Iterator first, Iterator last) : pBody(new Body(list <T, A> (first, last))) { }
+   explicit cow_list(list <T, A> && rhs) : pBody(new Body(std::move(rhs))) { }
+   ~cow_list() { release(); }
+
+   //
+   // Assign
+   //
+
+   cow_list & operator = (const cow_list & rhs);
+   cow_list & operator = (cow_list && rhs) noexcept;
+   cow_list & operator = (const std::initializer_list<T> & il);
+
+   //
+   // Read
+   //
+
+   const_iterator         begin()   const { return read().begin();  }
+   const_iterator         end()     const { return read().end();    }
+   const_iterator         cbegin()  const { return read().cbegin(); }
+   const_iterator         cend()    const { return read().cend();   }
+   const_reverse_iterator rbegin()  const { return read().rbegin(); }
+   const_reverse_iterator rend()    const { return read().rend();   }
+   const T &              front()   const;
+   const T &              back()    const;
+
+   // the shared list itself, for anything that takes a list
+   const list <T, A> & read() const { return pBody ? pBody->items : emptyList(); }
+
+   //
+   // Change. Each clones the chain first if it is shared
+   //
+
+   void push_front(const T &  data) { write().push_front(data);            }
+   void push_front(      T && data) { write().push_front(std::move(data)); }
+   void push_back (const T &  data) { write().push_back(data);             }
+   void push_back (      T && data) { write().push_back(std::move(data));  }
+   void pop_front()                 { if (!empty()) write().pop_front();   }
+   void pop_back()                  { if (!empty()) write().pop_back();    }
+   void reverse()                   { if (size() > 1) write().reverse();   }
+   size_t remove(const T & value);
+   template <class Predicate>
+   size_t remove_if(Predicate pred);
+   void clear() { release(); }
+
+   // call f(list &) on a list this handle owns alone
+   template <class Edit>
+   void edit(Edit f) { f(write()); }
+
+   //
+   // Status
+   //
+
+   bool   empty()     const { return read().empty(); }
+   size_t size()      const { return read().size();  }
+   size_t use_count() const { return pBody ? pBody->refs.load(std::memory_order_relaxed) : 0; }
+   void   swap(cow_list & rhs) noexcept { std::swap(pBody, rhs.pBody); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+
+   // the list and the number of handles to it
+   struct Body
+   {
+      Body(const list <T, A> & items) : refs(1), items(items) { }
+      Body(list <T, A> && items) : refs(1), items(std::move(items)) { }
+      std::atomic<size_t> refs;
+      list <T, A> items;
+   };
+
+   // every empty handle reads from the same empty list
+   static const list <T, A> & emptyList()
+   {
+      static const list <T, A> empty;
+      return empty;
+   }
+
+   void share();
+   void release();
+   list <T, A> & write();
+
+   Body * pBody;   // NULL for an empty list that has never been written
+};
+
+/*****************************************
+ * COW LIST :: SHARE and RELEASE
+ * Count one more or one fewer handle on the body,
+ * freeing it with the last
+ *     COST : O(1), O(n) to free the last handle
+ ****************************************/
+template <typename T, typename A>
+void cow_list <T, A> ::share()
+{
+   if (pBody)
+      pBody->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T, typename A>
+void cow_list <T, A> ::release()
+{
+   // the last handle must see every write the others made before letting go
+   if (pBody && pBody->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete pBody;
+   pBody = nullptr;
+}
+
+/*****************************************
+ * COW LIST :: WRITE
+ * The list, owned by this handle alone. A shared
+ * body is cloned first, and this handle lets go of
+ * the original
+ *     COST : O(1) when unshared, O(n) to clone
+ ****************************************/
+template <typename T, typename A>
+list <T, A> & cow_list <T, A> ::write()
+{
+   if (pBody == nullptr)
+      pBody = new Body(list <T, A> ());
+   else if (pBody->refs.load(std::memory_order_acquire) != 1)
+   {
+      Body * pClone = new Body(pBody->items);
+      release();
+      pBody = pClone;
+   }
+   return pBody->items;
+}
+
+/*****************************************
+ * COW LIST :: FRONT and BACK
+ ****************************************/
+template <typename T, typename A>
+const T & cow_list <T, A> ::front() const
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return *begin();
+}
+
+template <typename T, typename A>
+const T & cow_list <T, A> ::back() const
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return *rbegin();
+}
+
+/*****************************************
+ * COW LIST :: ASSIGN
+ * Share the right hand side's body, letting go of
+ * this one's
+ *     COST : O(1), O(n) when this was the last handle
+ ****************************************/
+template <typename T, typename A>
+cow_list <T, A> & cow_list <T, A> ::operator = (const cow_list & rhs)
+{
+   cow_list copy(rhs);
+   swap(copy);
+   return *this;
+}
+
+template <typename T, typename A>
+cow_list <T, A> & cow_list <T, A> ::operator = (cow_list && rhs) noexcept
+{
+   if (this != &rhs)
+   {
+      release();
+      pBody = rhs.pBody;
+      rhs.pBody = nullptr;
+   }
+   return *this;
+}
+
+template <typename T, typename A>
+cow_list <T, A> & cow_list <T, A> ::operator = (const std::initializer_list<T> & il)
+{
+   cow_list rhs(il);
+   swap(rhs);
+   return *this;
+}
+
+/*****************************************
+ * COW LIST :: REMOVE and REMOVE IF
+ * A shared body is only cloned if something
+ * actually matches, so pred may see the first
+ * match twice
+ *     OUTPUT : the number of items removed
+ *     COST   : O(n)
+ ****************************************/
+template <typename T, typename A>
+size_t cow_list <T, A> ::remove(const T & value)
+{
+   return remove_if([&value](const T & t) { return t == value; });
+}
+
+template <typename T, typename A>
+template <class Predicate>
+size_t cow_list <T, A> ::remove_if(Predicate pred)
+{
+   if (use_count() > 1)
+   {
+      bool any = false;
+      for (const_iterator it = begin(); !any && it != end(); ++it)
+         any = pred(*it);
+      if (!any)
+         return 0;
+   }
+   return write().remove_if(pred);
+}
+
+/*****************************************
+ * SWAP
+ * Swap two handles
+ ****************************************/
+template <typename T, typename A>
+inline void swap(cow_list <T, A> & lhs, cow_list <T, A> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
@@ -0,0 +1,306 @@
+/***********************************************************************
+ * Header:
+ *    GENERATOR
+ * Summary:
+ *    A coroutine that produces a sequence one item at a time with
+ *    co_yield, and the lazy stages built from it. A chain such as
+ *
+ *        l | custom::filter(isValid) | custom::transform(score) | custom::take(10)
+ *
+ *    runs each item all the way through before the next is looked at,
+ *    so no stage builds a temporary list, and take() stops the whole
+ *    chain as soon as it has enough: later items are never computed.
+ *
+ *    A generator is a std::ranges::view, and a custom::list is a
+ *    std::ranges::bidirectional_range, so both mix freely with the
+ *    adaptors in std::views.
+ *
+ *    A stage keeps a reference to an lvalue range such as a list, so
+ *    the list must outlive the chain. A generator passed in is moved
+ *    into the stage.
+ *
+ *    This needs C++20 coroutines and ranges. Without them this header
+ *    is empty.
+ *
+ *    This will contain the definitions of:
+ *        generator           : A lazily produced sequence
+ *        generator::iterator : Resumes the coroutine for the next item
+ *        lazy_filter         : The items for which a predicate holds
+ *        lazy_transform      : Every item passed through a function
+ *        lazy_take           : The first few items
+ *        filter, transform and take : The same, for use after a |
+ ************************************************************************/
+
+#pragma once
+
+#ifdef __has_include
+#if __has_include(<coroutine>) && __has_include(<ranges>)
+#include <version>     // for __cpp_lib_ranges
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_ranges)
+#define GENERATOR_HAS_COROUTINES
+#endif
+#endif
+#endif
+
+#ifdef GENERATOR_HAS_COROUTINES
+
+#include <coroutine>   // for std::coroutine_handle
+#include <cstddef>     // for size_t and std::ptrdiff_t
+#include <exception>   // for std::exception_ptr
+#include <functional>  // for std::invoke
+#include <iterator>    // for std::default_sentinel_t
+#include <memory>      // for std::addressof
+#include <ranges>      // for std::ranges::view_base
+#include <type_traits> // for std::remove_cvref_t
+#include <utility>     // for std::exchange
+
+namespace custom
+{
+
+/**************************************************
+ * GENERATOR
+ * The return type of a coroutine that co_yields
+ * items of type T. It is run only as far as the
+ * items that have been asked for
+ **************************************************/
+template <typename T>
+class generator : public std::ranges::view_base
+{
+public:
+   class promise_type;
+   class iterator;
+   typedef std::coroutine_handle<promise_type> Handle;
+
+   //
+   // Construct
+   //
+
+   generator() : h(nullptr) { }
+   generator(generator && rhs) noexcept : h(std::exchange(rhs.h, nullptr)) { }
+   generator & operator = (generator && rhs) noexcept
+   {
+      std::swap(h, rhs.h);
+      return *this;
+   }
+   ~generator()
+   {
+      if (h)
+         h.destroy();
+   }
+
+   //
+   // Iterator
+   //
+
+   iterator begin();
+   std::default_sentinel_t end() const { return std::default_sentinel; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   explicit generator(Handle h) : h(h) { }
+
+   Handle h;   // the coroutine, suspended at its last co_yield
+};
+
+/*************************************************
+ * GENERATOR PROMISE
+ * Points at the item the coroutine just yielded.
+ * The item stays alive while the coroutine is
+ * suspended at that co_yield
+ ************************************************/
+template <typename T>
+class generator <T> ::promise_type
+{
+   friend class generator <T>;
+public:
+   generator get_return_object() { return generator(Handle::from_promise(*this)); }
+   std::suspend_always initial_suspend() const noexcept { return {}; }
+   std::suspend_always final_suspend()   const noexcept { return {}; }
+
+   std::suspend_always yield_value(const T & value) noexcept
+   {
+      pValue = std::addressof(value);
+      return {};
+   }
+
+   void return_void() { }
+   void unhandled_exception() { exception = std::current_exception(); }
+
+   // nothing but yield may suspend a generator
+   template <class U>
+   std::suspend_never await_transform(U &&) = delete;
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // run to the next co_yield, passing on anything it threw
+   void resume(Handle h)
+   {
+      h.resume();
+      if (exception)
+         std::rethrow_exception(std::exchange(exception, nullptr));
+   }
+
+   const T * pValue = nullptr;
+   std::exception_ptr exception;
+};
+
+/*************************************************
+ * GENERATOR ITERATOR
+ * A single pass through the generator. Stepping it
+ * runs the coroutine to its next co_yield
+ ************************************************/
+template <typename T>
+class generator <T> ::iterator
+{
+public:
+   typedef std::input_iterator_tag iterator_category;
+   typedef T                       value_type;
+   typedef std::ptrdiff_t          difference_type;
+   typedef const T *               pointer;
+   typedef const T &               reference;
+
+   iterator() : h(nullptr) { }
+   explicit iterator(Handle h) : h(h) { }
+
+   const T & operator *  () const { return *h.promise().pValue; }
+   const T * operator -> () const { return  h.promise().pValue; }
+
+   iterator & operator ++ ()
+   {
+      h.promise().resume(h);
+      return *this;
+   }
+   void operator ++ (int postfix) { ++(*this); }
+
+   friend bool operator == (const iterator & it, std::default_sentinel_t)
+   {
+      return !it.h || it.h.done();
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   Handle h;
+};
+
+/*****************************************
+ * GENERATOR :: BEGIN
+ * Run the coroutine to its first co_yield
+ ****************************************/
+template <typename T>
+typename generator <T> ::iterator generator <T> ::begin()
+{
+   if (h)
+      h.promise().resume(h);
+   return iterator(h);
+}
+
+/**************************************************
+ * LAZY FILTER
+ * Yield the items of range for which pred is true
+ **************************************************/
+template <class View, class Predicate>
+generator<std::ranges::range_value_t<View>> lazyFilter(View view, Predicate pred)
+{
+   for (auto && item : view)
+      if (std::invoke(pred, item))
+         co_yield item;
+}
+
+template <class Range, class Predicate>
+auto lazy_filter(Range && range, Predicate pred)
+{
+   return lazyFilter(std::views::all(std::forward<Range>(range)), std::move(pred));
+}
+
+/**************************************************
+ * LAZY TRANSFORM
+ * Yield f(item) for every item of range
+ **************************************************/
+template <class View, class Function>
+generator<std::remove_cvref_t<
+   std::invoke_result_t<Function &, std::ranges::range_reference_t<View>>>>
+lazyTransform(View view, Function f)
+{
+   for (auto && item : view)
+      co_yield std::invoke(f, item);
+}
+
+template <class Range, class Function>
+auto lazy_transform(Range && range, Function f)
+{
+   return lazyTransform(std::views::all(std::forward<Range>(range)), std::move(f));
+}
+
+/**************************************************
+ * LAZY TAKE
+ * Yield the first num items of range. The range is
+ * not stepped past the last one taken, so nothing
+ * after it is ever computed
+ **************************************************/
+template <class View>
+generator<std::ranges::range_value_t<View>> lazyTake(View view, size_t num)
+{
+   if (num == 0)
+      co_return;
+   auto it = std::ranges::begin(view);
+   for (; it != std::ranges::end(view); ++it)
+   {
+      co_yield *it;
+      if (--num == 0)
+         co_return;
+   }
+}
+
+template <class Range>
+auto lazy_take(Range && range, size_t num)
+{
+   return lazyTake(std::views::all(std::forward<Range>(range)), num);
+}
+
+/**************************************************
+ * FILTER, TRANSFORM and TAKE
+ * The stages above, written after a | so a chain
+ * reads in the order it runs
+ **************************************************/
+template <class Predicate>
+struct filter_stage    { Predicate pred; };
+template <class Function>
+struct transform_stage { Function f;     };
+struct take_stage      { size_t num;     };
+
+template <class Predicate>
+filter_stage<Predicate>   filter(Predicate pred) { return { std::move(pred) }; }
+template <class Function>
+transform_stage<Function> transform(Function f)  { return { std::move(f) };    }
+inline take_stage         take(size_t num)       { return { num };             }
+
+template <class Range, class Predicate>
+auto operator | (Range && range, filter_stage<Predicate> stage)
+{
+   return lazy_filter(std::forward<Range>(range), std::move(stage.pred));
+}
+
+template <class Range, class Function>
+auto operator | (Range && range, transform_stage<Function> stage)
+{
+   return lazy_transform(std::forward<Range>(range), std::move(stage.f));
+}
+
+template <class Range>
+auto operator | (Range && range, take_stage stage)
+{
+   return lazy_take(std::forward<Range>(range), stage.num);
+}
+
+} // namespace custom
+
+#endif // GENERATOR_HAS_COROUTINES
@@ -0,0 +1,349 @@
+/***********************************************************************
+ * Header:
+ *    HUGE PAGE ARENA
+ * Summary:
+ *    An arena that hands out list nodes from large regions mapped
+ *    straight from the operating system and, where the kernel allows,
+ *    backed by 2 MB transparent huge pages instead of 4 KB pages.
+ *
+ *    Walking a list of a hundred million nodes touches a new page
+ *    every few nodes, and the TLB only covers a few megabytes of 4 KB
+ *    pages, so nearly every hop also misses the TLB and costs a page
+ *    walk on top of the cache miss. The same TLB covers gigabytes of
+ *    huge pages. The nodes do not move, only the pages under them get
+ *    bigger, so no code that walks the list changes.
+ *
+ *    Each chunk is reserved with mmap(), aligned to a huge page, and
+ *    marked with madvise(MADV_HUGEPAGE). When huge pages are turned
+ *    off, unsupported, or the kernel refuses the advice, the chunk is
+ *    used as it is with ordinary pages. Windows gets ordinary pages
+ *    from the heap.
+ *
+ *    An arena is not thread safe and is meant to belong to one list
+ *    (or to lists used by one thread). Freed blocks go on a free list
+ *    for their size and are reused by the next allocation of that size;
+ *    the memory itself goes back only when the arena is destroyed, so
+ *    the arena must outlive every list that uses it. stats() counts
+ *    what the arena itself hands out; blocks the allocator sends to
+ *    the heap are not in it.
+ *
+ *    This will contain the class definition of:
+ *        page_arena      : Chunks of huge pages carved into blocks
+ *        arena_allocator : A std::allocator replacement over a page_arena
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>         // for size_t and std::max_align_t
+#include <cstdint>         // for std::uintptr_t
+#include <new>             // for ::operator new
+#include "allocatorStats.h" // for allocator_stats
+#ifndef _WIN32
+#include <sys/mman.h>      // for mmap() and madvise()
+#endif // _WIN32
+
+namespace custom
+{
+
+/**************************************************
+ * PAGE ARENA
+ * Blocks of up to MAX_BLOCK bytes, bump allocated
+ * from chunks of huge pages
+ **************************************************/
+class page_arena
+{
+public:
+   static constexpr size_t HUGE_PAGE  = size_t(2) << 20;   // 2 MB on x86-64 and ARM64
+   static constexpr size_t CHUNK_SIZE = 32 * HUGE_PAGE;   // mapped at a time
+   static constexpr size_t GRANULE    = 8;                // block sizes are rounded to this
+   static constexpr size_t MAX_BLOCK  = 512;              // larger blocks go to the heap
+
+   explicit page_arena(bool hugePages = true);
+   page_arena(const page_arena &) = delete;
+   page_arena & operator = (const page_arena &) = delete;
+   ~page_arena();
+
+   void * allocate(size_t size);
+   void   deallocate(void * p, size_t size) noexcept;
+
+   // whether huge pages were asked for and the kernel took the advice
+   bool   huge_pages()   const { return hugePages;  }
+   size_t bytes_mapped() const { return numChunks * CHUNK_SIZE; }
+   allocator_stats stats() const;
+
+   // what a block of this many bytes really takes
+   static size_t block_size(size_t size) { return sizeClass(size) * GRANULE; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // the first bytes of every chunk link it to the one mapped before
+   struct Chunk
+   {
+      Chunk * pPrev;
+   };
+
+   static size_t sizeClass(size_t size) { return (size ? size + GRANULE - 1 : GRANULE) / GRANULE; }
+
+   void    grow();
+   Chunk * mapChunk();
+   void    unmapChunk(Chunk * p) noexcept;
+
+   bool    hugePages;                          // still hoping for huge pages
+   char  * pNext;                              // next unused byte in the newest chunk
+   char  * pEnd;                               // end of the newest chunk
+   Chunk * pChunks;                            // the newest chunk
+   size_t  numChunks;
+   void  * freeLists[MAX_BLOCK / GRANULE + 1]; // freed blocks by size class
+
+   // for stats()
+   size_t  numLive;
+   size_t  numPeak;
+   size_t  bytesRequested;                     // by the live blocks
+   size_t  bytesInBlocks;                      // the live blocks, rounded to their class
+};
+
+/*****************************************
+ * PAGE ARENA :: CONSTRUCTOR
+ * Nothing is mapped until the first allocation
+ ****************************************/
+inline page_arena::page_arena(bool hugePages) :
+   hugePages(hugePages), pNext(nullptr), pEnd(nullptr), pChunks(nullptr), numChunks(0),
+   numLive(0), numPeak(0), bytesRequested(0), bytesInBlocks(0)
+{
+   for (void * & p : freeLists)
+      p = nullptr;
+}
+
+/*****************************************
+ * PAGE ARENA :: DESTRUCTOR
+ * Give every chunk back at once
+ ****************************************/
+inline page_arena::~page_arena()
+{
+   while (pChunks)
+   {
+      Chunk * pPrev = pChunks->pPrev;
+      unmapChunk(pChunks);
+      pChunks = pPrev;
+   }
+}
+
+/*****************************************
+ * PAGE ARENA :: ALLOCATE
+ * Reuse a freed block of the same size, or bump
+ * the pointer in the newest chunk. A block is
+ * aligned to the largest power of two dividing
+ * its rounded size, up to max_align_t, so a freed
+ * block suits anything else of that size
+ *     INPUT  : size  1 to MAX_BLOCK bytes
+ *     OUTPUT : the block
+ *     COST   : O(1)
+ ****************************************/
+inline void * page_arena::allocate(size_t size)
+{
+   if (size > MAX_BLOCK)
+      throw "ERROR: block too large for the arena";
+   size_t sc = sizeClass(size);
+   size_t bytes = sc * GRANULE;
+   if (++numLive > numPeak)
+      numPeak = numLive;
+   bytesRequested += size;
+   bytesInBlocks += bytes;
+
+   if (freeLists[sc])
+   {
+      void * p = freeLists[sc];
+      freeLists[sc] = *static_cast<void **>(p);
+      return p;
+   }
+
+   size_t align = bytes & (0 - bytes);
+   if (align > alignof(std::max_align_t))
+      align = alignof(std::max_align_t);
+
+   std::uintptr_t next = ((std::uintptr_t)pNext + align - 1) & ~(std::uintptr_t)(align - 1);
+   if (pNext == nullptr || next + bytes > (std::uintptr_t)pEnd)
+   {
+      grow();
+      next = ((std::uintptr_t)pNext + align - 1) & ~(std::uintptr_t)(align - 1);
+   }
+   pNext = reinterpret_cast<char *>(next + bytes);
+   return reinterpret_cast<void *>(next);
+}
+
+/*****************************************
+ * PAGE ARENA :: DEALLOCATE
+ * Push the block onto the free list for its size
+ *     COST : O(1)
+ ****************************************/
+inline void page_arena::deallocate(void * p, size_t size) noexcept
+{
+   size_t sc = sizeClass(size);
+   *static_cast<void **>(p) = freeLists[sc];
+   freeLists[sc] = p;
+   numLive--;
+   bytesRequested -= size;
+   bytesInBlocks -= sc * GRANULE;
+}
+
+/*****************************************
+ * PAGE ARENA :: STATS
+ * What the arena holds
+ *     OUTPUT : the snapshot
+ *     COST   : O(1)
+ ****************************************/
+inline allocator_stats page_arena::stats() const
+{
+   allocator_stats s = {};
+   s.live_blocks     = numLive;
+   s.peak_blocks     = numPeak;
+   s.bytes_requested = bytesRequested;
+   s.bytes_in_blocks = bytesInBlocks;
+   s.bytes_reserved  = bytes_mapped();
+   return s;
+}
+
+/*****************************************
+ * PAGE ARENA :: GROW
+ * Map a fresh chunk. Whatever was left at the end
+ * of the old one is abandoned
+ ****************************************/
+inline void page_arena::grow()
+{
+   Chunk * p = mapChunk();
+   p->pPrev = pChunks;
+   pChunks = p;
+   numChunks++;
+   pNext = reinterpret_cast<char *>(p) + sizeof(Chunk);
+   pEnd  = reinterpret_cast<char *>(p) + CHUNK_SIZE;
+}
+
+#ifndef _WIN32
+
+/*****************************************
+ * PAGE ARENA :: MAP CHUNK
+ * Reserve one chunk more than needed so a huge page
+ * boundary falls inside it, trim both ends back to
+ * that boundary, and ask for huge pages. If the
+ * advice is refused, this and every later chunk
+ * keeps ordinary pages
+ ****************************************/
+inline page_arena::Chunk * page_arena::mapChunk()
+{
+   size_t bytes = CHUNK_SIZE + HUGE_PAGE;
+   void * pMap = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (pMap == MAP_FAILED)
+      throw "ERROR: unable to map a chunk for the arena";
+
+   char * pRaw  = static_cast<char *>(pMap);
+   char * pBase = reinterpret_cast<char *>(
+      ((std::uintptr_t)pRaw + HUGE_PAGE - 1) & ~(std::uintptr_t)(HUGE_PAGE - 1));
+   if (pBase > pRaw)
+      ::munmap(pRaw, pBase - pRaw);
+   if (pRaw + bytes > pBase + CHUNK_SIZE)
+      ::munmap(pBase + CHUNK_SIZE, pRaw + bytes - (pBase + CHUNK_SIZE));
+
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+   if (hugePages)
+      hugePages = ::madvise(pBase, CHUNK_SIZE, MADV_HUGEPAGE) == 0;
+   else
+      ::madvise(pBase, CHUNK_SIZE, MADV_NOHUGEPAGE);   // even when THP is "always"
+#else
+   hugePages = false;
+#endif
+   return reinterpret_cast<Chunk *>(pBase);
+}
+
+inline void page_arena::unmapChunk(Chunk * p) noexcept
+{
+   ::munmap(p, CHUNK_SIZE);
+}
+
+#else // _WIN32
+
+/*****************************************
+ * PAGE ARENA :: MAP CHUNK
+ * Without mmap() the chunk comes from the heap on
+ * ordinary pages
+ ****************************************/
+inline page_arena::Chunk * page_arena::mapChunk()
+{
+   hugePages = false;
+   return static_cast<Chunk *>(::operator new(CHUNK_SIZE));
+}
+
+inline void page_arena::unmapChunk(Chunk * p) noexcept
+{
+   ::operator delete(p);
+}
+
+#endif // _WIN32
+
+/**************************************************
+ * ARENA ALLOCATOR
+ * A drop-in replacement for std::allocator. Single
+ * objects come from the arena; arrays, large and
+ * over-aligned types go to the heap
+ **************************************************/
+template <typename T>
+class arena_allocator
+{
+public:
+   typedef T value_type;
+
+   explicit arena_allocator(page_arena & arena) noexcept : pArena(&arena) { }
+   template <typename U>
+   arena_allocator(const arena_allocator<U> & rhs) noexcept : pArena(rhs.pArena) { }
+
+   T * allocate(size_t n)
+   {
+      if (n == 1 && ARENA)
+         return static_cast<T *>(pArena->allocate(sizeof(T)));
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+   }
+
+   void deallocate(T * p, size_t n) noexcept
+   {
+      if (n == 1 && ARENA)
+         pArena->deallocate(p, sizeof(T));
+      else
+         ::operator delete(p);
+   }
+
+   page_arena * arena() const noexcept { return pArena; }
+
+   // what one T really takes, for list::memory_usage()
+   size_t block_size() const noexcept
+   {
+      return ARENA ? page_arena::block_size(sizeof(T)) : sizeof(T);
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   template <typename U> friend class arena_allocator;
+
+   static constexpr bool ARENA = sizeof(T) <= page_arena::MAX_BLOCK &&
+                                 alignof(T) <= alignof(std::max_align_t);
+   page_arena * pArena;
+};
+
+// only the arena that handed out a block can take it back
+template <typename T, typename U>
+bool operator == (const arena_allocator<T> & lhs, const arena_allocator<U> & rhs)
+{
+   return lhs.arena() == rhs.arena();
+}
+template <typename T, typename U>
+bool operator != (const arena_allocator<T> & lhs, const arena_allocator<U> & rhs)
+{
+   return lhs.arena() != rhs.arena();
+}
+
+} // namespace custom
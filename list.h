@@ -13,25 +13,233 @@
  *    This will contain the class definition of:
  *        List         : A class that represents a List
  *        ListIterator : An iterator through List
+ *        ListConstIterator : A read-only iterator through List
  * Author
  *    Stephen Costigan, Alexander Dohms
  ************************************************************************/
 
 #pragma once
+#include <atomic>      // for std::atomic
 #include <cassert>     // for ASSERT
 #include <iostream>    // for nullptr
 #include <new>         // std::bad_alloc
 #include <memory>      // for std::allocator
+#include <cstddef>     // for std::ptrdiff_t
+#include <cstdint>     // for std::uint64_t
+#include <cstring>     // for std::memcpy
+#include <iterator>    // for std::bidirectional_iterator_tag
+#include <type_traits> // for std::is_trivially_copyable
+#include <utility>     // for std::swap
+#include "reclaimer.h" // for reclaimer
+#ifdef __has_include
+#if __has_include(<memory_resource>)
+#include <memory_resource> // for std::pmr::polymorphic_allocator
+#endif
+#endif
+
+// C++20 lets a list be built, walked and torn down during constant
+// evaluation, as long as every node is freed before the evaluation ends
+#if defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc)
+#define LIST_CONSTEXPR constexpr
+#define LIST_HAS_CONSTEXPR
+#else
+#define LIST_CONSTEXPR
+#endif
 
 namespace custom
 {
 
+/**************************************************
+ * NODE LAYOUT
+ * Where a list node keeps its links relative to its
+ * payload. Walking the list only reads the links, so
+ * for a large T they should not be spread among the
+ * payload's cache lines:
+ *    links_first         : the links open the node (the default)
+ *    payload_first       : the payload, then the links
+ *    payload_out_of_line : the node holds the links and a reference
+ *                          to a payload allocated on its own, so
+ *                          nodes stay small and a walk never touches
+ *                          the payload at all
+ * Specialize node_layout<T> to pick one for a type
+ **************************************************/
+struct links_first         { };
+struct payload_first       { };
+struct payload_out_of_line { };
+
+template <typename T>
+struct node_layout
+{
+   typedef links_first type;
+};
+
+/**************************************************
+ * NODE FIELDS
+ * The members of a list node, in the order its
+ * layout asks for
+ **************************************************/
+template <typename Node, typename T, typename Layout>
+struct node_fields;
+
+template <typename Node, typename T>
+struct node_fields <Node, T, links_first>
+{
+   template <class ... Args>
+   LIST_CONSTEXPR node_fields(Args && ... args) :
+      pNext(nullptr), pPrev(nullptr), data(std::forward<Args>(args)...) { }
+
+   Node * pNext;       // pointer to next node
+   Node * pPrev;       // pointer to previous node
+   T data;             // user data
+};
+
+template <typename Node, typename T>
+struct node_fields <Node, T, payload_first>
+{
+   template <class ... Args>
+   LIST_CONSTEXPR node_fields(Args && ... args) :
+      data(std::forward<Args>(args)...), pNext(nullptr), pPrev(nullptr) { }
+
+   T data;             // user data
+   Node * pNext;       // pointer to next node
+   Node * pPrev;       // pointer to previous node
+};
+
+template <typename Node, typename T>
+struct node_fields <Node, T, payload_out_of_line>
+{
+   LIST_CONSTEXPR node_fields(T & payload) :
+      pNext(nullptr), pPrev(nullptr), data(payload) { }
+
+   Node * pNext;       // pointer to next node
+   Node * pPrev;       // pointer to previous node
+   T & data;           // user data, in its own allocation
+};
+
+/**************************************************
+ * LIST MEMORY
+ * What a list costs, as list::memory_usage() finds
+ * it. An item is counted at sizeof(T); whatever it
+ * owns on the heap is not. The nodes always split
+ * into payload and links:
+ *    node_bytes == payload_bytes + link_bytes
+ **************************************************/
+struct list_memory
+{
+   size_t list_bytes;     // the list object itself
+   size_t node_bytes;     // every block the list asked its allocator for
+   size_t payload_bytes;  // the items, sizeof(T) apiece
+   size_t link_bytes;     // the rest: links, padding, and any payload reference
+   size_t slack_bytes;    // what the allocator rounds those blocks up by
+
+   LIST_CONSTEXPR size_t total() const { return list_bytes + node_bytes + slack_bytes; }
+};
+
+/**************************************************
+ * ALLOCATOR BLOCK SIZE
+ * The bytes an allocator really sets aside for one
+ * of its value_type. An allocator that knows says so
+ * with a block_size() member; any other is taken at
+ * its word
+ **************************************************/
+template <typename A, typename = void>
+struct allocator_block_size
+{
+   static LIST_CONSTEXPR size_t get(const A &) { return sizeof(typename A::value_type); }
+};
+
+template <typename A>
+struct allocator_block_size <A, decltype((void)std::declval<const A &>().block_size())>
+{
+   static LIST_CONSTEXPR size_t get(const A & a) { return a.block_size(); }
+};
+
+/**************************************************
+ * BACKGROUND RECLAIM
+ * Whether a list over A may hand its nodes to the
+ * reclaimer thread. That thread frees them through
+ * a copy of the allocator after clear() returns, so
+ * the allocator must be safe to call from another
+ * thread and must not depend on anything the owner
+ * may destroy first. An allocator whose instances
+ * are always equal, such as std::allocator, is
+ * taken to be stateless and qualifies; specialize
+ * this to opt any other allocator in
+ **************************************************/
+template <typename A>
+struct background_reclaim : std::allocator_traits<A>::is_always_equal { };
+
+/**************************************************
+ * LIST STATS
+ * A policy that a list reports its work to, given as
+ * its third template parameter:
+ *    on_allocate(num) : num nodes were allocated
+ *    on_free(num)     : num nodes were freed
+ *    on_relink(num)   : num node links were rewritten
+ *    on_increment()   : an iterator stepped forward or back
+ *    on_walk(num)     : one operation stepped over num nodes itself
+ * no_stats, the default, is empty and every hook is
+ * a no-op, so a list costs nothing more with it.
+ * counting_stats keeps the totals, for a canary
+ * build looking for operations that walk far more
+ * than they should. Its counters are relaxed
+ * atomics, so several threads may walk the list at
+ * once, as parallel_for_each does, and not a step is
+ * lost; they are not usable in constant evaluation.
+ * The hooks are const because
+ * iterators only see a const list. The stats stay
+ * with the list object: they are not copied, moved
+ * or swapped
+ **************************************************/
+struct no_stats
+{
+   LIST_CONSTEXPR void on_allocate(size_t) const { }
+   LIST_CONSTEXPR void on_free(size_t) const { }
+   LIST_CONSTEXPR void on_relink(size_t) const { }
+   LIST_CONSTEXPR void on_increment() const { }
+   LIST_CONSTEXPR void on_walk(size_t) const { }
+};
+
+struct counting_stats
+{
+   typedef std::atomic<size_t> Counter;
+
+   void on_allocate(size_t num) const { allocations.fetch_add(num, std::memory_order_relaxed); }
+   void on_free(size_t num) const { frees.fetch_add(num, std::memory_order_relaxed); }
+   void on_relink(size_t num) const { relinks.fetch_add(num, std::memory_order_relaxed); }
+   void on_increment() const { increments.fetch_add(1, std::memory_order_relaxed); }
+   void on_walk(size_t num) const
+   {
+      walks.fetch_add(1, std::memory_order_relaxed);
+      walked.fetch_add(num, std::memory_order_relaxed);
+      size_t longest = longest_walk.load(std::memory_order_relaxed);
+      while (num > longest &&
+             !longest_walk.compare_exchange_weak(longest, num, std::memory_order_relaxed))
+         ;
+   }
+
+   void reset() const
+   {
+      for (Counter * p : { &allocations, &frees, &relinks, &increments,
+                           &walks, &walked, &longest_walk })
+         p->store(0, std::memory_order_relaxed);
+   }
+
+   mutable Counter allocations{0};  // nodes allocated
+   mutable Counter frees{0};        // nodes freed
+   mutable Counter relinks{0};      // node links rewritten
+   mutable Counter increments{0};   // iterator steps, either way
+   mutable Counter walks{0};        // operations that walked the list themselves
+   mutable Counter walked{0};       // nodes those operations stepped over
+   mutable Counter longest_walk{0}; // the most any one of them stepped over
+};
+
 /**************************************************
  * LIST
  * Just like std::list
  **************************************************/
-template <typename T, typename A = std::allocator<T>>
-class list
+template <typename T, typename A = std::allocator<T>, typename S = no_stats>
+class list : private S
 {
 public:
    
@@ -39,7 +247,7 @@ public:
    // Construct -- Alex
    //
    
-   list(const A& a = A())                                       
+   LIST_CONSTEXPR list(const A& a = A()) : alloc(a)                            
    {
        // PG 260
        /*list.default-constructor()
@@ -47,10 +255,11 @@ public:
          numElements <- 0
         */
 
-      numElements = 99;
-      pHead = pTail = new list <T, A> ::Node();
-   }                              // Default constructor 
-   list(list <T, A> & rhs, const A& a = A())                    
+      numElements = 0;
+      pHead = pTail = nullptr;
+   }                              // Default constructor
+   LIST_CONSTEXPR list(const list <T, A, S> & rhs) :
+      alloc(AllocTraits::select_on_container_copy_construction(rhs.alloc))
    {
        /*list.copy-constructor(rhs)
              pHead <- pTail <- NULL
@@ -62,32 +271,42 @@ public:
       pHead <- pTail <- NULL
       numElements <- 0
       *this <- rhs */
-      numElements = 99;
-      pHead = pTail = new list <T, A> ::Node();
+      numElements = 0;
+      pHead = pTail = nullptr;
+      append_range(rhs.begin(), rhs.end());
    }                              // Copy constructor 
-   list(list <T, A>&& rhs, const A& a = A());                   // Move constructor
-   list(size_t num, const T & t, const A& a = A());             // Non-default empty fill constructor
-   list(size_t num, const A& a = A());                          // Non-default value fill constructor
-   list(const std::initializer_list<T>& il, const A& a = A())   // Initializer list constructor
+   LIST_CONSTEXPR list(const list <T, A, S> & rhs, const A& a) : alloc(a)         // Copy constructor, given an allocator
    {
-      numElements = 99;
-      pHead = pTail = new list <T, A> ::Node();
+      numElements = 0;
+      pHead = pTail = nullptr;
+      append_range(rhs.begin(), rhs.end());
+   }
+   LIST_CONSTEXPR list(list <T, A, S>&& rhs);                                     // Move constructor
+   LIST_CONSTEXPR list(list <T, A, S>&& rhs, const A& a);                         // Move constructor, given an allocator
+   LIST_CONSTEXPR list(size_t num, const T & t, const A& a = A());             // Non-default empty fill constructor
+   LIST_CONSTEXPR list(size_t num, const A& a = A());                          // Non-default value fill constructor
+   LIST_CONSTEXPR list(const std::initializer_list<T>& il, const A& a = A()) : alloc(a) // Initializer list constructor
+   {
+      numElements = 0;
+      pHead = pTail = nullptr;
+      append_range(il.begin(), il.end());
    }
    template <class Iterator>
-   list(Iterator first, Iterator last, const A& a = A())        // Range constructor
+   LIST_CONSTEXPR list(Iterator first, Iterator last, const A& a = A()) : alloc(a) // Range constructor
    {
-      numElements = 99;
-      pHead = pTail = new list <T, A> ::Node();
+      numElements = 0;
+      pHead = pTail = nullptr;
+      append_range(first, last);
    }
-   ~list() { }                                         // Deconstructor (edited by steve)
+   LIST_CONSTEXPR ~list() { clear(); }                                // Deconstructor (edited by steve)
    
    //
    // Assign -- Steve
    //
    
-   list <T, A> & operator = (list <T, A> &  rhs);               // Copy-assign
-   list <T, A> & operator = (list <T, A> && rhs);               // Move-assign
-   list <T, A> & operator = (const std::initializer_list<T>& il); // Initializer list assign
+   LIST_CONSTEXPR list <T, A, S> & operator = (const list <T, A, S> & rhs);          // Copy-assign
+   LIST_CONSTEXPR list <T, A, S> & operator = (list <T, A, S> && rhs);               // Move-assign
+   LIST_CONSTEXPR list <T, A, S> & operator = (const std::initializer_list<T>& il); // Initializer list assign
 
    //
    // Iterator
@@ -95,44 +314,97 @@ public:
    
    // //// THIS IS DONE
    class iterator;
-   iterator begin()  { return iterator (pHead);   }         
-   iterator rbegin() { return iterator (pTail);   }
-   iterator end()    { return iterator (nullptr); }
+   class const_iterator;
+   typedef std::reverse_iterator<iterator>       reverse_iterator;
+   typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+   LIST_CONSTEXPR iterator begin()  { return iterator (pHead,   this); }         
+   LIST_CONSTEXPR iterator end()    { return iterator (nullptr, this); }
+   LIST_CONSTEXPR const_iterator begin()  const { return const_iterator(pHead,   this); }
+   LIST_CONSTEXPR const_iterator end()    const { return const_iterator(nullptr, this); }
+   LIST_CONSTEXPR const_iterator cbegin() const { return begin(); }
+   LIST_CONSTEXPR const_iterator cend()   const { return end();   }
+   LIST_CONSTEXPR reverse_iterator       rbegin()       { return reverse_iterator(end());         }
+   LIST_CONSTEXPR reverse_iterator       rend()         { return reverse_iterator(begin());       }
+   LIST_CONSTEXPR const_reverse_iterator rbegin() const { return const_reverse_iterator(end());   }
+   LIST_CONSTEXPR const_reverse_iterator rend()   const { return const_reverse_iterator(begin()); }
    // //// THIS IS DONE
    
    //
    // Access
    //
    
-   T & front();
-   T & back();
+   LIST_CONSTEXPR T & front();
+   LIST_CONSTEXPR T & back();
 
    //
    // Insert
    //
    
-   void push_front(const T &  data);
-   void push_front(      T && data);
-   void push_back (const T &  data);
-   void push_back (      T && data);
-   iterator insert(iterator it, const T &  data);
-   iterator insert(iterator it,       T && data);
+   LIST_CONSTEXPR void push_front(const T &  data);
+   LIST_CONSTEXPR void push_front(      T && data);
+   LIST_CONSTEXPR void push_back (const T &  data);
+   LIST_CONSTEXPR void push_back (      T && data);
+   LIST_CONSTEXPR iterator insert(iterator it, const T &  data);
+   LIST_CONSTEXPR iterator insert(iterator it,       T && data);
+   template <class Iterator>
+   LIST_CONSTEXPR void append_range(Iterator first, Iterator last);
+   template <class Generator>
+   LIST_CONSTEXPR void push_back_n(size_t count, Generator gen);
 
    //
    // Remove
    //
    
-   void pop_back();
-   void pop_front();
-   void clear();
-   iterator erase(const iterator & it);
+   LIST_CONSTEXPR void pop_back();
+   LIST_CONSTEXPR void pop_front();
+   LIST_CONSTEXPR void clear();
+   LIST_CONSTEXPR iterator erase(const iterator & it);
+   LIST_CONSTEXPR size_t remove(const T & value);
+   template <class Predicate>
+   LIST_CONSTEXPR size_t remove_if(Predicate pred);
+   LIST_CONSTEXPR size_t unique();
+   template <class BinaryPredicate>
+   LIST_CONSTEXPR size_t unique(BinaryPredicate pred);
+
+   //
+   // Reorder
+   //
+
+   LIST_CONSTEXPR void swap(list <T, A, S> & rhs);
+   LIST_CONSTEXPR void reverse();
+   LIST_CONSTEXPR list <T, A, S> split_at(iterator it);
+   LIST_CONSTEXPR list <T, A, S> split_at(iterator it, size_t numTail);
+   LIST_CONSTEXPR list <T, A, S> split_half();
+   LIST_CONSTEXPR void splice(iterator it, list <T, A, S> & rhs);
 
    //
    // Status
    //
    
-   bool empty()  const { return numElements; } 
-   size_t size() const { return numElements > 0 ? numElements : 0 ; } 
+   LIST_CONSTEXPR bool empty()  const { return numElements == 0; } 
+   LIST_CONSTEXPR A get_allocator() const { return alloc; }
+   LIST_CONSTEXPR size_t size() const { return numElements > 0 ? numElements : 0 ; } 
+   LIST_CONSTEXPR list_memory memory_usage() const;
+   LIST_CONSTEXPR const S & stats() const { return *this; }
+
+   //
+   // Background clear
+   //
+
+   // when on, clear() and the destructor hand a long chain to the
+   // reclaimer thread instead of freeing it here. The setting stays
+   // with this list: it is not copied, moved or swapped. Only an
+   // allocator that background_reclaim<A> vouches for is used from
+   // that thread; with any other the nodes are still freed here
+   LIST_CONSTEXPR void reclaim_in_background(bool on) { backgroundClear = on; }
+   LIST_CONSTEXPR bool reclaims_in_background() const { return backgroundClear; }
+
+   //
+   // Serialize
+   //
+
+   void save(std::ostream & out) const;
+   void load(std::istream & in);
 
 #ifdef DEBUG // make this visible to the unit tests
 public:
@@ -142,11 +414,57 @@ private:
    // nested linked list class
    class Node;
 
+   // every node is allocated and freed through A, rebound to Node
+   typedef std::allocator_traits<A> AllocTraits;
+   typedef typename AllocTraits::template rebind_alloc<Node> NodeAlloc;
+   typedef std::allocator_traits<NodeAlloc> NodeTraits;
+   template <class ... Args>
+   LIST_CONSTEXPR Node * newNode(Args && ... args);
+   LIST_CONSTEXPR void deleteNode(Node * p);
+
+   // an out-of-line payload is allocated through A, next to its node
+   typedef typename node_layout<T>::type Layout;
+   typedef typename AllocTraits::template rebind_alloc<T> PayloadAlloc;
+   typedef std::allocator_traits<PayloadAlloc> PayloadTraits;
+   typedef std::integral_constant<bool,
+      std::is_same<Layout, payload_out_of_line>::value> OutOfLine;
+   template <class ... Args>
+   LIST_CONSTEXPR Node * newNode(std::false_type, Args && ... args);
+   template <class ... Args>
+   LIST_CONSTEXPR Node * newNode(std::true_type, Args && ... args);
+   LIST_CONSTEXPR void deleteNode(Node * p, std::false_type);
+   LIST_CONSTEXPR void deleteNode(Node * p, std::true_type);
+   LIST_CONSTEXPR iterator linkBefore(iterator it, Node * pNew);
+
+   // link a chain built off to the side onto the end of the list
+   LIST_CONSTEXPR void spliceBack(Node * pFirst, Node * pLast, size_t num);
+   LIST_CONSTEXPR void freeChain(Node * p);
+   template <class MakeNode>
+   LIST_CONSTEXPR void appendChain(MakeNode makeNode);
+   template <class Iterator>
+   LIST_CONSTEXPR void assignRange(Iterator first, Iterator last);
+
+   // whether the allocator follows the nodes is up to A's traits
+   LIST_CONSTEXPR void takeNodes(list <T, A, S> & rhs);
+   LIST_CONSTEXPR void moveAssign(list <T, A, S> & rhs, std::true_type);
+   LIST_CONSTEXPR void moveAssign(list <T, A, S> & rhs, std::false_type);
+   LIST_CONSTEXPR void copyAlloc (const list <T, A, S> & rhs, std::true_type);
+   LIST_CONSTEXPR void copyAlloc (const list <T, A, S> &, std::false_type) { }
+   LIST_CONSTEXPR void swapAlloc (list <T, A, S> & rhs, std::true_type);
+   LIST_CONSTEXPR void swapAlloc (list <T, A, S> & rhs, std::false_type);
+
+   // save() and load() move payloads through a buffer of this many bytes
+   static constexpr size_t SERIALIZE_BLOCK = 16384;
+
+   // a chain cut loose by clear(), for the reclaimer to free
+   class ReclaimJob;
+
    // member variables
    A    alloc;         // use alloacator for memory allocation
    size_t numElements; // though we could count, it is faster to keep a variable
    Node * pHead;       // pointer to the beginning of the list
    Node * pTail;       // pointer to the ending of the list
+   bool backgroundClear = false; // clear() posts long chains to the reclaimer
 };
 
 /*************************************************
@@ -154,98 +472,209 @@ private:
  * the node class.  Since we do not validate any
  * of the setters, there is no point in making them
  * private.  This is the case because only the
- * List class can make validation decisions
+ * List class can make validation decisions.
+ * The members, data, pNext and pPrev, come from
+ * node_fields in the order node_layout<T> asks for
  *************************************************/
-template <typename T, typename A>
-class list <T, A> :: Node
+template <typename T, typename A, typename S>
+class list <T, A, S> :: Node : public node_fields <typename list <T, A, S> ::Node, T, typename list <T, A, S> ::Layout>
 {
 public:
    //
    // Construct
    //
-   Node(               ) : pNext(nullptr), pPrev(nullptr), data(               ) { } // Default constructor
-   Node(const T &  data) : pNext(nullptr), pPrev(nullptr), data(data           ) { } // Copy Constructor
-   Node(      T && data) : pNext(nullptr), pPrev(nullptr), data(std::move(data)) { } // Move Constructor
+   template <class ... Args>
+   LIST_CONSTEXPR Node(Args && ... args) :
+      node_fields <Node, T, Layout> (std::forward<Args>(args)...) { }
+};
 
-   //
-   // Member Variables
-   //
+/*************************************************
+ * LIST RECLAIM JOB
+ * Owns a detached chain in a list of its own and
+ * frees it from the front, a batch at a time, on
+ * the reclaimer's thread
+ ************************************************/
+template <typename T, typename A, typename S>
+class list <T, A, S> ::ReclaimJob : public reclaimer::Job
+{
+public:
+   ReclaimJob(list <T, A, S> & rhs) : reclaimer::Job(rhs.numElements), chain(rhs.alloc)
+   {
+      chain.pHead = rhs.pHead;
+      chain.pTail = rhs.pTail;
+      chain.numElements = rhs.numElements;
+      rhs.pHead = rhs.pTail = nullptr;
+      rhs.numElements = 0;
+   }
 
-   T data;             // user data
-   Node * pNext;       // pointer to next node
-   Node * pPrev;       // pointer to previous node
+   size_t reclaim(size_t num) override
+   {
+      size_t numFreed = 0;
+      for (; numFreed < num && !chain.empty(); numFreed++)
+         chain.pop_front();
+      return numFreed;
+   }
+
+private:
+   list <T, A, S> chain;
 };
 
 /*************************************************
  * LIST ITERATOR
  * Iterate through a List, non-constant version
  ************************************************/
-template <typename T, typename A>
-class list <T, A> ::iterator
+template <typename T, typename A, typename S>
+class list <T, A, S> ::iterator
 {
+    friend class list <T, A, S> ::const_iterator;
 public:
+    // what std::iterator_traits reports to the standard algorithms
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T                               value_type;
+    typedef std::ptrdiff_t                  difference_type;
+    typedef T *                             pointer;
+    typedef T &                             reference;
+
     //
     // Construct -- Steve
     //
 
     // constructors, destructors, and assignment operator
-    iterator(){ p = nullptr; }
-    iterator(Node* pRHS) { p = pRHS; }
-    iterator(const iterator& rhs) { p = rhs.p; }
-    iterator& operator = (const iterator& rhs)
+    LIST_CONSTEXPR iterator(){ p = nullptr; pList = nullptr; }
+    LIST_CONSTEXPR iterator(Node* pRHS, const list <T, A, S> * pList = nullptr) { p = pRHS; this->pList = pList; }
+    LIST_CONSTEXPR iterator(const iterator& rhs) { p = rhs.p; pList = rhs.pList; }
+    LIST_CONSTEXPR iterator& operator = (const iterator& rhs)
     {
         this->p = rhs.p;
+        this->pList = rhs.pList;
         return *this;
     }
 
     // equals, not equals operator
-    bool operator != (const iterator& rhs) const { return (rhs.p != p ? true : false); }
-    bool operator == (const iterator& rhs) const { return (rhs.p == p ? true : false); }
+    LIST_CONSTEXPR bool operator != (const iterator& rhs) const { return (rhs.p != p ? true : false); }
+    LIST_CONSTEXPR bool operator == (const iterator& rhs) const { return (rhs.p == p ? true : false); }
 
     // dereference operator, fetch a node
-    T& operator * ()
+    LIST_CONSTEXPR T& operator * () const
     {
         return p->data;
     }
+    LIST_CONSTEXPR T* operator -> () const
+    {
+        return &p->data;
+    }
 
     // postfix increment
-    iterator operator ++ (int postfix)
+    LIST_CONSTEXPR iterator operator ++ (int postfix)
     {
-        iterator i = p;
-        p++;
+        iterator i = *this;
+        ++(*this);
         return i;
     }
 
     // prefix increment
-    iterator& operator ++ ()
+    LIST_CONSTEXPR iterator& operator ++ ()
     {
-        p++;
+        p = p->pNext;
+        if (pList)
+            pList->stats().on_increment();
         return *this;
     }
 
     // postfix decrement
-    iterator operator -- (int postfix)
+    LIST_CONSTEXPR iterator operator -- (int postfix)
     {
-        iterator i = p;
-        if (p > 0)
-            p--;
+        iterator i = *this;
+        --(*this);
         return i;
     }
 
-    // prefix decrement
-    iterator& operator -- ()
+    // prefix decrement: end() steps back onto the tail
+    LIST_CONSTEXPR iterator& operator -- ()
     {
-        if (p > 0)
-            p--;
+        p = p ? p->pPrev : pList->pTail;
+        if (pList)
+            pList->stats().on_increment();
         return *this;
     }
     //
     // Insert -- Jon
     //
-    // two friends who need to access p directly
-    friend iterator list <T, A> ::insert(iterator it, const T& data);
-    friend iterator list <T, A> ::insert(iterator it, T&& data);
-    friend iterator list <T, A> ::erase(const iterator& it);
+    // friends who need to access p directly
+    friend iterator list <T, A, S> ::insert(iterator it, const T& data);
+    friend iterator list <T, A, S> ::insert(iterator it, T&& data);
+    friend iterator list <T, A, S> ::erase(const iterator& it);
+    friend iterator list <T, A, S> ::linkBefore(iterator it, Node * pNew);
+    friend list <T, A, S> list <T, A, S> ::split_at(iterator it);
+    friend list <T, A, S> list <T, A, S> ::split_at(iterator it, size_t numTail);
+    friend void list <T, A, S> ::splice(iterator it, list <T, A, S> & rhs);
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+
+    typename list <T, A, S> ::Node* p;
+    const list <T, A, S> * pList;   // only needed to step back from end()
+};
+
+/*************************************************
+ * LIST CONST ITERATOR
+ * Iterate through a List, constant version
+ ************************************************/
+template <typename T, typename A, typename S>
+class list <T, A, S> ::const_iterator
+{
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T                               value_type;
+    typedef std::ptrdiff_t                  difference_type;
+    typedef const T *                       pointer;
+    typedef const T &                       reference;
+
+    // constructors; any iterator can be read through a const_iterator
+    LIST_CONSTEXPR const_iterator() : p(nullptr), pList(nullptr) { }
+    LIST_CONSTEXPR const_iterator(const Node * p, const list <T, A, S> * pList = nullptr) : p(p), pList(pList) { }
+    LIST_CONSTEXPR const_iterator(const iterator & rhs) : p(rhs.p), pList(rhs.pList) { }
+
+    // equals, not equals operator
+    LIST_CONSTEXPR bool operator != (const const_iterator & rhs) const { return rhs.p != p; }
+    LIST_CONSTEXPR bool operator == (const const_iterator & rhs) const { return rhs.p == p; }
+
+    // dereference operator, fetch a node
+    LIST_CONSTEXPR const T & operator * () const { return p->data; }
+    LIST_CONSTEXPR const T * operator -> () const { return &p->data; }
+
+    // increment
+    LIST_CONSTEXPR const_iterator & operator ++ ()
+    {
+        p = p->pNext;
+        if (pList)
+            pList->stats().on_increment();
+        return *this;
+    }
+    LIST_CONSTEXPR const_iterator operator ++ (int)
+    {
+        const_iterator i = *this;
+        ++(*this);
+        return i;
+    }
+
+    // decrement: end() steps back onto the tail
+    LIST_CONSTEXPR const_iterator & operator -- ()
+    {
+        p = p ? p->pPrev : pList->pTail;
+        if (pList)
+            pList->stats().on_increment();
+        return *this;
+    }
+    LIST_CONSTEXPR const_iterator operator -- (int)
+    {
+        const_iterator i = *this;
+        --(*this);
+        return i;
+    }
 
 #ifdef DEBUG // make this visible to the unit tests
 public:
@@ -253,15 +682,16 @@ public:
 private:
 #endif
 
-    typename list <T, A> ::Node* p;
+    const typename list <T, A, S> ::Node * p;
+    const list <T, A, S> * pList;
 };
 
 /*****************************************
  * LIST :: NON-DEFAULT constructors
  * Create a list initialized to a value
  ****************************************/
-template <typename T, typename A>
-list <T, A> ::list(size_t num, const T & t, const A& a) 
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list <T, A, S> ::list(size_t num, const T & t, const A& a) : alloc(a)
 {
     // Fill constructor
     /*IF (num)
@@ -277,28 +707,33 @@ list <T, A> ::list(size_t num, const T & t, const A& a)
           pTail <- pNew
           numElements <- num*/
 
-
+   numElements = 0;
+   pHead = pTail = nullptr;
+   size_t i = 0;
+   appendChain([&]() { return i++ < num ? newNode(t) : nullptr; });
 }
 
 /*****************************************
  * LIST :: NON-DEFAULT constructors
  * Create a list initialized to a value
  ****************************************/
-template <typename T, typename A>
-list <T, A> ::list(size_t num, const A& a) 
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list <T, A, S> ::list(size_t num, const A& a) : alloc(a)
 {
-   numElements = 99;
-   pHead = pTail = new list <T, A> ::Node();
-
+   numElements = 0;
+   pHead = pTail = nullptr;
+   size_t i = 0;
+   appendChain([&]() { return i++ < num ? newNode() : nullptr; });
 }
 
 /*****************************************
  * LIST :: MOVE constructors
- * Steal the values from the RHS
+ * Steal the values from the RHS. The allocator
+ * comes along with the nodes
  ****************************************/
-template <typename T, typename A>
-list <T, A> ::list(list <T, A>&& rhs, const A& a) :
-   numElements(rhs.numElements), pHead(rhs.pHead), pTail(rhs.pTail), alloc(a)
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list <T, A, S> ::list(list <T, A, S>&& rhs) :
+   alloc(std::move(rhs.alloc)), numElements(rhs.numElements), pHead(rhs.pHead), pTail(rhs.pTail)
 {
     /*list.move - constructor(rhs)
         pHead <- rhs.pHead
@@ -313,6 +748,25 @@ list <T, A> ::list(list <T, A>&& rhs, const A& a) :
    rhs.numElements = 0;
 }
 
+/*****************************************
+ * LIST :: MOVE constructors
+ * With a different allocator we cannot take the
+ * RHS's nodes, because a would not be able to free
+ * them. Then each item is moved into a new node
+ ****************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list <T, A, S> ::list(list <T, A, S>&& rhs, const A& a) :
+   alloc(a), numElements(0), pHead(nullptr), pTail(nullptr)
+{
+   if (alloc == rhs.alloc)
+      takeNodes(rhs);
+   else
+   {
+      append_range(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+      rhs.clear();
+   }
+}
+
 /**********************************************
  * LIST :: assignment operator - MOVE 
  * Copy one list onto another
@@ -320,19 +774,14 @@ list <T, A> ::list(list <T, A>&& rhs, const A& a) :
  *     OUTPUT :
  *     COST   : O(n) with respect to the size of the LHS 
  *********************************************/
-template <typename T, typename A> // --Shaun
-list <T, A>& list <T, A> :: operator = (list <T, A> && rhs)
+template <typename T, typename A, typename S> // --Shaun
+LIST_CONSTEXPR list <T, A, S>& list <T, A, S> :: operator = (list <T, A, S> && rhs)
 {
     /*list.move-assignment(rhs)
      clear()
      swap(rhs)*/
-    this->clear();
-
-    if (this->capacity() < rhs.size())
-        this->resize(rhs.size());
-
-    for (int i = 0; i < rhs.size(); i++)
-        this->insert(rhs.data[i]);
+    if (this != &rhs)
+        moveAssign(rhs, typename AllocTraits::propagate_on_container_move_assignment());
 
     return *this;
 }
@@ -344,15 +793,19 @@ list <T, A>& list <T, A> :: operator = (list <T, A> && rhs)
  *     OUTPUT :
  *     COST   : O(n) with respect to the number of nodes
  *********************************************/
-template <typename T, typename A> // --Shaun
-list <T, A> & list <T, A> :: operator = (list <T, A> & rhs)
+template <typename T, typename A, typename S> // --Shaun
+LIST_CONSTEXPR list <T, A, S> & list <T, A, S> :: operator = (const list <T, A, S> & rhs)
 {
     /*list.copy-assignment(rhs)
          clear()
          FOREACH it IN rhs
          push_back(*it)
          RETURN this*/
+    if (this == &rhs)
+        return *this;
 
+    copyAlloc(rhs, typename AllocTraits::propagate_on_container_copy_assignment());
+    assignRange(rhs.begin(), rhs.end());
     return *this;
 }
 
@@ -363,8 +816,8 @@ list <T, A> & list <T, A> :: operator = (list <T, A> & rhs)
  *     OUTPUT :
  *     COST   : O(n) with respect to the number of nodes
  *********************************************/
-template <typename T, typename A> // --Shaun
-list <T, A>& list <T, A> :: operator = (const std::initializer_list<T>& rhs)
+template <typename T, typename A, typename S> // --Shaun
+LIST_CONSTEXPR list <T, A, S>& list <T, A, S> :: operator = (const std::initializer_list<T>& rhs)
 {
     /*list.copy-assignment(rhs)
          itRHS <- rhs.begin() Fill existing nodes
@@ -390,26 +843,157 @@ list <T, A>& list <T, A> :: operator = (const std::initializer_list<T>& rhs)
          numElements--
          pTail.pNext <- NULL
         */
+   assignRange(rhs.begin(), rhs.end());
    return *this;
 }
 
+/**********************************************
+ * LIST :: ASSIGN RANGE
+ * Make the list hold a copy of [first, last). The
+ * nodes we already have are assigned over, then we
+ * either append what is left of the range or free
+ * the nodes that are left over
+ *     INPUT  : the range to copy
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the larger of the two
+ *********************************************/
+template <typename T, typename A, typename S>
+template <class Iterator>
+LIST_CONSTEXPR void list <T, A, S> ::assignRange(Iterator first, Iterator last)
+{
+   stats().on_walk(numElements);
+   Node * p = pHead;
+   for (; p != nullptr && first != last; p = p->pNext, ++first)
+      p->data = *first;
+
+   if (first != last)
+      append_range(first, last);
+   else if (p != nullptr)
+   {
+      pTail = p->pPrev;
+      if (pTail)
+         pTail->pNext = nullptr;
+      else
+         pHead = nullptr;
+      stats().on_relink(pTail ? 1 : 0);
+      for (Node * pExtra = p; pExtra; pExtra = pExtra->pNext)
+         numElements--;
+      freeChain(p);
+   }
+}
+
+/**********************************************
+ * LIST :: TAKE NODES
+ * Take every node from the RHS, whose allocator
+ * is known to be able to free them
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::takeNodes(list <T, A, S> & rhs)
+{
+   clear();
+   pHead = rhs.pHead;
+   pTail = rhs.pTail;
+   numElements = rhs.numElements;
+   rhs.pHead = rhs.pTail = nullptr;
+   rhs.numElements = 0;
+}
+
+/**********************************************
+ * LIST :: MOVE ASSIGN
+ * When A propagates on move assignment, the
+ * allocator follows the nodes. Otherwise we keep
+ * ours, and can only take the nodes if it could
+ * free them; if not, each item is moved over
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::moveAssign(list <T, A, S> & rhs, std::true_type)
+{
+   clear();
+   alloc = std::move(rhs.alloc);
+   takeNodes(rhs);
+}
+
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::moveAssign(list <T, A, S> & rhs, std::false_type)
+{
+   if (alloc == rhs.alloc)
+      takeNodes(rhs);
+   else
+   {
+      assignRange(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+      rhs.clear();
+   }
+}
+
+/**********************************************
+ * LIST :: COPY ALLOC
+ * When A propagates on copy assignment, nodes made
+ * by our old allocator must go before we take the
+ * RHS's allocator
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::copyAlloc(const list <T, A, S> & rhs, std::true_type)
+{
+   if (alloc != rhs.alloc)
+   {
+      clear();
+      alloc = rhs.alloc;
+   }
+}
+
+/**********************************************
+ * LIST :: SWAP ALLOC
+ * Allocators that do not propagate on swap must
+ * already be equal, so there is nothing to do
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::swapAlloc(list <T, A, S> & rhs, std::true_type)
+{
+   using std::swap;
+   swap(alloc, rhs.alloc);
+}
+
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::swapAlloc(list <T, A, S> & rhs, std::false_type)
+{
+   assert(alloc == rhs.alloc);
+}
+
 /**********************************************
  * LIST :: CLEAR
- * Remove all the items currently in the linked list
+ * Remove all the items currently in the linked list.
+ * In background clear mode a long chain is posted
+ * to the reclaimer instead, which frees it later,
+ * if the allocator is safe to use from its thread
  *     INPUT  :
  *     OUTPUT :
- *     COST   : O(n) with respect to the number of nodes
+ *     COST   : O(n) with respect to the number of nodes,
+ *              O(1) in background clear mode
  *********************************************/
-template <typename T, typename A> // -- Alex (stolen by steve)
-void list <T, A> :: clear()
+template <typename T, typename A, typename S> // -- Alex (stolen by steve)
+LIST_CONSTEXPR void list <T, A, S> :: clear()
 {
+    if (backgroundClear && background_reclaim<A>::value &&
+        numElements >= reclaimer::INLINE_BELOW)
+    {
+        // if there is no memory for the job, free the chain right here
+        size_t numPosted = numElements;
+        ReclaimJob * pJob = new (std::nothrow) ReclaimJob(*this);
+        if (pJob)
+        {
+            stats().on_free(numPosted);
+            reclaimer::global().post(pJob);
+        }
+    }
+
+    stats().on_walk(numElements);
     if (numElements > 0) {
         while (pHead != nullptr)
         {
             Node* pDelete = pHead;
             pHead = pHead->pNext;
             if(pDelete)
-                delete pDelete;
+                deleteNode(pDelete);
         }
     }
     // Set list default values
@@ -424,10 +1008,10 @@ void list <T, A> :: clear()
  *    OUTPUT :
  *    COST   : O(1)
  *********************************************/
-template <typename T, typename A> 
-void list <T, A> :: push_back(const T & data)
+template <typename T, typename A, typename S> 
+LIST_CONSTEXPR void list <T, A, S> :: push_back(const T & data)
 {
-    Node* pNew = new Node(data);
+    Node* pNew = newNode(data);
 
     if (numElements == 0)
     {
@@ -438,16 +1022,30 @@ void list <T, A> :: push_back(const T & data)
         pTail->pNext = pNew;
         pNew->pPrev = pTail;
         pTail = pNew;
+        stats().on_relink(2);
     }
 
     numElements++;
 }
 
-template <typename T, typename A>
-void list <T, A> ::push_back(T && data)
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::push_back(T && data)
 {
+    Node* pNew = newNode(std::move(data));
 
+    if (numElements == 0)
+    {
+        pHead = pTail = pNew;
+    }
+    else
+    {
+        pTail->pNext = pNew;
+        pNew->pPrev = pTail;
+        pTail = pNew;
+        stats().on_relink(2);
+    }
 
+    numElements++;
 }
 
 /*********************************************
@@ -457,10 +1055,10 @@ void list <T, A> ::push_back(T && data)
  *     OUTPUT :
  *     COST   : O(1)
  *********************************************/
-template <typename T, typename A>
-void list <T, A> :: push_front(const T & data)
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> :: push_front(const T & data)
 {
-    Node* pNew = new Node(data);
+    Node* pNew = newNode(data);
     if (pNew != nullptr) {
         if (numElements == 0)
         {
@@ -471,15 +1069,16 @@ void list <T, A> :: push_front(const T & data)
             pHead->pPrev = pNew;
             pNew->pNext = pHead;
             pHead = pNew;
+            stats().on_relink(2);
         }
         numElements++;
     }
 }
 
-template <typename T, typename A>
-void list <T, A> ::push_front(T && data)
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::push_front(T && data)
 {
-    Node* pNew = new Node(data);
+    Node* pNew = newNode(data);
     if (pNew != nullptr) {
         if (numElements == 0)
         {
@@ -490,6 +1089,7 @@ void list <T, A> ::push_front(T && data)
             pNew->pNext = pHead;
             pHead->pPrev = std::move(pNew);
             pHead = std::move(pNew);
+            stats().on_relink(2);
         }
         numElements++;
     }
@@ -503,13 +1103,19 @@ void list <T, A> ::push_front(T && data)
  *    OUTPUT :
  *    COST   : O(1)
  *********************************************/
-template <typename T, typename A>
-void list <T, A> ::pop_back()
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::pop_back()
 {
-    // Added by steve, but doesn't seem to change %. Must need to use allocator
     if (!empty())
     {
+        Node * pDelete = pTail;
         pTail = pTail->pPrev;
+        if (pTail)
+            pTail->pNext = nullptr;
+        else
+            pHead = nullptr;
+        stats().on_relink(pTail ? 1 : 0);
+        deleteNode(pDelete);
         numElements--;
     }
 }
@@ -521,13 +1127,19 @@ void list <T, A> ::pop_back()
  *    OUTPUT :
  *    COST   : O(1)
  *********************************************/
-template <typename T, typename A>
-void list <T, A> ::pop_front()
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::pop_front()
 {
-    // Added by steve, but doesn't seem to change %. Must need to use allocator
     if (!empty())
     {
+        Node * pDelete = pHead;
         pHead = pHead->pNext;
+        if (pHead)
+            pHead->pPrev = nullptr;
+        else
+            pTail = nullptr;
+        stats().on_relink(pHead ? 1 : 0);
+        deleteNode(pDelete);
         numElements--;
     }
 }
@@ -539,10 +1151,11 @@ void list <T, A> ::pop_front()
  *     OUTPUT : data to be displayed
  *     COST   : O(1)
  *********************************************/
-template <typename T, typename A>
-T & list <T, A> :: front()
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR T & list <T, A, S> :: front()
 {
-    
+    if (pHead == nullptr)
+        throw "ERROR: unable to access data from an empty list";
     return pHead->data; // Added by steve, seems to work fine
 }
 
@@ -553,9 +1166,11 @@ T & list <T, A> :: front()
  *     OUTPUT : data to be displayed
  *     COST   : O(1)
  *********************************************/
-template <typename T, typename A>
-T & list <T, A> :: back()
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR T & list <T, A, S> :: back()
 {
+    if (pTail == nullptr)
+        throw "ERROR: unable to access data from an empty list";
     return pTail->data; // Added by steve, seems to work fine
 }
 
@@ -567,8 +1182,8 @@ T & list <T, A> :: back()
  *     OUTPUT : iterator to the new location 
  *     COST   : O(1)
  ******************************************/
-template <typename T, typename A>
-typename list <T, A> :: iterator  list <T, A> :: erase(const list <T, A> :: iterator & it)
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR typename list <T, A, S> :: iterator  list <T, A, S> :: erase(const list <T, A, S> :: iterator & it)
 {
 //    list.erase(it)
 //    itNext <- end()
@@ -597,38 +1212,11 @@ typename list <T, A> :: iterator  list <T, A> :: erase(const list <T, A> :: iter
  *     OUTPUT : iterator to the new item
  *     COST   : O(1)
  ******************************************/
-template <typename T, typename A>
-typename list <T, A> :: iterator list <T, A> :: insert(list <T, A> :: iterator it,
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR typename list <T, A, S> :: iterator list <T, A, S> :: insert(list <T, A, S> :: iterator it,
                                                  const T & data) 
 {
-    Node* pNew = new Node(data);
-
-    if (numElements == 0)
-    {
-        pHead = pTail = pNew;
-    }
-
-    if (it.p)
-    {
-        pNew->pNext = it.p;
-        pNew->pPrev = it.p->pPrev;
-        it.p->pPrev = pNew;
-
-        if (pNew->pPrev)
-            pNew->pPrev->pNext = pNew;
-
-        if (it.p == pHead)
-            pHead = pNew;
-    }
-    else
-    {
-        pTail->pNext = pNew;
-        pNew->pPrev = pTail;
-        pTail = pNew;
-    }
-
-    numElements++;
-    return iterator(pNew);
+    return linkBefore(it, newNode(data));
 }
 
 
@@ -640,22 +1228,529 @@ typename list <T, A> :: iterator list <T, A> :: insert(list <T, A> :: iterator i
  *     OUTPUT : iterator to the new item
  *     COST   : O(1)
  ******************************************/
-template <typename T, typename A>
-typename list <T, A> ::iterator list <T, A> ::insert(list <T, A> ::iterator it,
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR typename list <T, A, S> ::iterator list <T, A, S> ::insert(list <T, A, S> ::iterator it,
    T && data)
 {
-   return end();
+   return linkBefore(it, newNode(std::move(data)));
+}
+
+/******************************************
+ * LIST :: LINK BEFORE
+ * link a new node into the list just before it,
+ * or onto the end when it is end()
+ *     INPUT  : where the node goes
+ *              the node, not yet linked to anything
+ *     OUTPUT : iterator to the new node
+ *     COST   : O(1)
+ ******************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR typename list <T, A, S> ::iterator list <T, A, S> ::linkBefore(iterator it, Node * pNew)
+{
+   if (it.p)
+   {
+      pNew->pNext = it.p;
+      pNew->pPrev = it.p->pPrev;
+      it.p->pPrev = pNew;
+      if (pNew->pPrev)
+         pNew->pPrev->pNext = pNew;
+      else
+         pHead = pNew;
+      stats().on_relink(pNew->pPrev ? 4 : 3);
+   }
+   else
+   {
+      stats().on_relink(pTail ? 2 : 1);
+      pNew->pPrev = pTail;
+      if (pTail)
+         pTail->pNext = pNew;
+      else
+         pHead = pNew;
+      pTail = pNew;
+   }
+
+   numElements++;
+   return iterator(pNew, this);
+}
+
+/******************************************
+ * LIST :: NEW NODE
+ * allocate a node through the list's allocator and
+ * construct it from args
+ *     INPUT  : what to build the node's data from
+ *     OUTPUT : the new, unlinked node
+ *     COST   : O(1)
+ ******************************************/
+template <typename T, typename A, typename S>
+template <class ... Args>
+LIST_CONSTEXPR typename list <T, A, S> ::Node * list <T, A, S> ::newNode(Args && ... args)
+{
+   Node * pNew = newNode(OutOfLine(), std::forward<Args>(args)...);
+   stats().on_allocate(1);
+   return pNew;
+}
+
+template <typename T, typename A, typename S>
+template <class ... Args>
+LIST_CONSTEXPR typename list <T, A, S> ::Node * list <T, A, S> ::newNode(std::false_type,
+                                                                  Args && ... args)
+{
+   NodeAlloc nodeAlloc(alloc);
+   Node * pNew = NodeTraits::allocate(nodeAlloc, 1);
+   try
+   {
+      NodeTraits::construct(nodeAlloc, pNew, std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      NodeTraits::deallocate(nodeAlloc, pNew, 1);
+      throw;
+   }
+   return pNew;
+}
+
+/******************************************
+ * LIST :: NEW NODE, PAYLOAD OUT OF LINE
+ * build the payload in its own block first, then a
+ * node that refers to it
+ ******************************************/
+template <typename T, typename A, typename S>
+template <class ... Args>
+LIST_CONSTEXPR typename list <T, A, S> ::Node * list <T, A, S> ::newNode(std::true_type,
+                                                                  Args && ... args)
+{
+   PayloadAlloc payloadAlloc(alloc);
+   T * pData = PayloadTraits::allocate(payloadAlloc, 1);
+   try
+   {
+      PayloadTraits::construct(payloadAlloc, pData, std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      PayloadTraits::deallocate(payloadAlloc, pData, 1);
+      throw;
+   }
+
+   try
+   {
+      return newNode(std::false_type(), *pData);
+   }
+   catch (...)
+   {
+      PayloadTraits::destroy(payloadAlloc, pData);
+      PayloadTraits::deallocate(payloadAlloc, pData, 1);
+      throw;
+   }
+}
+
+/******************************************
+ * LIST :: DELETE NODE
+ * destroy a node and give its memory back to the
+ * list's allocator
+ *     INPUT  : the node, already unlinked
+ *     OUTPUT :
+ *     COST   : O(1)
+ ******************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::deleteNode(Node * p)
+{
+   deleteNode(p, OutOfLine());
+   stats().on_free(1);
+}
+
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::deleteNode(Node * p, std::false_type)
+{
+   NodeAlloc nodeAlloc(alloc);
+   NodeTraits::destroy(nodeAlloc, p);
+   NodeTraits::deallocate(nodeAlloc, p, 1);
+}
+
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::deleteNode(Node * p, std::true_type)
+{
+   PayloadAlloc payloadAlloc(alloc);
+   T * pData = &p->data;
+   deleteNode(p, std::false_type());
+   PayloadTraits::destroy(payloadAlloc, pData);
+   PayloadTraits::deallocate(payloadAlloc, pData, 1);
+}
+
+/******************************************
+ * LIST :: SPLICE BACK
+ * link a chain of nodes that was built off to the
+ * side onto the end of the list in one step
+ *     INPUT  : the first and last node of the chain
+ *              the number of nodes in the chain
+ *     OUTPUT :
+ *     COST   : O(1)
+ ******************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::spliceBack(Node * pFirst, Node * pLast, size_t num)
+{
+   if (num == 0)
+      return;
+
+   stats().on_relink(pTail ? 3 : 2);
+   pFirst->pPrev = pTail;
+   pLast->pNext = nullptr;
+   if (pTail)
+      pTail->pNext = pFirst;
+   else
+      pHead = pFirst;
+   pTail = pLast;
+   numElements += num;
+}
+
+/******************************************
+ * LIST :: FREE CHAIN
+ * delete a chain of nodes that is not (or no longer)
+ * linked into the list
+ *     INPUT  : the first node of the chain
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the number of nodes
+ ******************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::freeChain(Node * p)
+{
+   while (p != nullptr)
+   {
+      Node * pDelete = p;
+      p = p->pNext;
+      deleteNode(pDelete);
+   }
+}
+
+/******************************************
+ * LIST :: APPEND CHAIN
+ * build nodes off to the side, one per call to
+ * makeNode() until it returns NULL, then link the
+ * whole chain onto the end of the list at once.
+ * If makeNode() throws, the partial chain is freed
+ * and the list is left as it was
+ *     INPUT  : a callable returning a new Node * or NULL
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the number of new nodes
+ ******************************************/
+template <typename T, typename A, typename S>
+template <class MakeNode>
+LIST_CONSTEXPR void list <T, A, S> ::appendChain(MakeNode makeNode)
+{
+   Node * pFirst = nullptr;
+   Node * pLast  = nullptr;
+   size_t num = 0;
+   try
+   {
+      for (Node * pNew = makeNode(); pNew != nullptr; pNew = makeNode())
+      {
+         stats().on_relink(pLast ? 2 : 1);
+         pNew->pPrev = pLast;
+         if (pLast)
+            pLast->pNext = pNew;
+         else
+            pFirst = pNew;
+         pLast = pNew;
+         num++;
+      }
+   }
+   catch (...)
+   {
+      freeChain(pFirst);
+      throw;
+   }
+
+   spliceBack(pFirst, pLast, num);
+}
+
+/******************************************
+ * LIST :: APPEND RANGE
+ * add a copy of every item in [first, last) to the
+ * end of the list. The tail and the count are only
+ * touched once, after all the nodes are built
+ *     INPUT  : the range to copy
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the size of the range
+ ******************************************/
+template <typename T, typename A, typename S>
+template <class Iterator>
+LIST_CONSTEXPR void list <T, A, S> ::append_range(Iterator first, Iterator last)
+{
+   appendChain([&]() { return first == last ? nullptr : newNode(*first++); });
+}
+
+/******************************************
+ * LIST :: PUSH BACK N
+ * add count items to the end of the list, each one
+ * made by calling gen(), like std::generate_n
+ *     INPUT  : the number of items
+ *              a callable returning a T
+ *     OUTPUT :
+ *     COST   : O(n) with respect to count
+ ******************************************/
+template <typename T, typename A, typename S>
+template <class Generator>
+LIST_CONSTEXPR void list <T, A, S> ::push_back_n(size_t count, Generator gen)
+{
+   size_t i = 0;
+   appendChain([&]() { return i++ < count ? newNode(gen()) : nullptr; });
+}
+
+/******************************************
+ * LIST :: REMOVE IF
+ * remove every item for which pred is true. Matching
+ * nodes are unlinked in a single pass and freed
+ * together at the end; surviving items are never
+ * copied or moved, only relinked. Deferring the frees
+ * also means pred may safely look at a removed item
+ *     INPUT  : a predicate taking a const T &
+ *     OUTPUT : the number of items removed
+ *     COST   : O(n) with respect to the number of nodes
+ ******************************************/
+template <typename T, typename A, typename S>
+template <class Predicate>
+LIST_CONSTEXPR size_t list <T, A, S> ::remove_if(Predicate pred)
+{
+   Node * pDead = nullptr;   // the removed nodes, linked through pNext
+   size_t numRemoved = 0;
+   stats().on_walk(numElements);
+
+   try
+   {
+      Node * p = pHead;
+      while (p)
+      {
+         Node * pNext = p->pNext;
+         if (pred(static_cast<const T &>(p->data)))
+         {
+            stats().on_relink((p->pPrev ? 1 : 0) + (pNext ? 1 : 0) + 1);
+            if (p->pPrev)
+               p->pPrev->pNext = pNext;
+            else
+               pHead = pNext;
+            if (pNext)
+               pNext->pPrev = p->pPrev;
+            else
+               pTail = p->pPrev;
+
+            p->pNext = pDead;
+            pDead = p;
+            numRemoved++;
+         }
+         p = pNext;
+      }
+   }
+   catch (...)
+   {
+      // the list is consistent at every step, so keep what we have done
+      numElements -= numRemoved;
+      freeChain(pDead);
+      throw;
+   }
+
+   numElements -= numRemoved;
+   freeChain(pDead);
+   return numRemoved;
+}
+
+/******************************************
+ * LIST :: REMOVE
+ * remove every item equal to value
+ *     INPUT  : the value to remove
+ *     OUTPUT : the number of items removed
+ *     COST   : O(n) with respect to the number of nodes
+ ******************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR size_t list <T, A, S> ::remove(const T & value)
+{
+   return remove_if([&value](const T & data) { return data == value; });
+}
+
+/******************************************
+ * LIST :: UNIQUE
+ * remove every item that pred says is equivalent to
+ * the item kept just before it, so each run of
+ * equivalent items shrinks to its first member.
+ * Like remove_if(), this is one pass with the frees
+ * batched at the end
+ *     INPUT  : a predicate taking (const T &, const T &)
+ *     OUTPUT : the number of items removed
+ *     COST   : O(n) with respect to the number of nodes
+ ******************************************/
+template <typename T, typename A, typename S>
+template <class BinaryPredicate>
+LIST_CONSTEXPR size_t list <T, A, S> ::unique(BinaryPredicate pred)
+{
+   Node * pDead = nullptr;
+   size_t numRemoved = 0;
+   stats().on_walk(numElements);
+
+   try
+   {
+      Node * pKept = pHead;
+      while (pKept && pKept->pNext)
+      {
+         Node * p = pKept->pNext;
+         if (pred(static_cast<const T &>(pKept->data), static_cast<const T &>(p->data)))
+         {
+            stats().on_relink(p->pNext ? 3 : 2);
+            pKept->pNext = p->pNext;
+            if (p->pNext)
+               p->pNext->pPrev = pKept;
+            else
+               pTail = pKept;
+
+            p->pNext = pDead;
+            pDead = p;
+            numRemoved++;
+         }
+         else
+            pKept = p;
+      }
+   }
+   catch (...)
+   {
+      numElements -= numRemoved;
+      freeChain(pDead);
+      throw;
+   }
+
+   numElements -= numRemoved;
+   freeChain(pDead);
+   return numRemoved;
+}
+
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR size_t list <T, A, S> ::unique()
+{
+   return unique([](const T & lhs, const T & rhs) { return lhs == rhs; });
+}
+
+/******************************************
+ * LIST :: SAVE
+ * write the list to a binary stream: an element count
+ * and element size header followed by the raw payloads.
+ * Payloads are gathered into a block so that the stream
+ * sees one write() per block rather than one per element
+ *     INPUT  : the stream to write to
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the number of nodes
+ ******************************************/
+template <typename T, typename A, typename S>
+void list <T, A, S> ::save(std::ostream & out) const
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "list::save() requires a trivially copyable type");
+
+   stats().on_walk(numElements);
+   std::uint64_t header[2] = { numElements, sizeof(T) };
+   out.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+   // an element larger than a block goes straight from the node
+   const size_t perBlock = SERIALIZE_BLOCK / sizeof(T);
+   if (perBlock <= 1)
+   {
+      for (Node * p = pHead; p && out; p = p->pNext)
+         out.write(reinterpret_cast<const char *>(&p->data), sizeof(T));
+      return;
+   }
+
+   alignas(T) char block[SERIALIZE_BLOCK];
+   size_t num = 0;
+   for (Node * p = pHead; p; p = p->pNext)
+   {
+      std::memcpy(block + num * sizeof(T), &p->data, sizeof(T));
+      if (++num == perBlock)
+      {
+         out.write(block, num * sizeof(T));
+         num = 0;
+      }
+   }
+   if (num)
+      out.write(block, num * sizeof(T));
+}
+
+/******************************************
+ * LIST :: LOAD
+ * replace the contents of the list with what save()
+ * wrote. The new nodes are chained together off to the
+ * side and linked in with a single spliceBack(), so the
+ * list is unchanged if the stream is short or corrupt
+ *     INPUT  : the stream to read from
+ *     OUTPUT : failbit is set on the stream on error
+ *     COST   : O(n) with respect to the number of nodes
+ ******************************************/
+template <typename T, typename A, typename S>
+void list <T, A, S> ::load(std::istream & in)
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "list::load() requires a trivially copyable type");
+
+   std::uint64_t header[2] = { 0, 0 };
+   if (!in.read(reinterpret_cast<char *>(header), sizeof(header)))
+      return;
+   if (header[1] != sizeof(T))
+   {
+      in.setstate(std::ios::failbit);
+      return;
+   }
+
+   // raw storage for one block of payloads, suitably aligned for T
+   const size_t perBlock = SERIALIZE_BLOCK / sizeof(T) > 0 ?
+                           SERIALIZE_BLOCK / sizeof(T) : 1;
+   std::allocator<T> raw;
+   auto release = [&](T * p) { raw.deallocate(p, perBlock); };
+   std::unique_ptr<T, decltype(release)> pBlock(raw.allocate(perBlock), release);
+   char * block = reinterpret_cast<char *>(pBlock.get());
+
+   Node * pFirst = nullptr;
+   Node * pLast  = nullptr;
+   std::uint64_t numLeft = header[0];
+   try
+   {
+      while (numLeft)
+      {
+         size_t num = numLeft < perBlock ? (size_t)numLeft : perBlock;
+         if (!in.read(block, num * sizeof(T)))
+         {
+            freeChain(pFirst);
+            return;
+         }
+
+         for (size_t i = 0; i < num; i++)
+         {
+            Node * pNew = newNode(*reinterpret_cast<const T *>(block + i * sizeof(T)));
+            stats().on_relink(pLast ? 2 : 1);
+            pNew->pPrev = pLast;
+            if (pLast)
+               pLast->pNext = pNew;
+            else
+               pFirst = pNew;
+            pLast = pNew;
+         }
+         numLeft -= num;
+      }
+   }
+   catch (...)
+   {
+      freeChain(pFirst);
+      throw;
+   }
+
+   clear();
+   spliceBack(pFirst, pLast, (size_t)header[0]);
 }
 
 /**********************************************
- * LIST :: assignment operator - MOVE                -- Shaun
- * Copy one list onto another
- *     INPUT  : a list to be moved
+ * LIST :: SWAP
+ * Exchange the contents of two lists. Only the
+ * head, tail and count change hands, and the
+ * allocator too if A propagates on swap
+ *     INPUT  : the list to swap with
  *     OUTPUT :
- *     COST   : O(n) with respect to the size of the LHS
+ *     COST   : O(1)
  *********************************************/
-template <typename T, typename A>
-void swap(list <T, A> & lhs, list <T, A> & rhs)
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::swap(list <T, A, S> & rhs)
 {
     /*list.swap(rhs)
      tempHead <- rhs.pHead
@@ -668,11 +1763,194 @@ void swap(list <T, A> & lhs, list <T, A> & rhs)
      rhs.numElements <- numElements
      numElements <- tempElements
     */
-    list <T> test = std::move(lhs);
-    lhs = std::move(rhs);
-    rhs = std::move(test);
+    std::swap(pHead, rhs.pHead);
+    std::swap(pTail, rhs.pTail);
+    std::swap(numElements, rhs.numElements);
+    swapAlloc(rhs, typename AllocTraits::propagate_on_container_swap());
+}
+
+/**********************************************
+ * LIST :: REVERSE
+ * Reverse the order of the items by flipping the
+ * links of every node in place
+ *     INPUT  :
+ *     OUTPUT :
+ *     COST   : O(n) with respect to the number of nodes
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::reverse()
+{
+    for (Node * p = pHead; p; p = p->pPrev)
+        std::swap(p->pNext, p->pPrev);
+    std::swap(pHead, pTail);
+    stats().on_walk(numElements);
+    stats().on_relink(2 * numElements);
+}
+
+/**********************************************
+ * LIST :: SPLIT AT
+ * Cut the list in two just before it. Everything from
+ * it to the end is handed to a new list; no node is
+ * copied, moved or reallocated. The caller who already
+ * knows how many items are in the tail can pass it in
+ * and skip the walk that counts them
+ *     INPUT  : where the second list starts
+ *              (optional) the number of items from it to the end
+ *     OUTPUT : the second list
+ *     COST   : O(1) given numTail, otherwise O(numTail)
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list <T, A, S> list <T, A, S> ::split_at(iterator it)
+{
+    size_t numTail = 0;
+    for (Node * p = it.p; p; p = p->pNext)
+        numTail++;
+    stats().on_walk(numTail);
+    return split_at(it, numTail);
+}
+
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list <T, A, S> list <T, A, S> ::split_at(iterator it, size_t numTail)
+{
+    list <T, A, S> rhs(alloc);
+    if (it.p == nullptr)
+        return rhs;
+    assert(numTail > 0 && numTail <= numElements);
+
+    rhs.pHead = it.p;
+    rhs.pTail = pTail;
+    rhs.numElements = numTail;
+
+    pTail = it.p->pPrev;
+    if (pTail)
+        pTail->pNext = nullptr;
+    else
+        pHead = nullptr;
+    it.p->pPrev = nullptr;
+    stats().on_relink(pTail ? 2 : 1);
+    numElements -= numTail;
+
+    return rhs;
+}
+
+/**********************************************
+ * LIST :: SPLIT HALF
+ * Give the back half of the list to a new list. The
+ * size is known, so we walk straight to the middle.
+ * When the count is odd, the extra item stays here
+ *     INPUT  :
+ *     OUTPUT : the back half
+ *     COST   : O(n/2) with respect to the number of nodes
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list <T, A, S> list <T, A, S> ::split_half()
+{
+    size_t numFront = numElements - numElements / 2;
+    Node * p = pHead;
+    for (size_t i = 0; i < numFront; i++)
+        p = p->pNext;
+    stats().on_walk(numFront);
+    return split_at(iterator(p, this), numElements - numFront);
 }
 
+/**********************************************
+ * LIST :: SPLICE
+ * Move every node of the RHS in just before it,
+ * leaving the RHS empty. The nodes are relinked,
+ * not copied, as long as our allocator can free
+ * them; if it cannot, each item is moved over
+ *     INPUT  : where the RHS goes, and the RHS
+ *     OUTPUT :
+ *     COST   : O(1), O(n) when the allocators differ
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void list <T, A, S> ::splice(iterator it, list <T, A, S> & rhs)
+{
+   if (&rhs == this || rhs.pHead == nullptr)
+      return;
+
+   if (alloc != rhs.alloc)
+   {
+      for (T & t : rhs)
+         insert(it, std::move(t));
+      rhs.clear();
+      return;
+   }
+
+   if (it.p == nullptr)
+      spliceBack(rhs.pHead, rhs.pTail, rhs.numElements);
+   else
+   {
+      stats().on_relink(it.p->pPrev ? 4 : 3);
+      rhs.pHead->pPrev = it.p->pPrev;
+      rhs.pTail->pNext = it.p;
+      if (it.p->pPrev)
+         it.p->pPrev->pNext = rhs.pHead;
+      else
+         pHead = rhs.pHead;
+      it.p->pPrev = rhs.pTail;
+      numElements += rhs.numElements;
+   }
+   rhs.pHead = rhs.pTail = nullptr;
+   rhs.numElements = 0;
+}
+
+/**********************************************
+ * LIST :: MEMORY USAGE
+ * What the list costs: the object, its nodes split
+ * into payload and links, and the rounding the
+ * allocator adds to each block on top. An out-of-
+ * line payload is a block of its own
+ *     OUTPUT : the bytes, by where they go
+ *     COST   : O(1)
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR list_memory list <T, A, S> ::memory_usage() const
+{
+   size_t nodeSlack = allocator_block_size<NodeAlloc>::get(NodeAlloc(alloc)) - sizeof(Node);
+   size_t payloadSize = 0;
+   size_t payloadSlack = 0;
+   if (OutOfLine::value)
+   {
+      payloadSize = sizeof(T);
+      payloadSlack = allocator_block_size<PayloadAlloc>::get(PayloadAlloc(alloc)) - sizeof(T);
+   }
+
+   list_memory m = {};
+   m.list_bytes    = sizeof(*this);
+   m.node_bytes    = numElements * (sizeof(Node) + payloadSize);
+   m.payload_bytes = numElements * sizeof(T);
+   m.link_bytes    = m.node_bytes - m.payload_bytes;
+   m.slack_bytes   = numElements * (nodeSlack + payloadSlack);
+   return m;
+}
+
+/**********************************************
+ * SWAP                                        -- Shaun
+ * Exchange the contents of two lists
+ *     INPUT  : the two lists
+ *     OUTPUT :
+ *     COST   : O(1)
+ *********************************************/
+template <typename T, typename A, typename S>
+LIST_CONSTEXPR void swap(list <T, A, S> & lhs, list <T, A, S> & rhs)
+{
+    lhs.swap(rhs);
+}
+
+#ifdef __cpp_lib_memory_resource
+namespace pmr
+{
+/**************************************************
+ * PMR LIST
+ * A list whose nodes come from a std::pmr::memory_resource,
+ * just like std::pmr::list
+ **************************************************/
+template <typename T>
+using list = custom::list<T, std::pmr::polymorphic_allocator<T>>;
+} // namespace pmr
+#endif // __cpp_lib_memory_resource
+
 }; // namespace custom
 
 
@@ -0,0 +1,129 @@
+/***********************************************************************
+ * Header:
+ *    LOCK-FREE STACK
+ * Summary:
+ *    A Treiber stack: a singly linked list whose head is swung by
+ *    compare-and-swap, so any number of threads push and pop at once
+ *    without a lock. Popped nodes are handed to a reclamation domain
+ *    (see reclamation.h) rather than deleted, since another thread may
+ *    still be reading the node it lost the race for. The same domain
+ *    rules out ABA: a node cannot be freed and reused at the same
+ *    address while any thread might still compare against it.
+ *
+ *    This is also the shape of a lock-free free list; a queue or list
+ *    plugs into a domain the same way.
+ *
+ *    This will contain the class definition of:
+ *        lockfree_stack : A Treiber stack over a reclamation domain
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>          // for std::atomic
+#include <utility>         // for std::move
+#include "reclamation.h"   // for hazard_domain and epoch_domain
+
+namespace custom
+{
+
+/**************************************************
+ * LOCK-FREE STACK
+ * Push and pop from any thread, without a lock
+ **************************************************/
+template <typename T, typename Domain = hazard_domain>
+class lockfree_stack
+{
+public:
+   explicit lockfree_stack(Domain & domain = Domain::global()) :
+      pHead(nullptr), domain(domain) { }
+   lockfree_stack(const lockfree_stack &) = delete;
+   lockfree_stack & operator = (const lockfree_stack &) = delete;
+   ~lockfree_stack();
+
+   void push(const T &  data) { link(new Node(data));            }
+   void push(      T && data) { link(new Node(std::move(data))); }
+   bool pop(T & data);
+   bool empty() const { return pHead.load(std::memory_order_acquire) == nullptr; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   struct Node
+   {
+      Node(const T &  data) : data(data),            pNext(nullptr) { }
+      Node(      T && data) : data(std::move(data)), pNext(nullptr) { }
+      T      data;
+      Node * pNext;   // never changes once the node is on the stack
+   };
+
+   void link(Node * pNew);
+
+   std::atomic<Node *> pHead;
+   Domain &            domain;
+};
+
+/*****************************************
+ * LOCK-FREE STACK :: DESTRUCTOR
+ * No other thread may be using the stack, so what
+ * is left on it is freed directly
+ ****************************************/
+template <typename T, typename Domain>
+lockfree_stack <T, Domain> ::~lockfree_stack()
+{
+   Node * p = pHead.load(std::memory_order_acquire);
+   while (p)
+   {
+      Node * pNext = p->pNext;
+      delete p;
+      p = pNext;
+   }
+}
+
+/*****************************************
+ * LOCK-FREE STACK :: LINK
+ * Swing the head onto a new node. Nothing is read
+ * through another thread's node, so no guard
+ *     COST : O(1) expected
+ ****************************************/
+template <typename T, typename Domain>
+void lockfree_stack <T, Domain> ::link(Node * pNew)
+{
+   Node * pOld = pHead.load(std::memory_order_relaxed);
+   do
+      pNew->pNext = pOld;
+   while (!pHead.compare_exchange_weak(pOld, pNew, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+}
+
+/*****************************************
+ * LOCK-FREE STACK :: POP
+ * Protect the head, read its link, and swing the
+ * head past it. The winner moves the data out and
+ * retires the node
+ *     OUTPUT : whether there was anything to pop
+ *     COST   : O(1) expected
+ ****************************************/
+template <typename T, typename Domain>
+bool lockfree_stack <T, Domain> ::pop(T & data)
+{
+   typename Domain::guard g(domain);
+   for (;;)
+   {
+      Node * p = g.protect(0, pHead);
+      if (p == nullptr)
+         return false;
+      Node * pNext = p->pNext;
+      if (pHead.compare_exchange_weak(p, pNext, std::memory_order_acquire,
+                                                std::memory_order_relaxed))
+      {
+         data = std::move(p->data);
+         g.clear(0);
+         g.retire(p);
+         return true;
+      }
+   }
+}
+
+} // namespace custom
@@ -0,0 +1,393 @@
+/***********************************************************************
+ * Header:
+ *    MAGAZINE ALLOCATOR
+ * Summary:
+ *    An allocator for list nodes that keeps a small cache of free
+ *    blocks on every thread. Nodes are all the same size, so a freed
+ *    node can be handed straight to the next allocation without going
+ *    near the global heap or taking a lock.
+ *
+ *    Each thread holds two "magazines" of up to MAGAZINE_SIZE free
+ *    blocks. Allocating pops from the loaded magazine and freeing
+ *    pushes onto it. Only when both magazines are empty (or both full)
+ *    does the thread go to the shared depot, and then it trades a
+ *    whole magazine at once, so the depot's lock is taken at most
+ *    once per MAGAZINE_SIZE operations. Keeping a second magazine
+ *    means a thread that alternates between allocating and freeing
+ *    right at a magazine boundary does not visit the depot every time.
+ *
+ *    Memory is never returned to the operating system; blocks freed
+ *    by one thread are simply reused by whichever thread asks next.
+ *
+ *    stats() is kept by the depot, so it costs the fast path nothing.
+ *    The price is that a block counts as live from the moment its
+ *    magazine leaves the depot: live_blocks runs high by at most two
+ *    magazines for every thread.
+ *
+ *    This will contain the class definition of:
+ *        magazine_allocator : A std::allocator replacement for node types
+ *        magazine_pool      : The per-thread caches and shared depot
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>     // for size_t and std::max_align_t
+#include <mutex>       // for std::mutex
+#include <new>         // for ::operator new
+#include <utility>     // for std::swap
+#include "allocatorStats.h" // for allocator_stats
+
+namespace custom
+{
+
+/**************************************************
+ * MAGAZINE POOL
+ * Fixed-size blocks of Size bytes aligned to Align.
+ * Every type with the same size and alignment shares
+ * one pool
+ **************************************************/
+template <size_t Size, size_t Align>
+class magazine_pool
+{
+public:
+   // blocks held by one magazine, and carved from the heap at a time
+   static constexpr size_t MAGAZINE_SIZE = 64;
+
+   // each block must hold a pointer and keep the next block aligned
+   static constexpr size_t STRIDE =
+      ((Size > sizeof(void *) ? Size : sizeof(void *)) + Align - 1) / Align * Align;
+
+   static void * allocate();
+   static void   deallocate(void * p);
+   static allocator_stats stats();
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+
+   // a stack of free blocks
+   struct Magazine
+   {
+      Magazine() : num(0), pNext(nullptr) { }
+      size_t     num;                    // blocks in items[]
+      Magazine * pNext;                  // link in the depot's stacks
+      void     * items[MAGAZINE_SIZE];
+   };
+
+   // shared by every thread, guarded by lock
+   struct Depot
+   {
+      Depot() : pFull(nullptr), pEmpty(nullptr), pSlabs(nullptr), pStrays(nullptr),
+                numCarved(0), numSpare(0), numPeak(0), bytesReserved(0) { }
+      Magazine * swapForFull (Magazine * pEmpty);
+      Magazine * swapForEmpty(Magazine * pFull);
+      void       put(Magazine * p);
+      void       fill(Magazine * p);
+      void       stray(void * p);
+      void     * carve();
+      void       notePeak() { if (numCarved - numSpare > numPeak) numPeak = numCarved - numSpare; }
+
+      std::mutex lock;
+      Magazine * pFull;    // magazines with at least one free block
+      Magazine * pEmpty;   // magazines with no free blocks
+      void     * pSlabs;   // every slab carved so far, linked through their first word
+      void     * pStrays;  // blocks freed after their thread's cache was gone
+
+      // for stats(), all guarded by lock
+      size_t numCarved;      // blocks ever carved
+      size_t numSpare;       // of those, free blocks back in the depot
+      size_t numPeak;        // the most ever out of the depot at once
+      size_t bytesReserved;  // slabs and one-off blocks
+   };
+
+   // one per thread: the loaded magazine and the one before it
+   struct Cache
+   {
+      Cache();
+      ~Cache();
+      Magazine * pLoaded;
+      Magazine * pPrevious;
+   };
+
+   // never destroyed, so caches on exiting threads can always flush to it
+   static Depot & depot()
+   {
+      static Depot * pDepot = new Depot;
+      return *pDepot;
+   }
+
+   static Cache & cache()
+   {
+      static thread_local Cache c;
+      return c;
+   }
+
+   // set once this thread's cache is destroyed, for lists that outlive it
+   static bool & cacheGone()
+   {
+      static thread_local bool gone = false;
+      return gone;
+   }
+};
+
+/*****************************************
+ * MAGAZINE POOL :: ALLOCATE
+ * Pop a block from this thread's loaded magazine
+ *     COST : O(1), the depot is visited at most once per MAGAZINE_SIZE
+ ****************************************/
+template <size_t Size, size_t Align>
+void * magazine_pool <Size, Align> ::allocate()
+{
+   if (cacheGone())
+      return depot().carve();
+
+   Cache & c = cache();
+   if (c.pLoaded->num == 0)
+   {
+      if (c.pPrevious->num == MAGAZINE_SIZE)
+         std::swap(c.pLoaded, c.pPrevious);
+      else
+      {
+         Magazine * pFull = depot().swapForFull(c.pLoaded);
+         if (pFull)
+            c.pLoaded = pFull;
+         else
+            depot().fill(c.pLoaded);
+      }
+   }
+   return c.pLoaded->items[--c.pLoaded->num];
+}
+
+/*****************************************
+ * MAGAZINE POOL :: DEALLOCATE
+ * Push a block onto this thread's loaded magazine
+ *     COST : O(1), the depot is visited at most once per MAGAZINE_SIZE
+ ****************************************/
+template <size_t Size, size_t Align>
+void magazine_pool <Size, Align> ::deallocate(void * p)
+{
+   if (cacheGone())
+   {
+      depot().stray(p);
+      return;
+   }
+
+   Cache & c = cache();
+   if (c.pLoaded->num == MAGAZINE_SIZE)
+   {
+      if (c.pPrevious->num == 0)
+         std::swap(c.pLoaded, c.pPrevious);
+      else
+      {
+         c.pPrevious = depot().swapForEmpty(c.pPrevious);
+         std::swap(c.pLoaded, c.pPrevious);
+      }
+   }
+   c.pLoaded->items[c.pLoaded->num++] = p;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: DEPOT :: SWAP FOR FULL
+ * Trade an empty magazine for one with free blocks.
+ * Returns NULL, keeping pEmpty, when there is none
+ ****************************************/
+template <size_t Size, size_t Align>
+typename magazine_pool <Size, Align> ::Magazine *
+magazine_pool <Size, Align> ::Depot::swapForFull(Magazine * pEmpty)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   Magazine * p = pFull;
+   if (p == nullptr)
+      return nullptr;
+   pFull = p->pNext;
+   numSpare -= p->num;
+   notePeak();
+   pEmpty->pNext = this->pEmpty;
+   this->pEmpty = pEmpty;
+   return p;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: DEPOT :: SWAP FOR EMPTY
+ * Trade a full magazine for an empty one
+ ****************************************/
+template <size_t Size, size_t Align>
+typename magazine_pool <Size, Align> ::Magazine *
+magazine_pool <Size, Align> ::Depot::swapForEmpty(Magazine * pFull)
+{
+   Magazine * p = nullptr;
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      pFull->pNext = this->pFull;
+      this->pFull = pFull;
+      numSpare += pFull->num;
+      p = pEmpty;
+      if (p)
+         pEmpty = p->pNext;
+   }
+   return p ? p : new Magazine;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: DEPOT :: PUT
+ * Take back a magazine from a thread that is exiting
+ ****************************************/
+template <size_t Size, size_t Align>
+void magazine_pool <Size, Align> ::Depot::put(Magazine * p)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   Magazine * & pStack = p->num ? pFull : pEmpty;
+   p->pNext = pStack;
+   pStack = p;
+   numSpare += p->num;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: DEPOT :: FILL
+ * Carve a fresh slab from the heap into an empty
+ * magazine. The slab is remembered so it stays reachable
+ ****************************************/
+template <size_t Size, size_t Align>
+void magazine_pool <Size, Align> ::Depot::fill(Magazine * p)
+{
+   char * pSlab = static_cast<char *>(::operator new(STRIDE * (MAGAZINE_SIZE + 1)));
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      *reinterpret_cast<void **>(pSlab) = pSlabs;
+      pSlabs = pSlab;
+      numCarved += MAGAZINE_SIZE;
+      bytesReserved += STRIDE * (MAGAZINE_SIZE + 1);
+      notePeak();
+   }
+
+   // the first block holds the slab link; hand out the rest
+   for (size_t i = 0; i < MAGAZINE_SIZE; i++)
+      p->items[i] = pSlab + STRIDE * (MAGAZINE_SIZE - i);
+   p->num = MAGAZINE_SIZE;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: DEPOT :: STRAY
+ * Keep a block freed during thread shutdown. It may
+ * live inside a slab, so it cannot go back to the heap
+ ****************************************/
+template <size_t Size, size_t Align>
+void magazine_pool <Size, Align> ::Depot::stray(void * p)
+{
+   std::lock_guard<std::mutex> guard(lock);
+   *static_cast<void **>(p) = pStrays;
+   pStrays = p;
+   numSpare++;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: DEPOT :: CARVE
+ * A single block from the heap for a thread whose
+ * cache is already gone, counted like a slab's
+ ****************************************/
+template <size_t Size, size_t Align>
+void * magazine_pool <Size, Align> ::Depot::carve()
+{
+   void * p = ::operator new(STRIDE);
+   std::lock_guard<std::mutex> guard(lock);
+   numCarved++;
+   bytesReserved += STRIDE;
+   notePeak();
+   return p;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: STATS
+ * What the pool holds, as the depot sees it. Blocks
+ * in a thread's magazines count as live
+ *     OUTPUT : the snapshot
+ *     COST   : O(1)
+ ****************************************/
+template <size_t Size, size_t Align>
+allocator_stats magazine_pool <Size, Align> ::stats()
+{
+   Depot & d = depot();
+   std::lock_guard<std::mutex> guard(d.lock);
+   allocator_stats s = {};
+   s.live_blocks     = d.numCarved - d.numSpare;
+   s.peak_blocks     = d.numPeak;
+   s.bytes_requested = s.live_blocks * Size;
+   s.bytes_in_blocks = s.live_blocks * STRIDE;
+   s.bytes_reserved  = d.bytesReserved;
+   return s;
+}
+
+/*****************************************
+ * MAGAZINE POOL :: CACHE
+ * A thread starts with two empty magazines and
+ * gives them back to the depot when it exits
+ ****************************************/
+template <size_t Size, size_t Align>
+magazine_pool <Size, Align> ::Cache::Cache() :
+   pLoaded(new Magazine), pPrevious(new Magazine)
+{
+}
+
+template <size_t Size, size_t Align>
+magazine_pool <Size, Align> ::Cache::~Cache()
+{
+   depot().put(pLoaded);
+   depot().put(pPrevious);
+   cacheGone() = true;
+}
+
+/**************************************************
+ * MAGAZINE ALLOCATOR
+ * A drop-in replacement for std::allocator. Single
+ * objects come from the magazine pool for their size;
+ * arrays and over-aligned types go to the heap
+ **************************************************/
+template <typename T>
+class magazine_allocator
+{
+public:
+   typedef T value_type;
+
+   magazine_allocator() noexcept { }
+   template <typename U>
+   magazine_allocator(const magazine_allocator<U> &) noexcept { }
+
+   T * allocate(size_t n)
+   {
+      if (n == 1 && POOLED)
+         return static_cast<T *>(Pool::allocate());
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+   }
+
+   void deallocate(T * p, size_t n) noexcept
+   {
+      if (n == 1 && POOLED)
+         Pool::deallocate(p);
+      else
+         ::operator delete(p);
+   }
+
+   // what one T really takes, for list::memory_usage()
+   size_t block_size() const noexcept { return POOLED ? Pool::STRIDE : sizeof(T); }
+
+   // the pool shared by every type of T's size and alignment
+   static allocator_stats stats() { return Pool::stats(); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   typedef magazine_pool<sizeof(T), alignof(T)> Pool;
+   static constexpr bool POOLED = alignof(T) <= alignof(std::max_align_t);
+};
+
+// every magazine_allocator can free what any other one allocated
+template <typename T, typename U>
+bool operator == (const magazine_allocator<T> &, const magazine_allocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator != (const magazine_allocator<T> &, const magazine_allocator<U> &) { return false; }
+
+} // namespace custom
@@ -0,0 +1,552 @@
+/***********************************************************************
+ * Header:
+ *    MAPPED LIST
+ * Summary:
+ *    A list of trivially copyable items that lives in a memory-mapped
+ *    file. The nodes are linked with file offsets rather than pointers
+ *    so the mapping can move (when it grows, or when the file is
+ *    opened again by another process) without touching a single link.
+ *    Re-opening a list is therefore O(1): nothing is deserialized.
+ *
+ *    This will contain the class definition of:
+ *        mapped_list           : A list stored in a file
+ *        mapped_list::iterator : An iterator through the mapped list
+ ************************************************************************/
+
+#pragma once
+
+#ifndef _WIN32             // mmap() is POSIX only
+
+#include <cassert>         // for ASSERT
+#include <cstddef>         // for size_t
+#include <cstdint>         // for std::uint64_t and SIZE_MAX
+#include <new>             // for placement new
+#include <type_traits>     // for std::is_trivially_copyable
+#include <fcntl.h>         // for open()
+#include <sys/mman.h>      // for mmap()
+#include <sys/stat.h>      // for fstat()
+#include <unistd.h>        // for ftruncate()
+
+namespace custom
+{
+
+/**************************************************
+ * MAPPED LIST
+ * A doubly linked list whose nodes live in a file
+ **************************************************/
+template <typename T>
+class mapped_list
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "mapped_list requires a trivially copyable type");
+public:
+
+   //
+   // Construct
+   //
+
+   mapped_list(const char * fileName);
+   mapped_list(const mapped_list &) = delete;
+   mapped_list & operator = (const mapped_list &) = delete;
+   ~mapped_list();
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin();
+   iterator end();
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T & data);
+   void push_back (const T & data);
+   iterator insert(iterator it, const T & data);
+
+   //
+   // Remove
+   //
+
+   void pop_back();
+   void pop_front();
+   void clear();
+   iterator erase(const iterator & it);
+
+   //
+   // Status
+   //
+
+   bool   empty()    const { return pHeader->numElements == 0; }
+   size_t size()     const { return (size_t)pHeader->numElements; }
+   size_t capacity() const { return (size_t)pHeader->capacity;    }
+   void   reserve(size_t num);
+   void   sync();
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+
+   // everything in the file is addressed by its offset from the start
+   typedef std::uint64_t Offset;
+
+   // the first bytes of the file
+   struct Header
+   {
+      std::uint64_t magic;       // MAGIC
+      std::uint64_t elementSize; // sizeof(T) of the writer
+      std::uint64_t numElements; // number of linked nodes
+      std::uint64_t capacity;    // number of node slots in the file
+      std::uint64_t numUsed;     // slots that have ever been handed out
+      Offset        head;        // first node, 0 if empty
+      Offset        tail;        // last node, 0 if empty
+      Offset        freeList;    // erased nodes, linked through next
+   };
+
+   // a node in the file. Links are offsets, not pointers
+   struct Node
+   {
+      Offset next;
+      Offset prev;
+      T      data;
+   };
+
+   // identifies a mapped_list file
+   static const std::uint64_t MAGIC = 0x4c4c4953544c4d31ull;
+
+   // where the first node slot starts
+   static size_t nodesOffset()
+   {
+      return (sizeof(Header) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+   }
+
+   // convert between offsets and addresses in the current mapping
+   Node * node(Offset offset) const
+   {
+      assert(offset != 0);
+      assert(offset >= nodesOffset() && offset + sizeof(Node) <= mappedBytes);
+      return reinterpret_cast<Node *>(pBase + offset);
+   }
+
+   Offset allocateNode(const T & data);
+   void   freeNode(Offset offset);
+   void   remap(size_t numNodes);
+   bool   isSlot(Offset offset) const;
+   bool   headerValid() const;
+
+   int      fd;            // the open file
+   char   * pBase;         // start of the mapping
+   size_t   mappedBytes;   // length of the mapping
+   Header * pHeader;       // pBase viewed as the header
+};
+
+/*************************************************
+ * MAPPED LIST ITERATOR
+ * Iterate through a mapped list. The iterator holds
+ * an offset so it stays valid when the file grows
+ ************************************************/
+template <typename T>
+class mapped_list <T> ::iterator
+{
+   friend class mapped_list <T>;
+public:
+   iterator() : pList(nullptr), offset(0) { }
+   iterator(mapped_list <T> * pList, Offset offset) : pList(pList), offset(offset) { }
+
+   bool operator != (const iterator & rhs) const { return offset != rhs.offset; }
+   bool operator == (const iterator & rhs) const { return offset == rhs.offset; }
+
+   T & operator * () { return pList->node(offset)->data; }
+
+   iterator & operator ++ ()
+   {
+      offset = pList->node(offset)->next;
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld(*this);
+      ++(*this);
+      return itOld;
+   }
+   iterator & operator -- ()
+   {
+      offset = offset ? pList->node(offset)->prev : pList->pHeader->tail;
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator itOld(*this);
+      --(*this);
+      return itOld;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   mapped_list <T> * pList;
+   Offset offset;
+};
+
+/*****************************************
+ * MAPPED LIST :: CONSTRUCTOR
+ * Open the list stored in fileName, creating an
+ * empty one if the file does not exist yet
+ ****************************************/
+template <typename T>
+mapped_list <T> ::mapped_list(const char * fileName) :
+   fd(-1), pBase(nullptr), mappedBytes(0), pHeader(nullptr)
+{
+   fd = ::open(fileName, O_RDWR | O_CREAT, 0644);
+   if (fd < 0)
+      throw "ERROR: unable to open the mapped list file";
+
+   struct stat st;
+   if (::fstat(fd, &st) != 0)
+   {
+      ::close(fd);
+      throw "ERROR: unable to open the mapped list file";
+   }
+
+   // a brand new file: write an empty header
+   if (st.st_size == 0)
+   {
+      try
+      {
+         remap(0);
+      }
+      catch (...)
+      {
+         ::close(fd);
+         throw;
+      }
+      pHeader->magic       = MAGIC;
+      pHeader->elementSize = sizeof(T);
+      return;
+   }
+
+   // an existing file: map it as it stands and check it is one of ours
+   if ((size_t)st.st_size < nodesOffset())
+   {
+      ::close(fd);
+      throw "ERROR: not a mapped list file";
+   }
+   void * p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+   if (p == MAP_FAILED)
+   {
+      ::close(fd);
+      throw "ERROR: unable to map the mapped list file";
+   }
+   pBase       = static_cast<char *>(p);
+   mappedBytes = (size_t)st.st_size;
+   pHeader     = reinterpret_cast<Header *>(pBase);
+
+   if (!headerValid())
+   {
+      ::munmap(pBase, mappedBytes);
+      ::close(fd);
+      throw "ERROR: not a mapped list file for this type";
+   }
+}
+
+/*****************************************
+ * MAPPED LIST :: DESTRUCTOR
+ * Flush and unmap. The data stays in the file
+ ****************************************/
+template <typename T>
+mapped_list <T> :: ~mapped_list()
+{
+   if (pBase)
+   {
+      ::msync(pBase, mappedBytes, MS_ASYNC);
+      ::munmap(pBase, mappedBytes);
+   }
+   if (fd >= 0)
+      ::close(fd);
+}
+
+/*****************************************
+ * MAPPED LIST :: IS SLOT
+ * Whether offset is 0 or the start of a slot that
+ * has been handed out
+ ****************************************/
+template <typename T>
+bool mapped_list <T> ::isSlot(Offset offset) const
+{
+   if (offset == 0)
+      return true;
+   return offset >= nodesOffset() &&
+          (offset - nodesOffset()) % sizeof(Node) == 0 &&
+          (offset - nodesOffset()) / sizeof(Node) < pHeader->numUsed;
+}
+
+/*****************************************
+ * MAPPED LIST :: HEADER VALID
+ * Whether the header just mapped is one of ours and
+ * agrees with itself and the size of the file. The
+ * links inside the nodes are not walked, so opening
+ * stays O(1)
+ ****************************************/
+template <typename T>
+bool mapped_list <T> ::headerValid() const
+{
+   if (pHeader->magic != MAGIC || pHeader->elementSize != sizeof(T))
+      return false;
+   if (pHeader->capacity > (mappedBytes - nodesOffset()) / sizeof(Node))
+      return false;   // also rules out capacity * sizeof(Node) overflowing
+   if (pHeader->numUsed > pHeader->capacity ||
+       pHeader->numElements > pHeader->numUsed)
+      return false;
+   if (!isSlot(pHeader->head) || !isSlot(pHeader->tail) || !isSlot(pHeader->freeList))
+      return false;
+   return (pHeader->head == 0) == (pHeader->tail == 0) &&
+          (pHeader->head == 0) == (pHeader->numElements == 0);
+}
+
+/*****************************************
+ * MAPPED LIST :: REMAP
+ * Grow the file to hold numNodes slots and map it
+ * again. The mapping may move, but since every link
+ * is an offset nothing needs to be fixed up. The new
+ * mapping is made before the old one goes, so if
+ * growing fails the list is left as it was
+ ****************************************/
+template <typename T>
+void mapped_list <T> ::remap(size_t numNodes)
+{
+   if (numNodes > (SIZE_MAX - nodesOffset()) / sizeof(Node))
+      throw "ERROR: unable to grow the mapped list file";
+   size_t bytes = nodesOffset() + numNodes * sizeof(Node);
+   if (::ftruncate(fd, (off_t)bytes) != 0)
+      throw "ERROR: unable to grow the mapped list file";
+
+   void * p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (p == MAP_FAILED)
+      throw "ERROR: unable to map the mapped list file";
+   if (pBase)
+      ::munmap(pBase, mappedBytes);
+
+   pBase       = static_cast<char *>(p);
+   mappedBytes = bytes;
+   pHeader     = reinterpret_cast<Header *>(pBase);
+   pHeader->capacity = numNodes;
+}
+
+/*****************************************
+ * MAPPED LIST :: RESERVE
+ * Make room for at least num nodes
+ ****************************************/
+template <typename T>
+void mapped_list <T> ::reserve(size_t num)
+{
+   if (num > pHeader->capacity)
+      remap(num);
+}
+
+/*****************************************
+ * MAPPED LIST :: SYNC
+ * Write dirty pages back to the file
+ ****************************************/
+template <typename T>
+void mapped_list <T> ::sync()
+{
+   if (::msync(pBase, mappedBytes, MS_SYNC) != 0)
+      throw "ERROR: unable to sync the mapped list file";
+}
+
+/*****************************************
+ * MAPPED LIST :: ALLOCATE NODE
+ * Take a slot off the free list, or the next unused
+ * slot, doubling the file when it is full
+ ****************************************/
+template <typename T>
+typename mapped_list <T> ::Offset mapped_list <T> ::allocateNode(const T & data)
+{
+   Offset offset = pHeader->freeList;
+   if (offset)
+      pHeader->freeList = node(offset)->next;
+   else
+   {
+      if (pHeader->numUsed == pHeader->capacity)
+         remap(pHeader->capacity ? (size_t)pHeader->capacity * 2 : 64);
+      offset = nodesOffset() + pHeader->numUsed++ * sizeof(Node);
+   }
+
+   Node * p = node(offset);
+   p->next = p->prev = 0;
+   new (&p->data) T(data);
+   return offset;
+}
+
+/*****************************************
+ * MAPPED LIST :: FREE NODE
+ * Put a slot on the free list for reuse
+ ****************************************/
+template <typename T>
+void mapped_list <T> ::freeNode(Offset offset)
+{
+   node(offset)->next = pHeader->freeList;
+   pHeader->freeList = offset;
+}
+
+/*****************************************
+ * MAPPED LIST :: BEGIN and END
+ ****************************************/
+template <typename T>
+typename mapped_list <T> ::iterator mapped_list <T> ::begin()
+{
+   return iterator(this, pHeader->head);
+}
+
+template <typename T>
+typename mapped_list <T> ::iterator mapped_list <T> ::end()
+{
+   return iterator(this, 0);
+}
+
+/*****************************************
+ * MAPPED LIST :: FRONT and BACK
+ ****************************************/
+template <typename T>
+T & mapped_list <T> ::front()
+{
+   if (pHeader->head == 0)
+      throw "ERROR: unable to access data from an empty list";
+   return node(pHeader->head)->data;
+}
+
+template <typename T>
+T & mapped_list <T> ::back()
+{
+   if (pHeader->tail == 0)
+      throw "ERROR: unable to access data from an empty list";
+   return node(pHeader->tail)->data;
+}
+
+/*****************************************
+ * MAPPED LIST :: PUSH FRONT and PUSH BACK
+ ****************************************/
+template <typename T>
+void mapped_list <T> ::push_front(const T & data)
+{
+   insert(begin(), data);
+}
+
+template <typename T>
+void mapped_list <T> ::push_back(const T & data)
+{
+   insert(end(), data);
+}
+
+/*****************************************
+ * MAPPED LIST :: INSERT
+ * Add an item before it
+ *     COST : O(1), amortized over growing the file
+ ****************************************/
+template <typename T>
+typename mapped_list <T> ::iterator mapped_list <T> ::insert(iterator it,
+                                                             const T & data)
+{
+   // allocating may remap, so only take addresses afterwards
+   Offset offsetNew = allocateNode(data);
+   Node * pNew = node(offsetNew);
+
+   Offset offsetPrev = it.offset ? node(it.offset)->prev : pHeader->tail;
+   pNew->next = it.offset;
+   pNew->prev = offsetPrev;
+
+   if (offsetPrev)
+      node(offsetPrev)->next = offsetNew;
+   else
+      pHeader->head = offsetNew;
+
+   if (it.offset)
+      node(it.offset)->prev = offsetNew;
+   else
+      pHeader->tail = offsetNew;
+
+   pHeader->numElements++;
+   return iterator(this, offsetNew);
+}
+
+/*****************************************
+ * MAPPED LIST :: ERASE
+ * Unlink the item at it and recycle its slot
+ *     COST : O(1)
+ ****************************************/
+template <typename T>
+typename mapped_list <T> ::iterator mapped_list <T> ::erase(const iterator & it)
+{
+   if (it.offset == 0)
+      return end();
+
+   Node * p = node(it.offset);
+   Offset offsetNext = p->next;
+
+   if (p->prev)
+      node(p->prev)->next = p->next;
+   else
+      pHeader->head = p->next;
+
+   if (p->next)
+      node(p->next)->prev = p->prev;
+   else
+      pHeader->tail = p->prev;
+
+   freeNode(it.offset);
+   pHeader->numElements--;
+   return iterator(this, offsetNext);
+}
+
+/*****************************************
+ * MAPPED LIST :: POP FRONT and POP BACK
+ ****************************************/
+template <typename T>
+void mapped_list <T> ::pop_front()
+{
+   if (!empty())
+      erase(begin());
+}
+
+template <typename T>
+void mapped_list <T> ::pop_back()
+{
+   if (!empty())
+      erase(iterator(this, pHeader->tail));
+}
+
+/*****************************************
+ * MAPPED LIST :: CLEAR
+ * Hand the whole chain to the free list at once.
+ * The file keeps its size for later pushes
+ *     COST : O(1)
+ ****************************************/
+template <typename T>
+void mapped_list <T> ::clear()
+{
+   if (pHeader->head)
+   {
+      node(pHeader->tail)->next = pHeader->freeList;
+      pHeader->freeList = pHeader->head;
+   }
+   pHeader->head = pHeader->tail = 0;
+   pHeader->numElements = 0;
+}
+
+} // namespace custom
+
+#endif // _WIN32
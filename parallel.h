@@ -0,0 +1,177 @@
+/***********************************************************************
+ * Header:
+ *    PARALLEL
+ * Summary:
+ *    Run a function over every item of a list on several threads.
+ *    A list iterator can only step one node at a time, so
+ *    std::execution::par cannot divide the work efficiently. Instead,
+ *    one cheap pass over the links finds where each thread's share
+ *    starts. Each thread then walks and processes only its own
+ *    contiguous run of nodes.
+ *
+ *    This will contain the definitions of:
+ *        parallel_for_each : call f on every item
+ *        parallel_reduce   : combine every item with op, in list order
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>     // for size_t
+#include <exception>   // for std::exception_ptr
+#include <system_error> // for std::system_error
+#include <thread>      // for std::thread
+#include <vector>      // for std::vector
+#include "list.h"      // for list
+
+namespace custom
+{
+
+/**************************************************
+ * SPLIT POINTS
+ * Walk the list once and return numParts + 1
+ * iterators. Part i runs from splits[i] up to
+ * splits[i + 1]. The parts differ in size by at
+ * most one item
+ **************************************************/
+template <typename T, typename A, typename S>
+std::vector<typename list <T, A, S> ::iterator> splitPoints(list <T, A, S> & l, size_t numParts)
+{
+   std::vector<typename list <T, A, S> ::iterator> splits;
+   splits.reserve(numParts + 1);
+
+   size_t perPart  = l.size() / numParts;
+   size_t leftOver = l.size() % numParts;
+   typename list <T, A, S> ::iterator it = l.begin();
+   splits.push_back(it);
+   for (size_t part = 0; part < numParts; part++)
+   {
+      size_t num = perPart + (part < leftOver ? 1 : 0);
+      for (size_t i = 0; i < num; i++)
+         ++it;
+      splits.push_back(it);
+   }
+   return splits;
+}
+
+/**************************************************
+ * NUM PARTS
+ * How many threads to use: never more than there
+ * are items, and at least one
+ **************************************************/
+inline size_t numParts(size_t numItems, unsigned int numThreads)
+{
+   size_t num = numThreads ? numThreads : 1;
+   if (num > numItems)
+      num = numItems ? numItems : 1;
+   return num;
+}
+
+/**************************************************
+ * RUN PARTS
+ * Call work(part) for every part, part 0 on the
+ * calling thread and the rest on their own threads.
+ * If no more threads can be started, the parts
+ * left over run on the calling thread too. The
+ * first exception thrown by any part is rethrown
+ * once every thread has finished
+ **************************************************/
+template <typename Work>
+void runParts(size_t numParts, Work work)
+{
+   std::vector<std::exception_ptr> errors(numParts);
+   std::vector<std::thread> threads;
+   threads.reserve(numParts - 1);
+
+   auto runPart = [&](size_t part)
+   {
+      try
+      {
+         work(part);
+      }
+      catch (...)
+      {
+         errors[part] = std::current_exception();
+      }
+   };
+
+   size_t numStarted = 1;   // part 0 is the calling thread's
+   try
+   {
+      for (; numStarted < numParts; numStarted++)
+         threads.emplace_back(runPart, numStarted);
+   }
+   catch (const std::system_error &)
+   {
+      // out of threads: the threads already started still have to be joined
+   }
+
+   runPart(0);
+   for (size_t part = numStarted; part < numParts; part++)
+      runPart(part);
+
+   for (std::thread & t : threads)
+      t.join();
+   for (std::exception_ptr & error : errors)
+      if (error)
+         std::rethrow_exception(error);
+}
+
+/**************************************************
+ * PARALLEL FOR EACH
+ * Call f(item) for every item, splitting the list
+ * into numThreads contiguous runs. f must be safe
+ * to call on different items at the same time
+ *     COST : O(n) to split plus O(n / numThreads) per thread
+ **************************************************/
+template <typename T, typename A, typename S, typename F>
+void parallel_for_each(list <T, A, S> & l, F f,
+                       unsigned int numThreads = std::thread::hardware_concurrency())
+{
+   if (l.empty())
+      return;
+
+   size_t num = numParts(l.size(), numThreads);
+   std::vector<typename list <T, A, S> ::iterator> splits = splitPoints(l, num);
+
+   runParts(num, [&](size_t part)
+   {
+      for (typename list <T, A, S> ::iterator it = splits[part]; it != splits[part + 1]; ++it)
+         f(*it);
+   });
+}
+
+/**************************************************
+ * PARALLEL REDUCE
+ * Fold every item into init with op. Each thread
+ * folds its own run, then the partial results are
+ * combined in list order, so op must be associative
+ * but need not be commutative
+ *     COST : O(n) to split plus O(n / numThreads) per thread
+ **************************************************/
+template <typename T, typename A, typename S, typename U, typename Op>
+U parallel_reduce(list <T, A, S> & l, U init, Op op,
+                  unsigned int numThreads = std::thread::hardware_concurrency())
+{
+   if (l.empty())
+      return init;
+
+   size_t num = numParts(l.size(), numThreads);
+   std::vector<typename list <T, A, S> ::iterator> splits = splitPoints(l, num);
+
+   // each part starts from its own first item, so op needs no identity
+   std::vector<U> partials(num, init);
+   runParts(num, [&](size_t part)
+   {
+      typename list <T, A, S> ::iterator it = splits[part];
+      U partial = *it;
+      for (++it; it != splits[part + 1]; ++it)
+         partial = op(partial, *it);
+      partials[part] = partial;
+   });
+
+   for (size_t part = 0; part < num; part++)
+      init = op(init, partials[part]);
+   return init;
+}
+
+} // namespace custom
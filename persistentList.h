@@ -0,0 +1,432 @@
+/***********************************************************************
+ * Header:
+ *    PERSISTENT LIST
+ * Summary:
+ *    An immutable singly linked list. Nothing ever changes a node once
+ *    it is linked; push_front, pop_front, insert and erase each return
+ *    a new version of the list instead, and that version shares every
+ *    node it did not have to change with the old one:
+ *
+ *       v1          : a -> b -> c
+ *       v2 = v1.push_front(x) : x -> a -> b -> c     (shares a, b, c)
+ *       v3 = v1.pop_front()   :      b -> c          (shares b, c)
+ *       v4 = v1.insert(c, y)  : a'-> b'-> y -> c     (copies a, b; shares c)
+ *
+ *    Taking a snapshot is therefore copying a handle, O(1), and the
+ *    snapshot stays exactly as it was however the list moves on.
+ *
+ *    Each node counts the handles and nodes that point to it, and is
+ *    freed with the last of them. The counts are atomic, so versions
+ *    that share nodes may be read, copied and dropped on different
+ *    threads at once. One persistent_list object is not safe to assign
+ *    on one thread while another thread uses it.
+ *
+ *    This will contain the class definition of:
+ *        persistent_list                 : One version of an immutable list
+ *        persistent_list::const_iterator : A forward iterator through it
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>             // for std::atomic
+#include <cstddef>            // for size_t and std::ptrdiff_t
+#include <initializer_list>   // for std::initializer_list
+#include <iterator>           // for std::forward_iterator_tag
+#include <memory>             // for std::allocator and std::allocator_traits
+#include <utility>            // for std::move and std::swap
+
+namespace custom
+{
+
+/**************************************************
+ * PERSISTENT LIST
+ * A handle to one version of an immutable list
+ **************************************************/
+template <typename T, typename A = std::allocator<T>>
+class persistent_list
+{
+public:
+   class const_iterator;
+
+   //
+   // Construct
+   //
+
+   persistent_list() : pHead(nullptr), numElements(0), alloc() { }
+   explicit persistent_list(const A & a) : pHead(nullptr), numElements(0), alloc(a) { }
+   persistent_list(const persistent_list & rhs) :
+      pHead(hold(rhs.pHead)), numElements(rhs.numElements), alloc(rhs.alloc) { }
+   persistent_list(persistent_list && rhs) noexcept :
+      pHead(rhs.pHead), numElements(rhs.numElements), alloc(rhs.alloc)
+   {
+      rhs.pHead = nullptr;
+      rhs.numElements = 0;
+   }
+   persistent_list(const std::initializer_list<T> & il, const A & a = A()) :
+      persistent_list(il.begin(), il.end(), a) { }
+   template <class Iterator>
+   persistent_list(Iterator first, Iterator last, const A & a = A());
+   ~persistent_list() { release(pHead); }
+
+   //
+   // Assign. Only the handle changes; no node ever does
+   //
+
+   persistent_list & operator = (const persistent_list & rhs);
+   persistent_list & operator = (persistent_list && rhs) noexcept;
+
+   //
+   // Iterator
+   //
+
+   const_iterator begin()  const { return const_iterator(pHead);   }
+   const_iterator end()    const { return const_iterator(nullptr); }
+   const_iterator cbegin() const { return begin(); }
+   const_iterator cend()   const { return end();   }
+
+   //
+   // Access
+   //
+
+   const T & front() const;
+
+   //
+   // New versions. This one is left exactly as it was
+   //
+
+   persistent_list push_front(const T &  data) const;
+   persistent_list push_front(      T && data) const;
+   persistent_list pop_front() const;
+   persistent_list insert(const_iterator it, const T & data) const;
+   persistent_list erase(const_iterator it) const;
+
+   //
+   // Status
+   //
+
+   bool   empty() const { return pHead == nullptr; }
+   size_t size()  const { return numElements;      }
+   void   swap(persistent_list & rhs) noexcept;
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // one immutable item and the number of pointers to it
+   struct Node
+   {
+      template <class ... Args>
+      Node(Args && ... args) : refs(1), pNext(nullptr), data(std::forward<Args>(args)...) { }
+      std::atomic<size_t> refs;
+      Node *              pNext;   // set once, while the node is still private
+      const T             data;
+   };
+
+   typedef typename std::allocator_traits<A>::template rebind_alloc<Node> NodeAlloc;
+   typedef std::allocator_traits<NodeAlloc> NodeTraits;
+
+   template <class ... Args>
+   Node * newNode(Args && ... args) const;
+   static Node * hold(Node * p);
+   void release(Node * p);
+   Node ** copyBefore(const Node * pStop, persistent_list & next) const;
+
+   Node *    pHead;         // first node, shared with other versions
+   size_t    numElements;   // how many nodes this version reaches
+   NodeAlloc alloc;         // nodes are allocated and freed through this
+};
+
+/**************************************************
+ * PERSISTENT LIST CONST ITERATOR
+ * Walks forward through one version
+ *************************************************/
+template <typename T, typename A>
+class persistent_list <T, A> ::const_iterator
+{
+   friend class persistent_list <T, A>;
+public:
+   typedef std::forward_iterator_tag iterator_category;
+   typedef T                         value_type;
+   typedef std::ptrdiff_t            difference_type;
+   typedef const T *                 pointer;
+   typedef const T &                 reference;
+
+   const_iterator() : p(nullptr) { }
+   explicit const_iterator(const Node * p) : p(p) { }
+
+   bool operator != (const const_iterator & rhs) const { return p != rhs.p; }
+   bool operator == (const const_iterator & rhs) const { return p == rhs.p; }
+
+   const T & operator *  () const { return  p->data; }
+   const T * operator -> () const { return &p->data; }
+
+   const_iterator & operator ++ ()
+   {
+      p = p->pNext;
+      return *this;
+   }
+   const_iterator operator ++ (int postfix)
+   {
+      const_iterator itOld(*this);
+      p = p->pNext;
+      return itOld;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   const Node * p;
+};
+
+/*****************************************
+ * PERSISTENT LIST :: RANGE CONSTRUCTOR
+ * The nodes are private until the constructor
+ * returns, so they are linked front to back
+ *     COST : O(n)
+ ****************************************/
+template <typename T, typename A>
+template <class Iterator>
+persistent_list <T, A> ::persistent_list(Iterator first, Iterator last, const A & a) :
+   pHead(nullptr), numElements(0), alloc(a)
+{
+   Node ** ppEnd = &pHead;
+   try
+   {
+      for (; first != last; ++first)
+      {
+         *ppEnd = newNode(*first);
+         ppEnd = &(*ppEnd)->pNext;
+         numElements++;
+      }
+   }
+   catch (...)
+   {
+      // no destructor runs for a constructor that throws
+      release(pHead);
+      throw;
+   }
+}
+
+/*****************************************
+ * PERSISTENT LIST :: ASSIGN
+ * Point this handle at the right hand side's
+ * version, letting go of this one
+ *     COST : O(1), plus freeing whatever only
+ *            this handle still reached
+ ****************************************/
+template <typename T, typename A>
+persistent_list <T, A> & persistent_list <T, A> ::operator = (const persistent_list & rhs)
+{
+   persistent_list copy(rhs);
+   swap(copy);
+   return *this;
+}
+
+template <typename T, typename A>
+persistent_list <T, A> & persistent_list <T, A> ::operator = (persistent_list && rhs) noexcept
+{
+   persistent_list moved(std::move(rhs));
+   swap(moved);
+   return *this;
+}
+
+/*****************************************
+ * PERSISTENT LIST :: FRONT
+ ****************************************/
+template <typename T, typename A>
+const T & persistent_list <T, A> ::front() const
+{
+   if (empty())
+      throw "ERROR: unable to access data from an empty list";
+   return pHead->data;
+}
+
+/*****************************************
+ * PERSISTENT LIST :: PUSH FRONT
+ * A new version with data in front of all of
+ * this one, which it shares
+ *     COST : O(1)
+ ****************************************/
+template <typename T, typename A>
+persistent_list <T, A> persistent_list <T, A> ::push_front(const T & data) const
+{
+   persistent_list next(alloc);
+   next.pHead = newNode(data);
+   next.pHead->pNext = hold(pHead);
+   next.numElements = numElements + 1;
+   return next;
+}
+
+template <typename T, typename A>
+persistent_list <T, A> persistent_list <T, A> ::push_front(T && data) const
+{
+   persistent_list next(alloc);
+   next.pHead = newNode(std::move(data));
+   next.pHead->pNext = hold(pHead);
+   next.numElements = numElements + 1;
+   return next;
+}
+
+/*****************************************
+ * PERSISTENT LIST :: POP FRONT
+ * A new version that starts at this one's second
+ * node
+ *     COST : O(1)
+ ****************************************/
+template <typename T, typename A>
+persistent_list <T, A> persistent_list <T, A> ::pop_front() const
+{
+   if (empty())
+      throw "ERROR: unable to remove from an empty list";
+
+   persistent_list next(alloc);
+   next.pHead = hold(pHead->pNext);
+   next.numElements = numElements - 1;
+   return next;
+}
+
+/*****************************************
+ * PERSISTENT LIST :: INSERT
+ * A new version with data just before it. The
+ * nodes in front of it are copied, since one of
+ * them must point somewhere new; it and everything
+ * after it are shared
+ *     INPUT  : an iterator into this version, and the item
+ *     COST   : O(k), k being the nodes in front of it
+ ****************************************/
+template <typename T, typename A>
+persistent_list <T, A> persistent_list <T, A> ::insert(const_iterator it, const T & data) const
+{
+   persistent_list next(alloc);
+   Node ** ppEnd = copyBefore(it.p, next);
+   *ppEnd = newNode(data);
+   (*ppEnd)->pNext = hold(const_cast<Node *>(it.p));
+   next.numElements = numElements + 1;
+   return next;
+}
+
+/*****************************************
+ * PERSISTENT LIST :: ERASE
+ * A new version without the item at it. The
+ * nodes in front of it are copied; everything
+ * after it is shared
+ *     INPUT  : an iterator into this version, not end()
+ *     COST   : O(k), k being the nodes in front of it
+ ****************************************/
+template <typename T, typename A>
+persistent_list <T, A> persistent_list <T, A> ::erase(const_iterator it) const
+{
+   if (it.p == nullptr)
+      throw "ERROR: unable to erase the end of a list";
+
+   persistent_list next(alloc);
+   Node ** ppEnd = copyBefore(it.p, next);
+   *ppEnd = hold(it.p->pNext);
+   next.numElements = numElements - 1;
+   return next;
+}
+
+/*****************************************
+ * PERSISTENT LIST :: SWAP
+ ****************************************/
+template <typename T, typename A>
+void persistent_list <T, A> ::swap(persistent_list & rhs) noexcept
+{
+   std::swap(pHead, rhs.pHead);
+   std::swap(numElements, rhs.numElements);
+   std::swap(alloc, rhs.alloc);
+}
+
+/*****************************************
+ * PERSISTENT LIST :: NEW NODE
+ * Build a node through the allocator, holding
+ * one reference: the one the caller is about to
+ * store
+ *     COST : O(1)
+ ****************************************/
+template <typename T, typename A>
+template <class ... Args>
+typename persistent_list <T, A> ::Node * persistent_list <T, A> ::newNode(Args && ... args) const
+{
+   NodeAlloc nodeAlloc(alloc);
+   Node * pNew = NodeTraits::allocate(nodeAlloc, 1);
+   try
+   {
+      NodeTraits::construct(nodeAlloc, pNew, std::forward<Args>(args)...);
+   }
+   catch (...)
+   {
+      NodeTraits::deallocate(nodeAlloc, pNew, 1);
+      throw;
+   }
+   return pNew;
+}
+
+/*****************************************
+ * PERSISTENT LIST :: HOLD and RELEASE
+ * Count one more or one fewer pointer to a node.
+ * Freeing a node lets go of the next one too, so
+ * release walks down the chain, stopping at the
+ * first node something else still points to
+ *     COST : O(1), O(n) to free an unshared chain
+ ****************************************/
+template <typename T, typename A>
+typename persistent_list <T, A> ::Node * persistent_list <T, A> ::hold(Node * p)
+{
+   if (p)
+      p->refs.fetch_add(1, std::memory_order_relaxed);
+   return p;
+}
+
+template <typename T, typename A>
+void persistent_list <T, A> ::release(Node * p)
+{
+   // a loop, not recursion: a chain of millions must not blow the stack
+   while (p && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+   {
+      Node * pNext = p->pNext;
+      NodeTraits::destroy(alloc, p);
+      NodeTraits::deallocate(alloc, p, 1);
+      p = pNext;
+   }
+}
+
+/*****************************************
+ * PERSISTENT LIST :: COPY BEFORE
+ * Fill an empty version with copies of this one's
+ * nodes up to pStop. Should a copy throw, the
+ * partial version frees itself
+ *     INPUT  : the node to stop at, NULL for all of them,
+ *              and the empty version to fill
+ *     OUTPUT : the last copy's empty link, for the caller to fill in
+ *     COST   : O(k), k being the nodes copied
+ ****************************************/
+template <typename T, typename A>
+typename persistent_list <T, A> ::Node ** persistent_list <T, A> ::copyBefore(const Node * pStop,
+                                                                        persistent_list & next) const
+{
+   Node ** ppEnd = &next.pHead;
+   for (const Node * p = pHead; p != pStop; p = p->pNext)
+   {
+      if (p == nullptr)
+         throw "ERROR: iterator is not part of this list";
+      *ppEnd = newNode(p->data);
+      ppEnd = &(*ppEnd)->pNext;
+   }
+   return ppEnd;
+}
+
+/*****************************************
+ * SWAP
+ * Swap two handles
+ ****************************************/
+template <typename T, typename A>
+inline void swap(persistent_list <T, A> & lhs, persistent_list <T, A> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
@@ -0,0 +1,581 @@
+/***********************************************************************
+ * Header:
+ *    RCU LIST
+ * Summary:
+ *    A singly linked list for data that is read all the time and
+ *    changed rarely. Readers walk it with no lock and no read-modify-
+ *    write: every step is an acquire load of a link, which on x86 and
+ *    ARMv8 compiles to an ordinary load. Nothing a reader does writes
+ *    to memory another core is reading, so readers never bounce a cache
+ *    line between them.
+ *
+ *    Writers take a mutex, build whatever is new off to the side, and
+ *    publish it with one release store. A node a writer unlinks stays
+ *    intact, so a reader standing on it walks on unharmed; it is
+ *    retired, and freed only after a grace period: once every reader
+ *    has passed a quiescent state since it was unlinked.
+ *
+ *    Grace periods are tracked by quiescent state reporting. Each
+ *    reader thread registers an rcu_list::reader and calls quiescent()
+ *    whenever it holds no iterators or references into the list, for
+ *    instance between two requests. A reader about to block calls
+ *    offline() first, so it does not hold up writers, and online() once
+ *    it is back. A reader that never reports holds back reclamation,
+ *    and a writer that asks for a grace period waits for it.
+ *
+ *    A thread may both read and write. Its own online reader would
+ *    never report while it waits, so a writer that finds the calling
+ *    thread online leaves the nodes it retires for a later grace
+ *    period instead of waiting for one. Only synchronize() insists,
+ *    and must be called with the caller's reader offline. No lock is
+ *    held while a grace period is waited out, so readers on other
+ *    threads keep writing, and reach their quiescent states, meanwhile.
+ *
+ *    This will contain the class definition of:
+ *        rcu_list                 : A list with lock-free readers
+ *        rcu_list::reader         : One reader thread's quiescent state
+ *        rcu_list::const_iterator : A forward iterator for readers
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>             // for std::atomic
+#include <cassert>            // for assert
+#include <cstddef>            // for size_t and std::ptrdiff_t
+#include <cstdint>            // for std::uint64_t
+#include <iterator>           // for std::forward_iterator_tag
+#include <memory>             // for std::allocator and std::allocator_traits
+#include <mutex>              // for std::mutex
+#include <thread>             // for std::this_thread::yield and get_id
+
+namespace custom
+{
+
+/**************************************************
+ * RCU LIST
+ * Readers walk without locks; writers copy, publish
+ * and retire
+ **************************************************/
+template <typename T, typename A = std::allocator<T>>
+class rcu_list
+{
+public:
+   class reader;
+   class const_iterator;
+
+   // retired nodes a writer lets pile up before it waits out a grace period
+   static constexpr size_t RETIRE_BATCH = 64;
+
+   //
+   // Construct. A list is shared in place, never copied
+   //
+
+   rcu_list() : pHead(nullptr), numElements(0), pTail(nullptr), pRetired(nullptr),
+                numRetired(0), epoch(1), alloc(), pReaders(nullptr) { }
+   explicit rcu_list(const A & a) : pHead(nullptr), numElements(0), pTail(nullptr),
+                pRetired(nullptr), numRetired(0), epoch(1), alloc(a), pReaders(nullptr) { }
+   rcu_list(const rcu_list &) = delete;
+   rcu_list & operator = (const rcu_list &) = delete;
+   ~rcu_list();
+
+   //
+   // Read. Safe from any thread whose reader is online
+   //
+
+   const_iterator begin()  const { return const_iterator(pHead.load(std::memory_order_acquire)); }
+   const_iterator end()    const { return const_iterator(nullptr); }
+   const_iterator cbegin() const { return begin(); }
+   const_iterator cend()   const { return end();   }
+   bool   empty() const { return pHead.load(std::memory_order_acquire) == nullptr; }
+   size_t size()  const { return numElements.load(std::memory_order_relaxed); }
+
+   //
+   // Write. Writers take turns; readers are never stopped. Called from
+   // a thread whose reader is online, they retire nodes but leave
+   // freeing them to a later writer or synchronize()
+   //
+
+   void push_front(const T & data);
+   void push_back (const T & data);
+   size_t remove(const T & value);
+   template <class Predicate>
+   size_t remove_if(Predicate pred);
+   template <class Predicate>
+   size_t replace_if(Predicate pred, const T & data);
+   void clear();
+
+   // wait until every reader has been quiescent, then free the retired
+   // nodes. The calling thread's reader, if it has one, must be offline
+   void synchronize();
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // one item; the link is all a reader ever loads
+   struct Node
+   {
+      template <class ... Args>
+      Node(Args && ... args) : data(std::forward<Args>(args)...), pNext(nullptr),
+                               pRetired(nullptr) { }
+      const T             data;
+      std::atomic<Node *> pNext;
+      Node *              pRetired;   // next node waiting for a grace period
+   };
+
+   // one reader thread's last quiescent epoch, on a cache line of its own
+   static constexpr std::uint64_t OFFLINE = ~std::uint64_t(0);
+   struct alignas(64) Slot
+   {
+      std::atomic<std::uint64_t> seen;
+      std::thread::id            owner;   // the thread reading through it
+      Slot *                     pNext;   // next registered reader
+   };
+
+   typedef typename std::allocator_traits<A>::template rebind_alloc<Node> NodeAlloc;
+   typedef std::allocator_traits<NodeAlloc> NodeTraits;
+
+   Node * newNode(const T & data);
+   void   deleteNode(Node * p);
+   void   retire(Node * p);
+   void   waitForReaders();
+   bool   callerOnline() const;
+   void   enroll(Slot * pSlot);
+   void   withdraw(Slot * pSlot);
+
+   // read by everyone
+   std::atomic<Node *>        pHead;
+   std::atomic<size_t>        numElements;
+
+   // touched only by the writer holding lockWrite
+   std::mutex                 lockWrite;
+   Node *                     pTail;
+   Node *                     pRetired;      // unlinked, not yet freed
+   size_t                     numRetired;
+   std::atomic<std::uint64_t> epoch;         // bumped at the start of every grace period
+   NodeAlloc                  alloc;
+
+   // the registered readers. Never held while waiting, so a reader
+   // can always enroll, withdraw or write while a grace period runs
+   mutable std::mutex         lockReaders;
+   Slot *                     pReaders;
+};
+
+/**************************************************
+ * RCU LIST READER
+ * Registers the calling thread as a reader for as
+ * long as it lives. Make one per thread, on that
+ * thread's stack
+ *************************************************/
+template <typename T, typename A>
+class rcu_list <T, A> ::reader
+{
+public:
+   explicit reader(rcu_list & l) : l(l)
+   {
+      slot.seen.store(OFFLINE, std::memory_order_relaxed);
+      slot.owner = std::this_thread::get_id();
+      l.enroll(&slot);
+      online();
+   }
+   ~reader()
+   {
+      // offline first, so a writer waiting on this slot does not wait for withdraw
+      offline();
+      l.withdraw(&slot);
+   }
+   reader(const reader &) = delete;
+   reader & operator = (const reader &) = delete;
+
+   // this thread holds nothing it found in the list before now
+   void quiescent()
+   {
+      slot.seen.store(l.epoch.load(std::memory_order_acquire), std::memory_order_release);
+   }
+
+   // this thread will not read the list until online()
+   void offline()
+   {
+      slot.seen.store(OFFLINE, std::memory_order_release);
+   }
+
+   // this thread is about to read the list again
+   void online()
+   {
+      // the fence keeps the reads that follow from being seen before the store
+      slot.seen.store(l.epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   rcu_list & l;
+   Slot       slot;
+};
+
+/**************************************************
+ * RCU LIST CONST ITERATOR
+ * Walks forward with acquire loads only
+ *************************************************/
+template <typename T, typename A>
+class rcu_list <T, A> ::const_iterator
+{
+public:
+   typedef std::forward_iterator_tag iterator_category;
+   typedef T                         value_type;
+   typedef std::ptrdiff_t            difference_type;
+   typedef const T *                 pointer;
+   typedef const T &                 reference;
+
+   const_iterator() : p(nullptr) { }
+   explicit const_iterator(const Node * p) : p(p) { }
+
+   bool operator != (const const_iterator & rhs) const { return p != rhs.p; }
+   bool operator == (const const_iterator & rhs) const { return p == rhs.p; }
+
+   const T & operator *  () const { return  p->data; }
+   const T * operator -> () const { return &p->data; }
+
+   const_iterator & operator ++ ()
+   {
+      p = p->pNext.load(std::memory_order_acquire);
+      return *this;
+   }
+   const_iterator operator ++ (int postfix)
+   {
+      const_iterator itOld(*this);
+      ++(*this);
+      return itOld;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   const Node * p;
+};
+
+/*****************************************
+ * RCU LIST :: DESTRUCTOR
+ * No reader may still be registered, so every
+ * node can go at once
+ ****************************************/
+template <typename T, typename A>
+rcu_list <T, A> ::~rcu_list()
+{
+   assert(pReaders == nullptr);
+   for (Node * p = pRetired; p; )
+   {
+      Node * pNext = p->pRetired;
+      deleteNode(p);
+      p = pNext;
+   }
+   for (Node * p = pHead.load(std::memory_order_relaxed); p; )
+   {
+      Node * pNext = p->pNext.load(std::memory_order_relaxed);
+      deleteNode(p);
+      p = pNext;
+   }
+}
+
+/*****************************************
+ * RCU LIST :: PUSH FRONT and PUSH BACK
+ * The new node is complete before the store that
+ * lets readers reach it
+ *     COST : O(1)
+ ****************************************/
+template <typename T, typename A>
+void rcu_list <T, A> ::push_front(const T & data)
+{
+   std::lock_guard<std::mutex> guard(lockWrite);
+   Node * pNew = newNode(data);
+   Node * pOld = pHead.load(std::memory_order_relaxed);
+   pNew->pNext.store(pOld, std::memory_order_relaxed);
+   pHead.store(pNew, std::memory_order_release);
+   if (pTail == nullptr)
+      pTail = pNew;
+   numElements.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T, typename A>
+void rcu_list <T, A> ::push_back(const T & data)
+{
+   std::lock_guard<std::mutex> guard(lockWrite);
+   Node * pNew = newNode(data);
+   (pTail ? pTail->pNext : pHead).store(pNew, std::memory_order_release);
+   pTail = pNew;
+   numElements.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*****************************************
+ * RCU LIST :: REMOVE and REMOVE IF
+ * Unlink every match and retire it. A reader on a
+ * match still finds its link to the rest
+ *     OUTPUT : the number of items removed
+ *     COST   : O(n), plus a grace period every
+ *              RETIRE_BATCH removals unless the
+ *              caller's reader is online
+ ****************************************/
+template <typename T, typename A>
+size_t rcu_list <T, A> ::remove(const T & value)
+{
+   return remove_if([&value](const T & t) { return t == value; });
+}
+
+template <typename T, typename A>
+template <class Predicate>
+size_t rcu_list <T, A> ::remove_if(Predicate pred)
+{
+   size_t numRemoved = 0;
+   bool full;
+   {
+      std::lock_guard<std::mutex> guard(lockWrite);
+      Node * pPrev = nullptr;
+      Node * p = pHead.load(std::memory_order_relaxed);
+      while (p)
+      {
+         Node * pNext = p->pNext.load(std::memory_order_relaxed);
+         if (pred(p->data))
+         {
+            (pPrev ? pPrev->pNext : pHead).store(pNext, std::memory_order_release);
+            if (pTail == p)
+               pTail = pPrev;
+            retire(p);
+            numRemoved++;
+         }
+         else
+            pPrev = p;
+         p = pNext;
+      }
+      numElements.fetch_sub(numRemoved, std::memory_order_relaxed);
+      full = numRetired >= RETIRE_BATCH && !callerOnline();
+   }
+   if (full)
+      synchronize();
+   return numRemoved;
+}
+
+/*****************************************
+ * RCU LIST :: REPLACE IF
+ * Swap each match for a new node holding data.
+ * A reader sees the old item or the new one, never
+ * a half-written mix of the two
+ *     OUTPUT : the number of items replaced
+ *     COST   : O(n), plus a grace period every
+ *              RETIRE_BATCH replacements unless
+ *              the caller's reader is online
+ ****************************************/
+template <typename T, typename A>
+template <class Predicate>
+size_t rcu_list <T, A> ::replace_if(Predicate pred, const T & data)
+{
+   size_t numReplaced = 0;
+   bool full;
+   {
+      std::lock_guard<std::mutex> guard(lockWrite);
+      Node * pPrev = nullptr;
+      for (Node * p = pHead.load(std::memory_order_relaxed); p; )
+      {
+         Node * pNext = p->pNext.load(std::memory_order_relaxed);
+         if (pred(p->data))
+         {
+            Node * pNew = newNode(data);
+            pNew->pNext.store(pNext, std::memory_order_relaxed);
+            (pPrev ? pPrev->pNext : pHead).store(pNew, std::memory_order_release);
+            if (pTail == p)
+               pTail = pNew;
+            retire(p);
+            numReplaced++;
+            p = pNew;
+         }
+         pPrev = p;
+         p = pNext;
+      }
+      full = numRetired >= RETIRE_BATCH && !callerOnline();
+   }
+   if (full)
+      synchronize();
+   return numReplaced;
+}
+
+/*****************************************
+ * RCU LIST :: CLEAR
+ * Unlink the whole chain with one store and retire
+ * every node of it
+ *     COST : O(n) to retire, plus a grace period
+ *            unless the caller's reader is online
+ ****************************************/
+template <typename T, typename A>
+void rcu_list <T, A> ::clear()
+{
+   bool any;
+   {
+      std::lock_guard<std::mutex> guard(lockWrite);
+      Node * p = pHead.load(std::memory_order_relaxed);
+      pHead.store(nullptr, std::memory_order_release);
+      pTail = nullptr;
+      numElements.store(0, std::memory_order_relaxed);
+      while (p)
+      {
+         Node * pNext = p->pNext.load(std::memory_order_relaxed);
+         retire(p);
+         p = pNext;
+      }
+      any = numRetired > 0 && !callerOnline();
+   }
+   if (any)
+      synchronize();
+}
+
+/*****************************************
+ * RCU LIST :: SYNCHRONIZE
+ * Wait out one grace period and free whatever was
+ * retired before it started. The calling thread's
+ * own reader, if it has one, must be offline.
+ * lockWrite is let go during the wait: an online
+ * reader may be writing, and must get through to
+ * its next quiescent state
+ *     COST : as long as the slowest reader takes to
+ *            report a quiescent state
+ ****************************************/
+template <typename T, typename A>
+void rcu_list <T, A> ::synchronize()
+{
+   assert(!callerOnline());   // would wait on itself forever
+   Node * p;
+   {
+      std::lock_guard<std::mutex> guard(lockWrite);
+      p = pRetired;
+      pRetired = nullptr;
+      numRetired = 0;
+   }
+   if (p == nullptr)
+      return;
+
+   waitForReaders();
+
+   std::lock_guard<std::mutex> guard(lockWrite);
+   while (p)
+   {
+      Node * pNext = p->pRetired;
+      deleteNode(p);
+      p = pNext;
+   }
+}
+
+/*****************************************
+ * RCU LIST :: WAIT FOR READERS
+ * Start a new epoch, then wait until every online
+ * reader has been quiescent in it. Anything a
+ * reader found before then, it has let go of. A
+ * reader that has caught up stays caught up, so the
+ * registry is walked afresh, under its lock, after
+ * every yield instead of being held throughout
+ ****************************************/
+template <typename T, typename A>
+void rcu_list <T, A> ::waitForReaders()
+{
+   std::uint64_t target = epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+   for (;;)
+   {
+      bool behind = false;
+      {
+         std::lock_guard<std::mutex> guard(lockReaders);
+         for (Slot * pSlot = pReaders; pSlot && !behind; pSlot = pSlot->pNext)
+         {
+            std::uint64_t seen = pSlot->seen.load(std::memory_order_seq_cst);
+            behind = seen != OFFLINE && seen < target;
+         }
+      }
+      if (!behind)
+         return;
+      std::this_thread::yield();
+   }
+}
+
+/*****************************************
+ * RCU LIST :: CALLER ONLINE
+ * Whether the calling thread has a reader that is
+ * online, and so cannot wait out a grace period
+ ****************************************/
+template <typename T, typename A>
+bool rcu_list <T, A> ::callerOnline() const
+{
+   std::thread::id self = std::this_thread::get_id();
+   std::lock_guard<std::mutex> guard(lockReaders);
+   for (const Slot * pSlot = pReaders; pSlot; pSlot = pSlot->pNext)
+      if (pSlot->owner == self && pSlot->seen.load(std::memory_order_relaxed) != OFFLINE)
+         return true;
+   return false;
+}
+
+/*****************************************
+ * RCU LIST :: ENROLL and WITHDRAW
+ * Add or drop a reader from those a grace period
+ * waits for
+ ****************************************/
+template <typename T, typename A>
+void rcu_list <T, A> ::enroll(Slot * pSlot)
+{
+   std::lock_guard<std::mutex> guard(lockReaders);
+   pSlot->pNext = pReaders;
+   pReaders = pSlot;
+}
+
+template <typename T, typename A>
+void rcu_list <T, A> ::withdraw(Slot * pSlot)
+{
+   std::lock_guard<std::mutex> guard(lockReaders);
+   for (Slot ** ppSlot = &pReaders; *ppSlot; ppSlot = &(*ppSlot)->pNext)
+      if (*ppSlot == pSlot)
+      {
+         *ppSlot = pSlot->pNext;
+         break;
+      }
+}
+
+/*****************************************
+ * RCU LIST :: RETIRE
+ * Set an unlinked node aside until a grace period
+ * has passed. Its own link is left alone
+ ****************************************/
+template <typename T, typename A>
+void rcu_list <T, A> ::retire(Node * p)
+{
+   p->pRetired = pRetired;
+   pRetired = p;
+   numRetired++;
+}
+
+/*****************************************
+ * RCU LIST :: NEW NODE and DELETE NODE
+ ****************************************/
+template <typename T, typename A>
+typename rcu_list <T, A> ::Node * rcu_list <T, A> ::newNode(const T & data)
+{
+   Node * pNew = NodeTraits::allocate(alloc, 1);
+   try
+   {
+      NodeTraits::construct(alloc, pNew, data);
+   }
+   catch (...)
+   {
+      NodeTraits::deallocate(alloc, pNew, 1);
+      throw;
+   }
+   return pNew;
+}
+
+template <typename T, typename A>
+void rcu_list <T, A> ::deleteNode(Node * p)
+{
+   NodeTraits::destroy(alloc, p);
+   NodeTraits::deallocate(alloc, p, 1);
+}
+
+} // namespace custom
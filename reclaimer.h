@@ -0,0 +1,194 @@
+/***********************************************************************
+ * Header:
+ *    RECLAIMER
+ * Summary:
+ *    A background thread that frees chains of nodes. Destroying a
+ *    list of tens of millions of nodes takes hundreds of milliseconds,
+ *    all of it spent walking the chain and calling the allocator. A
+ *    list in background clear mode instead cuts its chain loose in
+ *    O(1) and posts it here, and this thread frees it.
+ *
+ *    The thread frees BATCH nodes at a time and lets go of its lock in
+ *    between, so a post never waits behind a long chain. Chains are
+ *    freed in the order they were posted.
+ *
+ *    The reclaimer is started on first use and never destroyed, so a
+ *    list may still post to it while static objects are being torn
+ *    down. Chains still queued when the program exits are not freed.
+ *
+ *    This will contain the class definition of:
+ *        reclaimer        : The queue of chains and the thread that frees them
+ *        reclaimer::Job   : One chain waiting to be freed
+ *        reclaimer::Stats : What is queued and what has been freed
+ ************************************************************************/
+
+#pragma once
+
+#include <condition_variable>  // for std::condition_variable
+#include <cstddef>             // for size_t
+#include <mutex>               // for std::mutex
+#include <thread>              // for std::thread
+
+namespace custom
+{
+
+/**************************************************
+ * RECLAIMER
+ * Frees posted chains of nodes on its own thread
+ **************************************************/
+class reclaimer
+{
+public:
+   // chains shorter than this are not worth handing to another thread
+   static constexpr size_t INLINE_BELOW = 1024;
+
+   // nodes freed between looks at the queue
+   static constexpr size_t BATCH = 4096;
+
+   // one chain of nodes, freed a batch at a time
+   class Job
+   {
+   public:
+      Job(size_t numNodes) : numNodes(numNodes), pNext(nullptr) { }
+      virtual ~Job() { }
+
+      // free up to num nodes and return how many were freed
+      virtual size_t reclaim(size_t num) = 0;
+
+   private:
+      friend class reclaimer;
+      size_t numNodes;   // left to free
+      Job *  pNext;      // next chain in the queue
+   };
+
+   // a snapshot of the queue
+   struct Stats
+   {
+      size_t numJobs;      // chains ever posted
+      size_t numQueued;    // chains posted but not yet completely freed
+      size_t numPending;   // nodes posted but not yet freed
+      size_t maxPending;   // the most numPending has ever been
+      size_t numFreed;     // nodes freed so far
+   };
+
+   // the one reclaimer every list posts to
+   static reclaimer & global()
+   {
+      static reclaimer * pReclaimer = new reclaimer;
+      return *pReclaimer;
+   }
+
+   void  post(Job * pJob);
+   void  wait_reclaimed();
+   Stats stats() const;
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   reclaimer();
+   reclaimer(const reclaimer &) = delete;
+   reclaimer & operator = (const reclaimer &) = delete;
+   void work();
+
+   mutable std::mutex      lock;    // guards everything below
+   std::condition_variable wake;    // a job was posted
+   std::condition_variable idle;    // the queue ran dry
+   Job *                   pHead;   // oldest chain not yet started
+   Job *                   pTail;   // newest chain
+   Stats                   counts;
+};
+
+/*****************************************
+ * RECLAIMER :: CONSTRUCTOR
+ * Start the thread. It runs for the rest of the
+ * program, so nothing waits to join it
+ ****************************************/
+inline reclaimer::reclaimer() : pHead(nullptr), pTail(nullptr), counts()
+{
+   std::thread(&reclaimer::work, this).detach();
+}
+
+/*****************************************
+ * RECLAIMER :: POST
+ * Queue a chain to be freed. The reclaimer owns
+ * pJob from now on and deletes it when done
+ *     COST : O(1)
+ ****************************************/
+inline void reclaimer::post(Job * pJob)
+{
+   {
+      std::lock_guard<std::mutex> guard(lock);
+      pJob->pNext = nullptr;
+      (pTail ? pTail->pNext : pHead) = pJob;
+      pTail = pJob;
+
+      counts.numJobs++;
+      counts.numQueued++;
+      counts.numPending += pJob->numNodes;
+      if (counts.numPending > counts.maxPending)
+         counts.maxPending = counts.numPending;
+   }
+   wake.notify_one();
+}
+
+/*****************************************
+ * RECLAIMER :: WAIT RECLAIMED
+ * Block until every chain posted so far is freed
+ ****************************************/
+inline void reclaimer::wait_reclaimed()
+{
+   std::unique_lock<std::mutex> guard(lock);
+   idle.wait(guard, [this]() { return counts.numQueued == 0; });
+}
+
+/*****************************************
+ * RECLAIMER :: STATS
+ ****************************************/
+inline reclaimer::Stats reclaimer::stats() const
+{
+   std::lock_guard<std::mutex> guard(lock);
+   return counts;
+}
+
+/*****************************************
+ * RECLAIMER :: WORK
+ * Take the oldest chain and free it a batch at a
+ * time, updating the counts after each batch
+ ****************************************/
+inline void reclaimer::work()
+{
+   std::unique_lock<std::mutex> guard(lock);
+   for (;;)
+   {
+      wake.wait(guard, [this]() { return pHead != nullptr; });
+      Job * pJob = pHead;
+      pHead = pJob->pNext;
+      if (pHead == nullptr)
+         pTail = nullptr;
+
+      while (pJob->numNodes > 0)
+      {
+         guard.unlock();
+         size_t numFreed = pJob->reclaim(BATCH);
+         guard.lock();
+
+         // a job that cannot free any more is finished regardless
+         if (numFreed == 0 || numFreed > pJob->numNodes)
+            numFreed = pJob->numNodes;
+         pJob->numNodes     -= numFreed;
+         counts.numPending  -= numFreed;
+         counts.numFreed    += numFreed;
+      }
+
+      guard.unlock();
+      delete pJob;
+      guard.lock();
+
+      if (--counts.numQueued == 0)
+         idle.notify_all();
+   }
+}
+
+} // namespace custom
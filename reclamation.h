@@ -0,0 +1,565 @@
+/***********************************************************************
+ * Header:
+ *    RECLAMATION
+ * Summary:
+ *    Safe memory reclamation for lock-free containers. A thread that
+ *    unlinks a node from a lock-free list, queue or free list cannot
+ *    simply delete it: another thread may have loaded a pointer to it
+ *    a moment earlier and be about to read it. Instead the node is
+ *    retired, and a domain frees it once no thread can still reach it.
+ *
+ *    Two domains are offered, with the same interface, so a container
+ *    takes the domain as a template parameter:
+ *
+ *       hazard_domain : each thread publishes the few pointers it is
+ *                       about to read (hazard pointers). A retired node
+ *                       is freed once no hazard pointer names it. A
+ *                       stalled thread can pin only the nodes it has
+ *                       published, so memory waiting to be freed stays
+ *                       bounded. Every protected load costs a store and
+ *                       a full fence.
+ *       epoch_domain  : each thread announces the global epoch while it
+ *                       works. A node retired in epoch e is freed once
+ *                       the epoch reaches e + 2, since by then no thread
+ *                       can still be working from before it was retired.
+ *                       Loads cost nothing extra, but one stalled thread
+ *                       holds back every retired node until it moves on.
+ *
+ *    A container uses either domain the same way. Each operation opens
+ *    a guard, loads shared pointers through guard.protect(), and hands
+ *    unlinked nodes to guard.retire():
+ *
+ *       typename Domain::guard g(domain);
+ *       Node * p = g.protect(0, pHead);
+ *       ...
+ *       g.retire(p);
+ *
+ *    Each domain keeps one record per thread taking part, found again
+ *    in O(1) the next time the same thread opens a guard. Records are
+ *    reused but never freed before the domain, so a domain should live
+ *    at least as long as every container that uses it; global() returns
+ *    one that is never destroyed.
+ *
+ *    This will contain the class definition of:
+ *        retired_ptr          : A node waiting to be freed, and how to free it
+ *        record_list          : The per-thread records of one domain
+ *        hazard_domain        : Reclamation by hazard pointers
+ *        hazard_domain::guard : One thread's hazard pointers for one operation
+ *        epoch_domain         : Reclamation by epochs
+ *        epoch_domain::guard  : One thread's stay in the current epoch
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>   // for std::sort and std::binary_search
+#include <atomic>      // for std::atomic
+#include <cstddef>     // for size_t
+#include <cstdint>     // for std::uint64_t
+#include <vector>      // for std::vector
+
+namespace custom
+{
+
+/**************************************************
+ * RETIRED PTR
+ * An unlinked object and the function that frees it
+ **************************************************/
+struct retired_ptr
+{
+   void * p;
+   void (*deleter)(void *);
+   void reclaim() const { deleter(p); }
+};
+
+// the deleter for an object made with new
+template <typename T>
+void deleteAs(void * p)
+{
+   delete static_cast<T *>(p);
+}
+
+/**************************************************
+ * RECORD LIST
+ * The records of one domain, one per thread taking
+ * part. Records are only ever added, so walking them
+ * needs no lock; a thread claims a free one for as
+ * long as it has a guard open
+ **************************************************/
+template <typename Record>
+class record_list
+{
+public:
+   record_list() : pHead(nullptr), numRecords(0), id(nextId()) { }
+   record_list(const record_list &) = delete;
+   record_list & operator = (const record_list &) = delete;
+   ~record_list();
+
+   Record * acquire();
+   void     release(Record * p) { p->active.store(false, std::memory_order_release); }
+   Record * first() const { return pHead.load(std::memory_order_acquire); }
+   size_t   size()  const { return numRecords.load(std::memory_order_relaxed); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // the record this thread used last, and whose list it belongs to
+   struct Hint
+   {
+      std::uint64_t id;
+      Record *      p;
+   };
+
+   // ids are never reused, so a hint cannot outlive its list unnoticed
+   static std::uint64_t nextId()
+   {
+      static std::atomic<std::uint64_t> next(1);
+      return next.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   std::atomic<Record *> pHead;
+   std::atomic<size_t>   numRecords;
+   const std::uint64_t   id;
+};
+
+/*****************************************
+ * RECORD LIST :: DESTRUCTOR
+ * No thread may hold a record any more
+ ****************************************/
+template <typename Record>
+record_list <Record> ::~record_list()
+{
+   Record * p = pHead.load(std::memory_order_acquire);
+   while (p)
+   {
+      Record * pNext = p->pNext;
+      delete p;
+      p = pNext;
+   }
+}
+
+/*****************************************
+ * RECORD LIST :: ACQUIRE
+ * Claim the record this thread used last if it is
+ * still free, else any free record, else a new one
+ *     COST : O(1) for a thread that came before,
+ *            O(records) the first time
+ ****************************************/
+template <typename Record>
+Record * record_list <Record> ::acquire()
+{
+   thread_local Hint hint = { 0, nullptr };
+   if (hint.id == id && !hint.p->active.exchange(true, std::memory_order_acquire))
+      return hint.p;
+
+   for (Record * p = first(); p; p = p->pNext)
+      if (!p->active.load(std::memory_order_relaxed) &&
+          !p->active.exchange(true, std::memory_order_acquire))
+      {
+         hint.id = id;
+         hint.p = p;
+         return p;
+      }
+
+   Record * pNew = new Record;
+   pNew->active.store(true, std::memory_order_relaxed);
+   Record * pOld = pHead.load(std::memory_order_relaxed);
+   do
+      pNew->pNext = pOld;
+   while (!pHead.compare_exchange_weak(pOld, pNew, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+   numRecords.fetch_add(1, std::memory_order_relaxed);
+   hint.id = id;
+   hint.p = pNew;
+   return pNew;
+}
+
+/**************************************************
+ * HAZARD DOMAIN
+ * Frees a retired object once no thread has it
+ * published in a hazard pointer
+ **************************************************/
+class hazard_domain
+{
+public:
+   class guard;
+
+   // hazard pointers each guard may publish at once
+   static constexpr size_t SLOTS = 2;
+
+   // a thread scans once it has retired this many, or twice the hazard
+   // pointers in use if that is more, so a scan frees at least half
+   static constexpr size_t SCAN_AT_LEAST = 64;
+
+   hazard_domain() : numFreed(0) { }
+   hazard_domain(const hazard_domain &) = delete;
+   hazard_domain & operator = (const hazard_domain &) = delete;
+   ~hazard_domain();
+
+   // a domain for everyone, never destroyed
+   static hazard_domain & global()
+   {
+      static hazard_domain * pDomain = new hazard_domain;
+      return *pDomain;
+   }
+
+   size_t num_pending() const;
+   size_t num_freed()   const { return numFreed.load(std::memory_order_relaxed); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // one thread's hazard pointers and the objects it has retired
+   struct Record
+   {
+      Record() : active(false), numRetired(0), pNext(nullptr)
+      {
+         for (size_t i = 0; i < SLOTS; i++)
+            hazards[i].store(nullptr, std::memory_order_relaxed);
+      }
+      std::atomic<bool>        active;
+      std::atomic<void *>      hazards[SLOTS];
+      std::vector<retired_ptr> retired;      // touched only by the owner
+      std::atomic<size_t>      numRetired;   // retired.size(), for anyone to read
+      Record *                 pNext;
+   };
+
+   void scan(Record & r);
+
+   record_list<Record> records;
+   std::atomic<size_t> numFreed;
+};
+
+/**************************************************
+ * HAZARD DOMAIN GUARD
+ * The calling thread's hazard pointers for as long
+ * as the guard lives. Make one per operation
+ **************************************************/
+class hazard_domain::guard
+{
+public:
+   explicit guard(hazard_domain & domain = hazard_domain::global()) :
+      domain(domain), pRecord(domain.records.acquire()) { }
+   ~guard()
+   {
+      for (size_t i = 0; i < SLOTS; i++)
+         pRecord->hazards[i].store(nullptr, std::memory_order_release);
+      domain.records.release(pRecord);
+   }
+   guard(const guard &) = delete;
+   guard & operator = (const guard &) = delete;
+
+   // load src and publish it in slot i, until the two agree
+   template <typename T>
+   T * protect(size_t i, const std::atomic<T *> & src)
+   {
+      T * p = src.load(std::memory_order_relaxed);
+      for (;;)
+      {
+         pRecord->hazards[i].store(p, std::memory_order_seq_cst);
+         T * pAgain = src.load(std::memory_order_seq_cst);
+         if (pAgain == p)
+            return p;
+         p = pAgain;
+      }
+   }
+
+   // slot i no longer protects anything
+   void clear(size_t i)
+   {
+      pRecord->hazards[i].store(nullptr, std::memory_order_release);
+   }
+
+   // p is unlinked; free it once no hazard pointer names it
+   template <typename T>
+   void retire(T * p, void (*deleter)(void *) = &deleteAs<T>)
+   {
+      pRecord->retired.push_back(retired_ptr{ p, deleter });
+      pRecord->numRetired.store(pRecord->retired.size(), std::memory_order_relaxed);
+      size_t threshold = 2 * SLOTS * domain.records.size();
+      if (threshold < SCAN_AT_LEAST)
+         threshold = SCAN_AT_LEAST;
+      if (pRecord->retired.size() >= threshold)
+         domain.scan(*pRecord);
+   }
+
+   // free whatever this thread has retired that is not protected
+   void scan() { domain.scan(*pRecord); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   hazard_domain & domain;
+   Record *        pRecord;
+};
+
+/*****************************************
+ * HAZARD DOMAIN :: DESTRUCTOR
+ * No guard may be open, so nothing is protected
+ ****************************************/
+inline hazard_domain::~hazard_domain()
+{
+   for (Record * p = records.first(); p; p = p->pNext)
+      for (const retired_ptr & r : p->retired)
+         r.reclaim();
+}
+
+/*****************************************
+ * HAZARD DOMAIN :: SCAN
+ * Gather every published hazard pointer, then free
+ * each of r's retired objects that is not among them
+ *     COST : O(R log H) for R retired and H hazards
+ ****************************************/
+inline void hazard_domain::scan(Record & r)
+{
+   std::vector<void *> hazards;
+   hazards.reserve(records.size() * SLOTS);
+   for (Record * p = records.first(); p; p = p->pNext)
+      for (size_t i = 0; i < SLOTS; i++)
+      {
+         void * h = p->hazards[i].load(std::memory_order_seq_cst);
+         if (h)
+            hazards.push_back(h);
+      }
+   std::sort(hazards.begin(), hazards.end());
+
+   size_t numKept = 0;
+   for (size_t i = 0; i < r.retired.size(); i++)
+      if (std::binary_search(hazards.begin(), hazards.end(), r.retired[i].p))
+         r.retired[numKept++] = r.retired[i];
+      else
+         r.retired[i].reclaim();
+
+   numFreed.fetch_add(r.retired.size() - numKept, std::memory_order_relaxed);
+   r.retired.resize(numKept);
+   r.numRetired.store(numKept, std::memory_order_relaxed);
+}
+
+/*****************************************
+ * HAZARD DOMAIN :: NUM PENDING
+ * Objects retired but not yet freed, summed over
+ * the threads as each one stands
+ ****************************************/
+inline size_t hazard_domain::num_pending() const
+{
+   size_t num = 0;
+   for (Record * p = records.first(); p; p = p->pNext)
+      num += p->numRetired.load(std::memory_order_relaxed);
+   return num;
+}
+
+/**************************************************
+ * EPOCH DOMAIN
+ * Frees an object retired in epoch e once the
+ * global epoch reaches e + 2
+ **************************************************/
+class epoch_domain
+{
+public:
+   class guard;
+
+   // retirements between a thread's attempts to move the epoch on
+   static constexpr size_t ADVANCE_EVERY = 64;
+
+   epoch_domain() : epoch(0), numFreed(0) { }
+   epoch_domain(const epoch_domain &) = delete;
+   epoch_domain & operator = (const epoch_domain &) = delete;
+   ~epoch_domain();
+
+   // a domain for everyone, never destroyed
+   static epoch_domain & global()
+   {
+      static epoch_domain * pDomain = new epoch_domain;
+      return *pDomain;
+   }
+
+   size_t        num_pending()   const;
+   size_t        num_freed()     const { return numFreed.load(std::memory_order_relaxed); }
+   std::uint64_t current_epoch() const { return epoch.load(std::memory_order_relaxed); }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // objects retired in one epoch
+   struct Bag
+   {
+      Bag() : epoch(0) { }
+      std::uint64_t            epoch;
+      std::vector<retired_ptr> items;
+   };
+
+   // one thread's announced epoch and its three most recent bags
+   struct Record
+   {
+      Record() : active(false), pinned(0), sinceAdvance(0), numRetired(0), pNext(nullptr) { }
+      std::atomic<bool>          active;
+      std::atomic<std::uint64_t> pinned;       // (epoch << 1) | 1 while a guard is open
+      Bag                        bags[3];      // indexed by epoch % 3
+      size_t                     sinceAdvance;
+      std::atomic<size_t>        numRetired;   // in all three bags, for anyone to read
+      Record *                   pNext;
+   };
+
+   bool   tryAdvance();
+   void   collect(Record & r);
+   size_t freeBag(Bag & bag);
+
+   record_list<Record>        records;
+   std::atomic<std::uint64_t> epoch;
+   std::atomic<size_t>        numFreed;
+};
+
+/**************************************************
+ * EPOCH DOMAIN GUARD
+ * Keeps the calling thread in the epoch it entered
+ * for as long as the guard lives. Make one per
+ * operation; a guard held for long holds every
+ * retired object back
+ **************************************************/
+class epoch_domain::guard
+{
+public:
+   explicit guard(epoch_domain & domain = epoch_domain::global()) :
+      domain(domain), pRecord(domain.records.acquire())
+   {
+      // the fence keeps the loads that follow from being seen before the pin
+      std::uint64_t e = domain.epoch.load(std::memory_order_relaxed);
+      pRecord->pinned.store((e << 1) | 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+   }
+   ~guard()
+   {
+      pRecord->pinned.store(0, std::memory_order_release);
+      domain.records.release(pRecord);
+   }
+   guard(const guard &) = delete;
+   guard & operator = (const guard &) = delete;
+
+   // nothing retired since the guard opened can be freed, so a load will do
+   template <typename T>
+   T * protect(size_t /*i*/, const std::atomic<T *> & src)
+   {
+      return src.load(std::memory_order_acquire);
+   }
+
+   void clear(size_t /*i*/) { }
+
+   // p is unlinked; free it two epochs from now
+   template <typename T>
+   void retire(T * p, void (*deleter)(void *) = &deleteAs<T>)
+   {
+      std::uint64_t e = domain.epoch.load(std::memory_order_acquire);
+      Bag & bag = pRecord->bags[e % 3];
+      if (bag.epoch != e)
+      {
+         // what is in it was retired three or more epochs ago
+         pRecord->numRetired.fetch_sub(domain.freeBag(bag), std::memory_order_relaxed);
+         bag.epoch = e;
+      }
+      bag.items.push_back(retired_ptr{ p, deleter });
+      pRecord->numRetired.fetch_add(1, std::memory_order_relaxed);
+
+      if (++pRecord->sinceAdvance >= ADVANCE_EVERY)
+      {
+         pRecord->sinceAdvance = 0;
+         domain.tryAdvance();
+         domain.collect(*pRecord);
+      }
+   }
+
+   // try to move the epoch on and free what this thread may
+   void scan()
+   {
+      domain.tryAdvance();
+      domain.collect(*pRecord);
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   epoch_domain & domain;
+   Record *       pRecord;
+};
+
+/*****************************************
+ * EPOCH DOMAIN :: DESTRUCTOR
+ * No guard may be open, so everything can go
+ ****************************************/
+inline epoch_domain::~epoch_domain()
+{
+   for (Record * p = records.first(); p; p = p->pNext)
+      for (Bag & bag : p->bags)
+         freeBag(bag);
+}
+
+/*****************************************
+ * EPOCH DOMAIN :: TRY ADVANCE
+ * Move the epoch on if every thread with a guard
+ * open has entered the current one
+ *     OUTPUT : whether the epoch is now past where it was
+ *     COST   : O(records)
+ ****************************************/
+inline bool epoch_domain::tryAdvance()
+{
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   std::uint64_t e = epoch.load(std::memory_order_seq_cst);
+   for (Record * p = records.first(); p; p = p->pNext)
+   {
+      std::uint64_t pinned = p->pinned.load(std::memory_order_seq_cst);
+      if ((pinned & 1) && (pinned >> 1) != e)
+         return false;
+   }
+   // losing the race means another thread moved it on, which is as good
+   epoch.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+   return true;
+}
+
+/*****************************************
+ * EPOCH DOMAIN :: COLLECT
+ * Free every bag of r's that is two epochs old
+ ****************************************/
+inline void epoch_domain::collect(Record & r)
+{
+   std::uint64_t e = epoch.load(std::memory_order_acquire);
+   for (Bag & bag : r.bags)
+      if (bag.epoch + 2 <= e)
+         r.numRetired.fetch_sub(freeBag(bag), std::memory_order_relaxed);
+}
+
+/*****************************************
+ * EPOCH DOMAIN :: FREE BAG
+ *     OUTPUT : how many objects were freed
+ ****************************************/
+inline size_t epoch_domain::freeBag(Bag & bag)
+{
+   size_t num = bag.items.size();
+   for (const retired_ptr & r : bag.items)
+      r.reclaim();
+   bag.items.clear();
+   numFreed.fetch_add(num, std::memory_order_relaxed);
+   return num;
+}
+
+/*****************************************
+ * EPOCH DOMAIN :: NUM PENDING
+ * Objects retired but not yet freed, summed over
+ * the threads as each one stands
+ ****************************************/
+inline size_t epoch_domain::num_pending() const
+{
+   size_t num = 0;
+   for (Record * p = records.first(); p; p = p->pNext)
+      num += p->numRetired.load(std::memory_order_relaxed);
+   return num;
+}
+
+} // namespace custom
@@ -0,0 +1,259 @@
+/***********************************************************************
+ * Header:
+ *    SHARDED LIST
+ * Summary:
+ *    A set of lists that many threads append to at once. Each thread
+ *    is dealt a shard the first time it pushes and keeps it, so with
+ *    at least as many shards as threads no two threads ever touch the
+ *    same lock or the same cache line. Each shard has a lock all the
+ *    same, since more threads than shards must share.
+ *
+ *    Items keep the order they were pushed in within a shard; across
+ *    shards there is no order. collect() splices every shard onto one
+ *    list in O(shards), copying nothing, and for_each() visits every
+ *    item without collecting.
+ *
+ *    This will contain the class definition of:
+ *        sharded_list : One list per shard, appended to without contention
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>             // for std::atomic
+#include <cstddef>            // for size_t
+#include <memory>             // for std::allocator and std::unique_ptr
+#include <mutex>              // for std::mutex
+#include <thread>             // for std::thread::hardware_concurrency
+#include "list.h"             // for list
+
+namespace custom
+{
+
+/**************************************************
+ * THREAD TICKET
+ * A number dealt to each thread the first time it
+ * asks, counting up from 0. Consecutive threads get
+ * consecutive shards, which spreads them more evenly
+ * than hashing their ids would
+ **************************************************/
+inline size_t threadTicket()
+{
+   static std::atomic<size_t> nextTicket(0);
+   thread_local size_t ticket = nextTicket.fetch_add(1, std::memory_order_relaxed);
+   return ticket;
+}
+
+/**************************************************
+ * SHARDED LIST
+ * Contention-free push_back across threads
+ **************************************************/
+template <typename T, typename A = std::allocator<T>>
+class sharded_list
+{
+public:
+   //
+   // Construct
+   //
+
+   explicit sharded_list(size_t numShards = defaultShards(), const A & a = A());
+   sharded_list(const sharded_list &) = delete;
+   sharded_list & operator = (const sharded_list &) = delete;
+   ~sharded_list();
+
+   //
+   // Insert. Safe from any number of threads at once
+   //
+
+   void push_back(const T &  data);
+   void push_back(      T && data);
+   void push_back(size_t shard, const T &  data);
+   void push_back(size_t shard,       T && data);
+
+   //
+   // Consume. Also safe while others push; each shard is
+   // taken or visited as it stands when its turn comes
+   //
+
+   list <T, A> collect();
+   template <class Function>
+   void for_each(Function f) const;
+   void clear();
+
+   //
+   // Status
+   //
+
+   size_t size()       const;
+   bool   empty()      const { return size() == 0; }
+   size_t num_shards() const { return numShards; }
+   size_t shard_of_this_thread() const { return threadTicket() % numShards; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   // one list and its lock, padded so neighbours never share a cache line
+   struct Shard
+   {
+      Shard(const A & a) : items(a) { }
+      mutable std::mutex lock;
+      list <T, A>        items;
+      char               pad[64];
+   };
+
+   static size_t defaultShards()
+   {
+      size_t num = std::thread::hardware_concurrency();
+      return num ? num : 1;
+   }
+
+   size_t                           numShards;
+   Shard *                          shards;    // numShards of them, built in storage
+   std::unique_ptr<unsigned char[]> storage;
+   A                                alloc;     // every shard and collected list has a copy
+};
+
+/*****************************************
+ * SHARDED LIST :: CONSTRUCTOR
+ * Every shard gets a copy of the same allocator,
+ * so collect() can relink their nodes freely
+ ****************************************/
+template <typename T, typename A>
+sharded_list <T, A> ::sharded_list(size_t numShards, const A & a) :
+   numShards(numShards), shards(nullptr), alloc(a)
+{
+   if (numShards == 0)
+      throw "ERROR: a sharded_list needs at least one shard";
+
+   storage.reset(new unsigned char[sizeof(Shard) * numShards]);
+   shards = reinterpret_cast<Shard *>(storage.get());
+   size_t i = 0;
+   try
+   {
+      for (; i < numShards; i++)
+         new (shards + i) Shard(alloc);
+   }
+   catch (...)
+   {
+      while (i-- > 0)
+         shards[i].~Shard();
+      throw;
+   }
+}
+
+/*****************************************
+ * SHARDED LIST :: DESTRUCTOR
+ ****************************************/
+template <typename T, typename A>
+sharded_list <T, A> ::~sharded_list()
+{
+   for (size_t i = 0; i < numShards; i++)
+      shards[i].~Shard();
+}
+
+/*****************************************
+ * SHARDED LIST :: PUSH BACK
+ * Append to this thread's shard, or to the one
+ * asked for
+ *     COST : O(1), uncontended unless threads
+ *            outnumber shards
+ ****************************************/
+template <typename T, typename A>
+void sharded_list <T, A> ::push_back(const T & data)
+{
+   push_back(shard_of_this_thread(), data);
+}
+
+template <typename T, typename A>
+void sharded_list <T, A> ::push_back(T && data)
+{
+   push_back(shard_of_this_thread(), std::move(data));
+}
+
+template <typename T, typename A>
+void sharded_list <T, A> ::push_back(size_t shard, const T & data)
+{
+   Shard & s = shards[shard % numShards];
+   std::lock_guard<std::mutex> guard(s.lock);
+   s.items.push_back(data);
+}
+
+template <typename T, typename A>
+void sharded_list <T, A> ::push_back(size_t shard, T && data)
+{
+   Shard & s = shards[shard % numShards];
+   std::lock_guard<std::mutex> guard(s.lock);
+   s.items.push_back(std::move(data));
+}
+
+/*****************************************
+ * SHARDED LIST :: COLLECT
+ * Splice every shard onto one list, shard 0 first,
+ * leaving the shards empty
+ *     OUTPUT : every item, in push order within a shard
+ *     COST   : O(shards)
+ ****************************************/
+template <typename T, typename A>
+list <T, A> sharded_list <T, A> ::collect()
+{
+   list <T, A> all(alloc);
+   for (size_t i = 0; i < numShards; i++)
+   {
+      std::lock_guard<std::mutex> guard(shards[i].lock);
+      all.splice(all.end(), shards[i].items);
+   }
+   return all;
+}
+
+/*****************************************
+ * SHARDED LIST :: FOR EACH
+ * Call f on every item, one shard at a time.
+ * Each shard is locked while it is visited, so f
+ * should not push
+ *     COST : O(n)
+ ****************************************/
+template <typename T, typename A>
+template <class Function>
+void sharded_list <T, A> ::for_each(Function f) const
+{
+   for (size_t i = 0; i < numShards; i++)
+   {
+      std::lock_guard<std::mutex> guard(shards[i].lock);
+      for (const T & t : shards[i].items)
+         f(t);
+   }
+}
+
+/*****************************************
+ * SHARDED LIST :: CLEAR
+ ****************************************/
+template <typename T, typename A>
+void sharded_list <T, A> ::clear()
+{
+   for (size_t i = 0; i < numShards; i++)
+   {
+      std::lock_guard<std::mutex> guard(shards[i].lock);
+      shards[i].items.clear();
+   }
+}
+
+/*****************************************
+ * SHARDED LIST :: SIZE
+ * The sum over the shards, each counted as it
+ * stands when its turn comes
+ *     COST : O(shards)
+ ****************************************/
+template <typename T, typename A>
+size_t sharded_list <T, A> ::size() const
+{
+   size_t num = 0;
+   for (size_t i = 0; i < numShards; i++)
+   {
+      std::lock_guard<std::mutex> guard(shards[i].lock);
+      num += shards[i].items.size();
+   }
+   return num;
+}
+
+} // namespace custom
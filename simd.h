@@ -0,0 +1,427 @@
+/***********************************************************************
+ * Header:
+ *    SIMD
+ * Summary:
+ *    Scan kernels over a contiguous block of elements: find, count,
+ *    min, max and accumulate. Arithmetic types that fit a vector lane
+ *    are scanned with AVX2 when the compiler targets it, SSE2 when it
+ *    does not, and a plain loop otherwise. Every other type goes
+ *    through the plain loop.
+ *
+ *    Define CUSTOM_SIMD_NONE to force the plain loops everywhere.
+ *
+ *    This will contain the definitions of:
+ *        simd::find       : index of the first element equal to a value
+ *        simd::count      : number of elements equal to a value
+ *        simd::min        : smallest of init and the elements
+ *        simd::max        : largest of init and the elements
+ *        simd::accumulate : init plus every element
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>       // for size_t
+#include <cstdint>       // for std::int32_t
+#include <type_traits>   // for std::is_integral
+
+#if !defined(CUSTOM_SIMD_NONE)
+#if defined(__AVX2__)
+#define CUSTOM_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CUSTOM_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#endif // !CUSTOM_SIMD_NONE
+
+namespace custom
+{
+namespace simd
+{
+
+/**************************************************
+ * SCALAR
+ * The plain loops. Used for any type the vector
+ * kernels do not cover, and for the leftover
+ * elements after the last full vector
+ **************************************************/
+namespace scalar
+{
+   template <typename T>
+   size_t find(const T * p, size_t n, const T & value)
+   {
+      for (size_t i = 0; i < n; i++)
+         if (p[i] == value)
+            return i;
+      return n;
+   }
+
+   template <typename T>
+   size_t count(const T * p, size_t n, const T & value)
+   {
+      size_t num = 0;
+      for (size_t i = 0; i < n; i++)
+         if (p[i] == value)
+            num++;
+      return num;
+   }
+
+   template <typename T>
+   T min(const T * p, size_t n, T init)
+   {
+      for (size_t i = 0; i < n; i++)
+         if (p[i] < init)
+            init = p[i];
+      return init;
+   }
+
+   template <typename T>
+   T max(const T * p, size_t n, T init)
+   {
+      for (size_t i = 0; i < n; i++)
+         if (init < p[i])
+            init = p[i];
+      return init;
+   }
+
+   template <typename T>
+   T accumulate(const T * p, size_t n, T init)
+   {
+      for (size_t i = 0; i < n; i++)
+         init = init + p[i];
+      return init;
+   }
+} // namespace scalar
+
+/**************************************************
+ * KERNELS
+ * Which implementation each type gets. The primary
+ * template is the scalar one; the specializations
+ * below replace the operations a vector unit does
+ * faster with identical results. Floating point
+ * min, max and accumulate stay scalar since
+ * reordering them changes NaN handling and rounding
+ **************************************************/
+enum kind { KIND_SCALAR, KIND_INT32, KIND_INT64, KIND_FLOAT, KIND_DOUBLE };
+
+template <typename T>
+struct kind_of
+{
+   static const kind value =
+      (std::is_integral<T>::value && sizeof(T) == 4) ? KIND_INT32  :
+      (std::is_integral<T>::value && sizeof(T) == 8) ? KIND_INT64  :
+      (std::is_same<T, float>::value)                ? KIND_FLOAT  :
+      (std::is_same<T, double>::value)               ? KIND_DOUBLE : KIND_SCALAR;
+};
+
+template <typename T, kind K = kind_of<T>::value>
+struct kernels
+{
+   static size_t find (const T * p, size_t n, const T & v) { return scalar::find (p, n, v); }
+   static size_t count(const T * p, size_t n, const T & v) { return scalar::count(p, n, v); }
+   static T min       (const T * p, size_t n, T init)      { return scalar::min       (p, n, init); }
+   static T max       (const T * p, size_t n, T init)      { return scalar::max       (p, n, init); }
+   static T accumulate(const T * p, size_t n, T init)      { return scalar::accumulate(p, n, init); }
+};
+
+#if defined(CUSTOM_SIMD_AVX2) || defined(CUSTOM_SIMD_SSE2)
+
+#ifdef CUSTOM_SIMD_AVX2
+   typedef __m256i vint;
+   typedef __m256  vfloat;
+   typedef __m256d vdouble;
+   inline vint    loadi(const void * p)  { return _mm256_loadu_si256(static_cast<const __m256i *>(p)); }
+   inline int     movemask8(vint v)      { return _mm256_movemask_epi8(v); }
+   inline vint    eq32(vint a, vint b)   { return _mm256_cmpeq_epi32(a, b); }
+   inline vint    eq64(vint a, vint b)   { return _mm256_cmpeq_epi64(a, b); }
+   inline vint    add32(vint a, vint b)  { return _mm256_add_epi32(a, b); }
+   inline vint    add64(vint a, vint b)  { return _mm256_add_epi64(a, b); }
+   inline vint    min32(vint a, vint b)  { return _mm256_min_epi32(a, b); }
+   inline vint    max32(vint a, vint b)  { return _mm256_max_epi32(a, b); }
+   inline vint    set32(std::int32_t v)  { return _mm256_set1_epi32(v); }
+   inline vint    set64(std::int64_t v)  { return _mm256_set1_epi64x(v); }
+   inline vint    zeroi()                { return _mm256_setzero_si256(); }
+   inline void    storei(void * p, vint v) { _mm256_storeu_si256(static_cast<__m256i *>(p), v); }
+   inline int     eqf(const float * p, float v)
+   {
+      return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_set1_ps(v), _CMP_EQ_OQ));
+   }
+   inline int     eqd(const double * p, double v)
+   {
+      return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p), _mm256_set1_pd(v), _CMP_EQ_OQ));
+   }
+#else
+   typedef __m128i vint;
+   inline vint    loadi(const void * p)  { return _mm_loadu_si128(static_cast<const __m128i *>(p)); }
+   inline int     movemask8(vint v)      { return _mm_movemask_epi8(v); }
+   inline vint    eq32(vint a, vint b)   { return _mm_cmpeq_epi32(a, b); }
+   inline vint    eq64(vint a, vint b)
+   {
+      // SSE2 has no 64 bit compare: both 32 bit halves must match
+      vint e = _mm_cmpeq_epi32(a, b);
+      return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+   }
+   inline vint    add32(vint a, vint b)  { return _mm_add_epi32(a, b); }
+   inline vint    add64(vint a, vint b)  { return _mm_add_epi64(a, b); }
+   inline vint    min32(vint a, vint b)
+   {
+      vint lt = _mm_cmplt_epi32(a, b);
+      return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+   }
+   inline vint    max32(vint a, vint b)
+   {
+      vint gt = _mm_cmpgt_epi32(a, b);
+      return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+   }
+   inline vint    set32(std::int32_t v)  { return _mm_set1_epi32(v); }
+   inline vint    set64(std::int64_t v)  { return _mm_set1_epi64x(v); }
+   inline vint    zeroi()                { return _mm_setzero_si128(); }
+   inline void    storei(void * p, vint v) { _mm_storeu_si128(static_cast<__m128i *>(p), v); }
+   inline int     eqf(const float * p, float v)
+   {
+      return _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p), _mm_set1_ps(v)));
+   }
+   inline int     eqd(const double * p, double v)
+   {
+      return _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(p), _mm_set1_pd(v)));
+   }
+#endif
+
+   // how many elements of a given size fit in a vector
+   template <typename T>
+   struct lanes { static const size_t value = sizeof(vint) / sizeof(T); };
+
+   // index of the lowest set lane in a byte mask of a vector compare
+   inline size_t firstLane(unsigned mask, size_t bytesPerLane)
+   {
+      size_t byte = 0;
+      while (!(mask & 1u))
+      {
+         mask >>= 1;
+         byte++;
+      }
+      return byte / bytesPerLane;
+   }
+
+   // number of set lanes in a byte mask of a vector compare
+   inline size_t countLanes(unsigned mask, size_t bytesPerLane)
+   {
+      size_t bits = 0;
+      for (; mask; mask &= mask - 1)
+         bits++;
+      return bits / bytesPerLane;
+   }
+
+/**************************************************
+ * KERNELS : 32 bit integers
+ **************************************************/
+template <typename T>
+struct kernels <T, KIND_INT32>
+{
+   static const size_t L = lanes<T>::value;
+
+   static size_t find(const T * p, size_t n, const T & value)
+   {
+      const vint v = set32((std::int32_t)value);
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+      {
+         unsigned mask = (unsigned)movemask8(eq32(loadi(p + i), v));
+         if (mask)
+            return i + firstLane(mask, 4);
+      }
+      return i + scalar::find(p + i, n - i, value);
+   }
+
+   static size_t count(const T * p, size_t n, const T & value)
+   {
+      // each matching lane is -1, so subtracting the mask counts matches
+      const vint v = set32((std::int32_t)value);
+      vint total = zeroi();
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+         total = add32(total, eq32(loadi(p + i), v));
+
+      std::int32_t lanesOut[L];
+      storei(lanesOut, total);
+      size_t num = 0;
+      for (size_t l = 0; l < L; l++)
+         num += (size_t)(-(std::int64_t)lanesOut[l]);
+      return num + scalar::count(p + i, n - i, value);
+   }
+
+   static T min(const T * p, size_t n, T init)
+   {
+      if (!std::is_signed<T>::value || n < L)
+         return scalar::min(p, n, init);
+      vint best = loadi(p);
+      size_t i = L;
+      for (; i + L <= n; i += L)
+         best = min32(best, loadi(p + i));
+      T lanesOut[L];
+      storei(lanesOut, best);
+      return scalar::min(p + i, n - i, scalar::min(lanesOut, L, init));
+   }
+
+   static T max(const T * p, size_t n, T init)
+   {
+      if (!std::is_signed<T>::value || n < L)
+         return scalar::max(p, n, init);
+      vint best = loadi(p);
+      size_t i = L;
+      for (; i + L <= n; i += L)
+         best = max32(best, loadi(p + i));
+      T lanesOut[L];
+      storei(lanesOut, best);
+      return scalar::max(p + i, n - i, scalar::max(lanesOut, L, init));
+   }
+
+   static T accumulate(const T * p, size_t n, T init)
+   {
+      vint total = zeroi();
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+         total = add32(total, loadi(p + i));
+      T lanesOut[L];
+      storei(lanesOut, total);
+      return scalar::accumulate(p + i, n - i, scalar::accumulate(lanesOut, L, init));
+   }
+};
+
+/**************************************************
+ * KERNELS : 64 bit integers
+ **************************************************/
+template <typename T>
+struct kernels <T, KIND_INT64> : kernels <T, KIND_SCALAR>
+{
+   static const size_t L = lanes<T>::value;
+
+   static size_t find(const T * p, size_t n, const T & value)
+   {
+      const vint v = set64((std::int64_t)value);
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+      {
+         unsigned mask = (unsigned)movemask8(eq64(loadi(p + i), v));
+         if (mask)
+            return i + firstLane(mask, 8);
+      }
+      return i + scalar::find(p + i, n - i, value);
+   }
+
+   static size_t count(const T * p, size_t n, const T & value)
+   {
+      const vint v = set64((std::int64_t)value);
+      size_t num = 0;
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+         num += countLanes((unsigned)movemask8(eq64(loadi(p + i), v)), 8);
+      return num + scalar::count(p + i, n - i, value);
+   }
+
+   static T accumulate(const T * p, size_t n, T init)
+   {
+      vint total = zeroi();
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+         total = add64(total, loadi(p + i));
+      T lanesOut[L];
+      storei(lanesOut, total);
+      return scalar::accumulate(p + i, n - i, scalar::accumulate(lanesOut, L, init));
+   }
+};
+
+/**************************************************
+ * KERNELS : float and double equality
+ **************************************************/
+template <typename T>
+struct kernels <T, KIND_FLOAT> : kernels <T, KIND_SCALAR>
+{
+   static const size_t L = lanes<T>::value;
+
+   static size_t find(const T * p, size_t n, const T & value)
+   {
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+      {
+         unsigned mask = (unsigned)eqf(p + i, value);
+         if (mask)
+            return i + firstLane(mask, 1);
+      }
+      return i + scalar::find(p + i, n - i, value);
+   }
+
+   static size_t count(const T * p, size_t n, const T & value)
+   {
+      size_t num = 0;
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+         num += countLanes((unsigned)eqf(p + i, value), 1);
+      return num + scalar::count(p + i, n - i, value);
+   }
+};
+
+template <typename T>
+struct kernels <T, KIND_DOUBLE> : kernels <T, KIND_SCALAR>
+{
+   static const size_t L = lanes<T>::value;
+
+   static size_t find(const T * p, size_t n, const T & value)
+   {
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+      {
+         unsigned mask = (unsigned)eqd(p + i, value);
+         if (mask)
+            return i + firstLane(mask, 1);
+      }
+      return i + scalar::find(p + i, n - i, value);
+   }
+
+   static size_t count(const T * p, size_t n, const T & value)
+   {
+      size_t num = 0;
+      size_t i = 0;
+      for (; i + L <= n; i += L)
+         num += countLanes((unsigned)eqd(p + i, value), 1);
+      return num + scalar::count(p + i, n - i, value);
+   }
+};
+
+#endif // CUSTOM_SIMD_AVX2 || CUSTOM_SIMD_SSE2
+
+/**************************************************
+ * ENTRY POINTS
+ **************************************************/
+template <typename T>
+size_t find(const T * p, size_t n, const T & value)
+{
+   return kernels<T>::find(p, n, value);
+}
+
+template <typename T>
+size_t count(const T * p, size_t n, const T & value)
+{
+   return kernels<T>::count(p, n, value);
+}
+
+template <typename T>
+T min(const T * p, size_t n, T init)
+{
+   return kernels<T>::min(p, n, init);
+}
+
+template <typename T>
+T max(const T * p, size_t n, T init)
+{
+   return kernels<T>::max(p, n, init);
+}
+
+template <typename T>
+T accumulate(const T * p, size_t n, T init)
+{
+   return kernels<T>::accumulate(p, n, init);
+}
+
+} // namespace simd
+} // namespace custom
@@ -0,0 +1,672 @@
+/***********************************************************************
+ * Header:
+ *    STATIC LIST
+ * Summary:
+ *    A list with room for at most N items whose nodes live inside the
+ *    list object itself. Nothing is ever allocated: a node is a slot in
+ *    an array, linked to its neighbours by index, and erased slots go
+ *    on a free list for the next insert. That makes the list safe to
+ *    use on threads that may not call the allocator, and insert and
+ *    erase are O(1) with no hidden cost.
+ *
+ *    Slots are handed out in order the first time, so building an
+ *    empty list does not touch the array at all.
+ *
+ *    Inserting into a full list throws, just as list throws when the
+ *    allocator fails. Call full() first where throwing is not allowed.
+ *
+ *    This will contain the class definition of:
+ *        static_list                 : A list of at most N items
+ *        static_list::iterator       : An iterator through the list
+ *        static_list::const_iterator : A read-only iterator
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>            // for ASSERT
+#include <cstddef>            // for size_t
+#include <cstdint>            // for std::uint8_t and friends
+#include <initializer_list>   // for std::initializer_list
+#include <iterator>           // for std::reverse_iterator
+#include <new>                // for placement new
+#include <type_traits>        // for std::conditional
+#include <utility>            // for std::move and std::swap
+
+namespace custom
+{
+
+/**************************************************
+ * STATIC LIST
+ * A doubly linked list of at most N items, stored
+ * in an array inside the list
+ **************************************************/
+template <typename T, size_t N>
+class static_list
+{
+   static_assert(N > 0, "static_list needs room for at least one item");
+   static_assert(N < 0xFFFFFFFFu, "static_list links its nodes with 32-bit indices");
+public:
+
+   //
+   // Construct
+   //
+
+   static_list() : numElements(0), numUsed(0), iHead(NIL), iTail(NIL), iFree(NIL) { }
+   static_list(const static_list & rhs);
+   static_list(static_list && rhs);
+   static_list(size_t num, const T & t);
+   static_list(size_t num);
+   static_list(const std::initializer_list<T> & il);
+   template <class Iterator>
+   static_list(Iterator first, Iterator last);
+   ~static_list() { clear(); }
+
+   //
+   // Assign
+   //
+
+   static_list & operator = (const static_list & rhs);
+   static_list & operator = (static_list && rhs);
+   static_list & operator = (const std::initializer_list<T> & il);
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   class const_iterator;
+   typedef std::reverse_iterator<iterator>       reverse_iterator;
+   typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+   iterator       begin()        { return iterator(this, iHead);       }
+   iterator       end()          { return iterator(this, NIL);         }
+   const_iterator begin()  const { return const_iterator(this, iHead); }
+   const_iterator end()    const { return const_iterator(this, NIL);   }
+   const_iterator cbegin() const { return begin(); }
+   const_iterator cend()   const { return end();   }
+   reverse_iterator       rbegin()       { return reverse_iterator(end());         }
+   reverse_iterator       rend()         { return reverse_iterator(begin());       }
+   const_reverse_iterator rbegin() const { return const_reverse_iterator(end());   }
+   const_reverse_iterator rend()   const { return const_reverse_iterator(begin()); }
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T &  data) { insert(begin(), data);            }
+   void push_front(      T && data) { insert(begin(), std::move(data)); }
+   void push_back (const T &  data) { insert(end(),   data);            }
+   void push_back (      T && data) { insert(end(),   std::move(data)); }
+   iterator insert(iterator it, const T &  data);
+   iterator insert(iterator it,       T && data);
+
+   //
+   // Remove
+   //
+
+   void pop_back();
+   void pop_front();
+   void clear();
+   iterator erase(const iterator & it);
+   size_t remove(const T & value);
+   template <class Predicate>
+   size_t remove_if(Predicate pred);
+
+   //
+   // Reorder
+   //
+
+   void swap(static_list & rhs);
+   void reverse();
+
+   //
+   // Status
+   //
+
+   bool   empty()    const { return numElements == 0; }
+   bool   full()     const { return numElements == N; }
+   size_t size()     const { return numElements;      }
+   static constexpr size_t max_size() { return N; }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+
+   // the smallest unsigned type that can name every slot plus NIL
+   typedef typename std::conditional<(N < 0xFFu),   std::uint8_t,
+           typename std::conditional<(N < 0xFFFFu), std::uint16_t,
+                                                    std::uint32_t>::type>::type Index;
+
+   // the index that means "no node", like NULL does for a pointer
+   static constexpr Index NIL = static_cast<Index>(~Index(0));
+
+   // a slot in the array. data is only constructed while the slot is linked
+   struct Node
+   {
+      T       * data()       { return reinterpret_cast<T       *>(storage); }
+      const T * data() const { return reinterpret_cast<const T *>(storage); }
+
+      Index next;
+      Index prev;
+      alignas(T) unsigned char storage[sizeof(T)];
+   };
+
+   template <class U>
+   iterator linkBefore(iterator it, U && data);
+   Index    allocateNode();
+   void     freeNode(Index i);
+   template <class Iterator>
+   void     assignRange(Iterator first, Iterator last);
+
+   size_t numElements;  // linked nodes
+   Index  numUsed;      // slots that have ever been handed out
+   Index  iHead;        // first node, NIL if empty
+   Index  iTail;        // last node, NIL if empty
+   Index  iFree;        // erased slots, linked through next
+   Node   nodes[N];     // left uninitialized until handed out
+};
+
+/*************************************************
+ * STATIC LIST ITERATOR
+ * A list and the index of a slot in it
+ ************************************************/
+template <typename T, size_t N>
+class static_list <T, N> ::iterator
+{
+   friend class static_list <T, N>;
+public:
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef T *                             pointer;
+   typedef T &                             reference;
+
+   iterator() : pList(nullptr), i(NIL) { }
+   iterator(static_list * pList, Index i) : pList(pList), i(i) { }
+
+   bool operator != (const iterator & rhs) const { return i != rhs.i; }
+   bool operator == (const iterator & rhs) const { return i == rhs.i; }
+
+   T & operator *  () const { return *pList->nodes[i].data(); }
+   T * operator -> () const { return  pList->nodes[i].data(); }
+
+   iterator & operator ++ ()
+   {
+      i = pList->nodes[i].next;
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld(*this);
+      ++(*this);
+      return itOld;
+   }
+   iterator & operator -- ()
+   {
+      i = (i == NIL) ? pList->iTail : pList->nodes[i].prev;
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator itOld(*this);
+      --(*this);
+      return itOld;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   static_list * pList;
+   Index i;
+};
+
+/*************************************************
+ * STATIC LIST CONST ITERATOR
+ * Like iterator, but the items cannot be changed
+ ************************************************/
+template <typename T, size_t N>
+class static_list <T, N> ::const_iterator
+{
+   friend class static_list <T, N>;
+public:
+   typedef std::bidirectional_iterator_tag iterator_category;
+   typedef T                               value_type;
+   typedef std::ptrdiff_t                  difference_type;
+   typedef const T *                       pointer;
+   typedef const T &                       reference;
+
+   const_iterator() : pList(nullptr), i(NIL) { }
+   const_iterator(const static_list * pList, Index i) : pList(pList), i(i) { }
+   const_iterator(const iterator & rhs) : pList(rhs.pList), i(rhs.i) { }
+
+   bool operator != (const const_iterator & rhs) const { return i != rhs.i; }
+   bool operator == (const const_iterator & rhs) const { return i == rhs.i; }
+
+   const T & operator *  () const { return *pList->nodes[i].data(); }
+   const T * operator -> () const { return  pList->nodes[i].data(); }
+
+   const_iterator & operator ++ ()
+   {
+      i = pList->nodes[i].next;
+      return *this;
+   }
+   const_iterator operator ++ (int postfix)
+   {
+      const_iterator itOld(*this);
+      ++(*this);
+      return itOld;
+   }
+   const_iterator & operator -- ()
+   {
+      i = (i == NIL) ? pList->iTail : pList->nodes[i].prev;
+      return *this;
+   }
+   const_iterator operator -- (int postfix)
+   {
+      const_iterator itOld(*this);
+      --(*this);
+      return itOld;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   const static_list * pList;
+   Index i;
+};
+
+/*****************************************
+ * STATIC LIST :: CONSTRUCTORS
+ * Each one copies its items in one at a time.
+ * More than N items throws
+ *     COST : O(n)
+ ****************************************/
+template <typename T, size_t N>
+static_list <T, N> ::static_list(const static_list & rhs) : static_list()
+{
+   for (const T & t : rhs)
+      push_back(t);
+}
+
+template <typename T, size_t N>
+static_list <T, N> ::static_list(size_t num, const T & t) : static_list()
+{
+   for (size_t i = 0; i < num; i++)
+      push_back(t);
+}
+
+template <typename T, size_t N>
+static_list <T, N> ::static_list(size_t num) : static_list()
+{
+   for (size_t i = 0; i < num; i++)
+      push_back(T());
+}
+
+template <typename T, size_t N>
+static_list <T, N> ::static_list(const std::initializer_list<T> & il) : static_list()
+{
+   for (const T & t : il)
+      push_back(t);
+}
+
+template <typename T, size_t N>
+template <class Iterator>
+static_list <T, N> ::static_list(Iterator first, Iterator last) : static_list()
+{
+   for (; first != last; ++first)
+      push_back(*first);
+}
+
+/*****************************************
+ * STATIC LIST :: MOVE CONSTRUCTOR
+ * The nodes live inside rhs, so they cannot be
+ * stolen. Each item is moved instead, leaving rhs empty
+ *     COST : O(n)
+ ****************************************/
+template <typename T, size_t N>
+static_list <T, N> ::static_list(static_list && rhs) : static_list()
+{
+   for (T & t : rhs)
+      push_back(std::move(t));
+   rhs.clear();
+}
+
+/*****************************************
+ * STATIC LIST :: ASSIGN
+ * Copy over the items already here, then add or
+ * remove nodes at the end to make up the difference
+ *     COST : O(n) with respect to the larger of the two
+ ****************************************/
+template <typename T, size_t N>
+static_list <T, N> & static_list <T, N> ::operator = (const static_list & rhs)
+{
+   if (this != &rhs)
+      assignRange(rhs.begin(), rhs.end());
+   return *this;
+}
+
+template <typename T, size_t N>
+static_list <T, N> & static_list <T, N> ::operator = (const std::initializer_list<T> & il)
+{
+   assignRange(il.begin(), il.end());
+   return *this;
+}
+
+template <typename T, size_t N>
+static_list <T, N> & static_list <T, N> ::operator = (static_list && rhs)
+{
+   if (this != &rhs)
+   {
+      assignRange(std::make_move_iterator(rhs.begin()),
+                  std::make_move_iterator(rhs.end()));
+      rhs.clear();
+   }
+   return *this;
+}
+
+template <typename T, size_t N>
+template <class Iterator>
+void static_list <T, N> ::assignRange(Iterator first, Iterator last)
+{
+   iterator it = begin();
+   for (; it != end() && first != last; ++it, ++first)
+      *it = *first;
+
+   for (; first != last; ++first)
+      push_back(*first);
+   while (it != end())
+      it = erase(it);
+}
+
+/*****************************************
+ * STATIC LIST :: ALLOCATE NODE
+ * Take a slot off the free list, or the next slot
+ * that has never been used
+ *     COST : O(1)
+ ****************************************/
+template <typename T, size_t N>
+typename static_list <T, N> ::Index static_list <T, N> ::allocateNode()
+{
+   if (iFree != NIL)
+   {
+      Index i = iFree;
+      iFree = nodes[i].next;
+      return i;
+   }
+   if (numUsed == N)
+      throw "ERROR: unable to insert into a full static_list";
+   return numUsed++;
+}
+
+/*****************************************
+ * STATIC LIST :: FREE NODE
+ * Put a slot whose data is already destroyed on
+ * the free list
+ *     COST : O(1)
+ ****************************************/
+template <typename T, size_t N>
+void static_list <T, N> ::freeNode(Index i)
+{
+   nodes[i].next = iFree;
+   iFree = i;
+}
+
+/*****************************************
+ * STATIC LIST :: FRONT and BACK
+ ****************************************/
+template <typename T, size_t N>
+T & static_list <T, N> ::front()
+{
+   if (iHead == NIL)
+      throw "ERROR: unable to access data from an empty list";
+   return *nodes[iHead].data();
+}
+
+template <typename T, size_t N>
+T & static_list <T, N> ::back()
+{
+   if (iTail == NIL)
+      throw "ERROR: unable to access data from an empty list";
+   return *nodes[iTail].data();
+}
+
+/*****************************************
+ * STATIC LIST :: INSERT
+ * Add an item before it
+ *     INPUT  : where to insert and what to insert
+ *     OUTPUT : an iterator to the new item
+ *     COST   : O(1)
+ ****************************************/
+template <typename T, size_t N>
+typename static_list <T, N> ::iterator static_list <T, N> ::insert(iterator it,
+                                                                  const T & data)
+{
+   return linkBefore(it, data);
+}
+
+template <typename T, size_t N>
+typename static_list <T, N> ::iterator static_list <T, N> ::insert(iterator it,
+                                                                  T && data)
+{
+   return linkBefore(it, std::move(data));
+}
+
+template <typename T, size_t N>
+template <class U>
+typename static_list <T, N> ::iterator static_list <T, N> ::linkBefore(iterator it,
+                                                                      U && data)
+{
+   Index iNew = allocateNode();
+   Node & n = nodes[iNew];
+   try
+   {
+      new (n.storage) T(std::forward<U>(data));
+   }
+   catch (...)
+   {
+      freeNode(iNew);
+      throw;
+   }
+
+   Index iPrev = (it.i == NIL) ? iTail : nodes[it.i].prev;
+   n.next = it.i;
+   n.prev = iPrev;
+
+   if (iPrev != NIL)
+      nodes[iPrev].next = iNew;
+   else
+      iHead = iNew;
+
+   if (it.i != NIL)
+      nodes[it.i].prev = iNew;
+   else
+      iTail = iNew;
+
+   numElements++;
+   return iterator(this, iNew);
+}
+
+/*****************************************
+ * STATIC LIST :: ERASE
+ * Unlink the item at it and recycle its slot
+ *     INPUT  : the item to remove
+ *     OUTPUT : an iterator to the item after it
+ *     COST   : O(1)
+ ****************************************/
+template <typename T, size_t N>
+typename static_list <T, N> ::iterator static_list <T, N> ::erase(const iterator & it)
+{
+   if (it.i == NIL)
+      return end();
+
+   Node & n = nodes[it.i];
+   Index iNext = n.next;
+
+   if (n.prev != NIL)
+      nodes[n.prev].next = n.next;
+   else
+      iHead = n.next;
+
+   if (n.next != NIL)
+      nodes[n.next].prev = n.prev;
+   else
+      iTail = n.prev;
+
+   n.data()->~T();
+   freeNode(it.i);
+   numElements--;
+   return iterator(this, iNext);
+}
+
+/*****************************************
+ * STATIC LIST :: POP FRONT and POP BACK
+ ****************************************/
+template <typename T, size_t N>
+void static_list <T, N> ::pop_front()
+{
+   if (!empty())
+      erase(begin());
+}
+
+template <typename T, size_t N>
+void static_list <T, N> ::pop_back()
+{
+   if (!empty())
+      erase(iterator(this, iTail));
+}
+
+/*****************************************
+ * STATIC LIST :: CLEAR
+ * Destroy every item and hand the whole chain to
+ * the free list at once
+ *     COST : O(n), O(1) for trivially destructible T
+ ****************************************/
+template <typename T, size_t N>
+void static_list <T, N> ::clear()
+{
+   if (iHead == NIL)
+      return;
+
+   if (!std::is_trivially_destructible<T>::value)
+      for (Index i = iHead; i != NIL; i = nodes[i].next)
+         nodes[i].data()->~T();
+
+   nodes[iTail].next = iFree;
+   iFree = iHead;
+   iHead = iTail = NIL;
+   numElements = 0;
+}
+
+/*****************************************
+ * STATIC LIST :: REMOVE and REMOVE IF
+ * Erase every item equal to value, or for which
+ * pred is true. value may be one of our own items,
+ * so its slot is erased last and every comparison
+ * reads a live object
+ *     OUTPUT : the number of items removed
+ *     COST   : O(n)
+ ****************************************/
+template <typename T, size_t N>
+size_t static_list <T, N> ::remove(const T & value)
+{
+   iterator itValue = end();
+   size_t numRemoved = 0;
+   for (iterator it = begin(); it != end(); )
+      if (!(*it == value))
+         ++it;
+      else if (nodes[it.i].data() == &value)
+      {
+         itValue = it;
+         ++it;
+      }
+      else
+      {
+         it = erase(it);
+         numRemoved++;
+      }
+
+   if (itValue != end())
+   {
+      erase(itValue);
+      numRemoved++;
+   }
+   return numRemoved;
+}
+
+template <typename T, size_t N>
+template <class Predicate>
+size_t static_list <T, N> ::remove_if(Predicate pred)
+{
+   size_t numRemoved = 0;
+   for (iterator it = begin(); it != end(); )
+      if (pred(*it))
+      {
+         it = erase(it);
+         numRemoved++;
+      }
+      else
+         ++it;
+   return numRemoved;
+}
+
+/*****************************************
+ * STATIC LIST :: SWAP
+ * The nodes cannot trade places between two lists,
+ * so the items they share are swapped in place and
+ * the longer list's extra items are moved across
+ *     COST : O(n) with respect to the larger of the two
+ ****************************************/
+template <typename T, size_t N>
+void static_list <T, N> ::swap(static_list & rhs)
+{
+   using std::swap;
+   if (this == &rhs)
+      return;
+
+   iterator itLhs = begin();
+   iterator itRhs = rhs.begin();
+   for (; itLhs != end() && itRhs != rhs.end(); ++itLhs, ++itRhs)
+      swap(*itLhs, *itRhs);
+
+   for (; itLhs != end(); itLhs = erase(itLhs))
+      rhs.push_back(std::move(*itLhs));
+   for (; itRhs != rhs.end(); itRhs = rhs.erase(itRhs))
+      push_back(std::move(*itRhs));
+}
+
+/*****************************************
+ * STATIC LIST :: REVERSE
+ * Swap every node's links, then head and tail
+ *     COST : O(n), nothing is copied
+ ****************************************/
+template <typename T, size_t N>
+void static_list <T, N> ::reverse()
+{
+   for (Index i = iHead; i != NIL; i = nodes[i].prev)
+      std::swap(nodes[i].next, nodes[i].prev);
+   std::swap(iHead, iTail);
+}
+
+/*****************************************
+ * SWAP
+ * Swap two static lists
+ ****************************************/
+template <typename T, size_t N>
+inline void swap(static_list <T, N> & lhs, static_list <T, N> & rhs)
+{
+   lhs.swap(rhs);
+}
+
+} // namespace custom
@@ -0,0 +1,397 @@
+/***********************************************************************
+ * Header:
+ *    TEST CHANNEL
+ * Summary:
+ *    Unit tests for channel and the coroutines that talk through it
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "channel.h"    // class under test
+#include "unitTest.h"   // unit test baseclass
+
+#ifdef CHANNEL_HAS_COROUTINES
+
+#include <atomic>       // for std::atomic
+#include <cstdint>      // for std::uintptr_t and UINTPTR_MAX
+#include <exception>    // for std::terminate
+#include <memory>       // for std::unique_ptr
+#include <string>       // for std::string
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+
+/***********************************************
+ * DETACHED
+ * A coroutine that starts at once and frees
+ * itself when it finishes
+ ***********************************************/
+struct Detached
+{
+   struct promise_type
+   {
+      Detached get_return_object() { return Detached(); }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() { }
+      void unhandled_exception() { std::terminate(); }
+   };
+};
+
+/***********************************************
+ * TEST CHANNEL
+ * Unit tests for the channel class
+ ***********************************************/
+class TestChannel : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_zeroCapacity();
+
+      // Send and receive
+      test_recv_buffered();
+      test_recv_suspends();
+      test_send_backpressure();
+      test_send_moves();
+
+      // Close
+      test_close_wakesReceivers();
+      test_close_failsSenders();
+      test_close_drains();
+
+      // Pipelines
+      test_pipeline_thousandStages();
+      test_pipeline_flatStack();
+      test_pipeline_threads();
+
+      report("Channel");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a channel must have room for something
+   void test_construct_zeroCapacity()
+   {  // setup
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::channel<int> ch(0);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   /***************************************
+    * SEND AND RECEIVE
+    ***************************************/
+
+   // items already buffered come out in order without waiting
+   void test_recv_buffered()
+   {  // setup
+      custom::channel<int> ch(3);
+      ch.try_send(1);
+      ch.try_send(2);
+      ch.try_send(3);
+      std::vector<int> got;
+      // exercise
+      receive(ch, got, 3);
+      // verify
+      assertUnit(got == std::vector<int>({ 1, 2, 3 }));
+      assertUnit(ch.empty());
+   }  // teardown
+
+   // a receiver waits for the next send, which resumes it
+   void test_recv_suspends()
+   {  // setup
+      custom::channel<int> ch;
+      std::vector<int> got;
+      receive(ch, got, 1);
+      assertUnit(got.empty());
+      assertUnit(ch.receivers.pHead != nullptr);
+      // exercise
+      bool sent = ch.try_send(42);
+      // verify
+      assertUnit(sent);
+      assertUnit(got == std::vector<int>({ 42 }));
+      assertUnit(ch.receivers.empty());
+      assertUnit(ch.empty());
+   }  // teardown
+
+   // a full channel holds the sender back until there is room
+   void test_send_backpressure()
+   {  // setup
+      custom::channel<int> ch(2);
+      int numSent = 0;
+      send(ch, 0, 5, numSent);
+      assertUnit(numSent == 2);
+      assertUnit(ch.size() == 2);
+      // exercise
+      std::optional<int> first = ch.try_recv();
+      // verify
+      assertUnit(first && *first == 0);
+      assertUnit(numSent == 3);
+      assertUnit(ch.size() == 2);
+      std::vector<int> got;
+      receive(ch, got, 4);
+      assertUnit(numSent == 5);
+      assertUnit(got == std::vector<int>({ 1, 2, 3, 4 }));
+   }  // teardown
+
+   // a suspended sender's item is moved, not copied, into the buffer
+   void test_send_moves()
+   {  // setup
+      custom::channel<std::unique_ptr<int>> ch(1);
+      ch.try_send(std::unique_ptr<int>(new int(1)));
+      bool done = false;
+      sendPointer(ch, 2, done);
+      assertUnit(!done);
+      // exercise
+      std::optional<std::unique_ptr<int>> first = ch.try_recv();
+      std::optional<std::unique_ptr<int>> second = ch.try_recv();
+      // verify
+      assertUnit(done);
+      assertUnit(first && **first == 1);
+      assertUnit(second && **second == 2);
+   }  // teardown
+
+   /***************************************
+    * CLOSE
+    ***************************************/
+
+   // closing wakes a waiting receiver empty-handed
+   void test_close_wakesReceivers()
+   {  // setup
+      custom::channel<int> ch;
+      std::vector<int> got;
+      bool ended = false;
+      receiveAll(ch, got, ended);
+      assertUnit(!ended);
+      // exercise
+      ch.close();
+      // verify
+      assertUnit(ended);
+      assertUnit(got.empty());
+      assertUnit(ch.is_closed());
+   }  // teardown
+
+   // closing fails a waiting sender, and any send after it
+   void test_close_failsSenders()
+   {  // setup
+      custom::channel<int> ch(1);
+      int numSent = 0;
+      send(ch, 0, 3, numSent);
+      assertUnit(numSent == 1);
+      // exercise
+      ch.close();
+      // verify
+      assertUnit(numSent == 1);
+      assertUnit(!ch.try_send(9));
+      assertUnit(ch.size() == 1);
+   }  // teardown
+
+   // what was buffered before close can still be received
+   void test_close_drains()
+   {  // setup
+      custom::channel<int> ch;
+      ch.try_send(1);
+      ch.try_send(2);
+      // exercise
+      ch.close();
+      std::vector<int> got;
+      bool ended = false;
+      receiveAll(ch, got, ended);
+      // verify
+      assertUnit(ended);
+      assertUnit(got == std::vector<int>({ 1, 2 }));
+   }  // teardown
+
+   /***************************************
+    * PIPELINES
+    ***************************************/
+
+   // a thousand stages on one thread, each adding one
+   void test_pipeline_thousandStages()
+   {  // setup
+      const int numStages = 1000;
+      std::vector<std::unique_ptr<custom::channel<int>>> channels;
+      for (int i = 0; i <= numStages; i++)
+         channels.emplace_back(new custom::channel<int>(1));
+      for (int i = 0; i < numStages; i++)
+         addOne(*channels[i], *channels[i + 1]);
+      std::vector<int> got;
+      bool ended = false;
+      receiveAll(*channels[numStages], got, ended);
+      // exercise
+      for (int value = 0; value < 10; value++)
+         channels[0]->try_send(value * 100);
+      closeInOrder(channels);
+      // verify
+      assertUnit(ended);
+      assertUnit(got.size() == 10);
+      bool right = true;
+      for (int value = 0; value < (int)got.size(); value++)
+         right = right && got[value] == value * 100 + numStages;
+      assertUnit(right);
+   }  // teardown
+
+   // handing an item down a long pipeline does not nest one stage inside another
+   void test_pipeline_flatStack()
+   {  // setup
+      const int numStages = 1000;
+      std::vector<std::unique_ptr<custom::channel<int>>> channels;
+      for (int i = 0; i <= numStages; i++)
+         channels.emplace_back(new custom::channel<int>(1));
+      std::uintptr_t lowest = UINTPTR_MAX;
+      std::uintptr_t highest = 0;
+      for (int i = 0; i < numStages; i++)
+         addOneNoting(*channels[i], *channels[i + 1], lowest, highest);
+      std::vector<int> got;
+      bool ended = false;
+      receiveAll(*channels[numStages], got, ended);
+      // exercise
+      for (int value = 0; value < 10; value++)
+         channels[0]->try_send(value);
+      closeInOrder(channels);
+      // verify
+      assertUnit(ended);
+      assertUnit(got.size() == 10);
+#if defined(__clang__) || defined(__OPTIMIZE__)
+      // unoptimized GCC calls the next coroutine rather than jumping to it
+      assertUnit(highest - lowest < 64 * 1024);
+#endif
+      assertUnit(custom::handoff::ready.empty());
+      assertUnit(!custom::handoff::running);
+   }  // teardown
+
+   // producers on several threads feed one consumer through a small buffer
+   void test_pipeline_threads()
+   {  // setup
+      const int numThreads = 4;
+      const int numEach = 2000;
+      custom::channel<int> ch(8);
+      std::atomic<long long> sum(0);
+      std::atomic<int> numReceived(0);
+      sumAll(ch, sum, numReceived);
+      // exercise
+      std::vector<std::thread> threads;
+      std::atomic<int> numProducing(numThreads);
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&, t]()
+         {
+            produce(ch, t * numEach, numEach, numProducing);
+         });
+      for (std::thread & thread : threads)
+         thread.join();
+      // verify
+      long long n = (long long)numThreads * numEach;
+      assertUnit(numReceived == n);
+      assertUnit(sum == n * (n - 1) / 2);
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // receive num items into got
+   static Detached receive(custom::channel<int> & ch, std::vector<int> & got, int num)
+   {
+      for (int i = 0; i < num; i++)
+      {
+         std::optional<int> value = co_await ch.recv();
+         if (value)
+            got.push_back(*value);
+      }
+   }
+
+   // receive into got until the channel is closed
+   static Detached receiveAll(custom::channel<int> & ch, std::vector<int> & got, bool & ended)
+   {
+      while (std::optional<int> value = co_await ch.recv())
+         got.push_back(*value);
+      ended = true;
+   }
+
+   // send first, first+1, ... first+num-1, counting each one that goes in
+   static Detached send(custom::channel<int> & ch, int first, int num, int & numSent)
+   {
+      for (int i = 0; i < num; i++)
+         if (co_await ch.send(first + i))
+            numSent++;
+   }
+
+   // send a pointer to value
+   static Detached sendPointer(custom::channel<std::unique_ptr<int>> & ch, int value, bool & done)
+   {
+      co_await ch.send(std::unique_ptr<int>(new int(value)));
+      done = true;
+   }
+
+   // pass every item from in to out, one larger
+   static Detached addOne(custom::channel<int> & in, custom::channel<int> & out)
+   {
+      while (std::optional<int> value = co_await in.recv())
+         co_await out.send(*value + 1);
+   }
+
+   // addOne, noting how far down the stack each stage runs
+   static Detached addOneNoting(custom::channel<int> & in, custom::channel<int> & out,
+                                std::uintptr_t & lowest, std::uintptr_t & highest)
+   {
+      while (std::optional<int> value = co_await in.recv())
+      {
+         std::uintptr_t p = stackDepth();
+         lowest = p < lowest ? p : lowest;
+         highest = p > highest ? p : highest;
+         co_await out.send(*value + 1);
+      }
+   }
+
+   // where the stack has got to in the caller
+   static __attribute__((noinline)) std::uintptr_t stackDepth()
+   {
+      return (std::uintptr_t)__builtin_frame_address(0);
+   }
+
+   // close each channel of a pipeline once it has drained into the next
+   static void closeInOrder(std::vector<std::unique_ptr<custom::channel<int>>> & channels)
+   {
+      for (std::unique_ptr<custom::channel<int>> & ch : channels)
+         ch->close();
+   }
+
+   // send num items starting at first; the last producer closes the channel
+   static Detached produce(custom::channel<int> & ch, int first, int num,
+                           std::atomic<int> & numProducing)
+   {
+      for (int i = 0; i < num; i++)
+         co_await ch.send(first + i);
+      if (--numProducing == 0)
+         ch.close();
+   }
+
+   // add up everything received until the channel is closed
+   static Detached sumAll(custom::channel<int> & ch, std::atomic<long long> & sum,
+                          std::atomic<int> & numReceived)
+   {
+      while (std::optional<int> value = co_await ch.recv())
+      {
+         sum += *value;
+         numReceived++;
+      }
+   }
+};
+
+#endif // CHANNEL_HAS_COROUTINES
+#endif // DEBUG
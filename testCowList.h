@@ -0,0 +1,334 @@
+/***********************************************************************
+ * Header:
+ *    TEST COW LIST
+ * Summary:
+ *    Unit tests for cow_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "cowList.h"    // class under test
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST COW LIST
+ * Unit tests for the cow_list class
+ ***********************************************/
+class TestCowList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_fromList();
+      test_copy_shares();
+      test_move_steals();
+
+      // Change
+      test_pushback_clonesShared();
+      test_pushback_unsharedInPlace();
+      test_pop_bothEnds();
+      test_remove_noMatchNoClone();
+      test_remove_clones();
+      test_edit_clones();
+      test_clear_letsGo();
+
+      // Assign
+      test_assign_shares();
+      test_assign_self();
+
+      // Threads
+      test_threads_readCopies();
+      test_threads_writeCopies();
+
+      report("CowList");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // an empty handle owns nothing
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::cow_list<int> l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.use_count() == 0);
+      assertUnit(l.begin() == l.end());
+      assertUnit(l.pBody == nullptr);
+   }  // teardown
+
+   // adopt a list without copying its items
+   void test_construct_fromList()
+   {  // setup
+      custom::list<Spy> items;
+      items.push_back(Spy(1));
+      items.push_back(Spy(2));
+      Spy::reset();
+      // exercise
+      custom::cow_list<Spy> l(std::move(items));
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(l.size() == 2);
+      assertUnit(l.front() == Spy(1));
+      assertUnit(l.back() == Spy(2));
+   }  // teardown
+
+   // a copy shares the chain and copies no items
+   void test_copy_shares()
+   {  // setup
+      custom::cow_list<Spy> lSrc(makeSpies(100));
+      Spy::reset();
+      // exercise
+      custom::cow_list<Spy> lCopy(lSrc);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(lCopy.pBody == lSrc.pBody);
+      assertUnit(lSrc.use_count() == 2);
+      assertUnit(lCopy.size() == 100);
+   }  // teardown
+
+   // a move hands the body over without touching the count
+   void test_move_steals()
+   {  // setup
+      custom::cow_list<int> lSrc{ 1, 2, 3 };
+      custom::cow_list<int> lShare(lSrc);
+      // exercise
+      custom::cow_list<int> lDes(std::move(lSrc));
+      // verify
+      assertUnit(lSrc.pBody == nullptr);
+      assertUnit(lSrc.empty());
+      assertUnit(lDes.use_count() == 2);
+      assertUnit(lDes.pBody == lShare.pBody);
+   }  // teardown
+
+   /***************************************
+    * CHANGE
+    ***************************************/
+
+   // changing a shared chain clones it; the other copy is untouched
+   void test_pushback_clonesShared()
+   {  // setup
+      custom::cow_list<int> lSrc{ 1, 2, 3 };
+      custom::cow_list<int> lCopy(lSrc);
+      // exercise
+      lCopy.push_back(4);
+      // verify
+      assertUnit(lCopy.pBody != lSrc.pBody);
+      assertUnit(lSrc.use_count() == 1);
+      assertUnit(lCopy.use_count() == 1);
+      assertUnit(isSequence(lSrc, 1, 4));
+      assertUnit(isSequence(lCopy, 1, 5));
+   }  // teardown
+
+   // changing a chain nobody else holds does not clone it
+   void test_pushback_unsharedInPlace()
+   {  // setup
+      custom::cow_list<Spy> l(makeSpies(10));
+      const void * pBefore = l.pBody;
+      Spy::reset();
+      // exercise
+      l.push_back(Spy(10));
+      // verify
+      assertUnit(l.pBody == pBefore);
+      assertUnit(Spy::numCopy() == 0);       // the new item is moved in
+      assertUnit(Spy::numCopyMove() == 1);
+      assertUnit(l.size() == 11);
+   }  // teardown
+
+   // pop from both ends of a shared chain
+   void test_pop_bothEnds()
+   {  // setup
+      custom::cow_list<int> lSrc{ 0, 1, 2, 3 };
+      custom::cow_list<int> lCopy(lSrc);
+      // exercise
+      lCopy.pop_front();
+      lCopy.pop_back();
+      // verify
+      assertUnit(isSequence(lCopy, 1, 3));
+      assertUnit(isSequence(lSrc, 0, 4));
+   }  // teardown
+
+   // removing nothing from a shared chain leaves it shared
+   void test_remove_noMatchNoClone()
+   {  // setup
+      custom::cow_list<int> lSrc{ 1, 2, 3 };
+      custom::cow_list<int> lCopy(lSrc);
+      // exercise
+      size_t numRemoved = lCopy.remove(99);
+      // verify
+      assertUnit(numRemoved == 0);
+      assertUnit(lCopy.pBody == lSrc.pBody);
+      assertUnit(lSrc.use_count() == 2);
+   }  // teardown
+
+   // removing something from a shared chain clones it first
+   void test_remove_clones()
+   {  // setup
+      custom::cow_list<int> lSrc{ 1, 2, 3, 4 };
+      custom::cow_list<int> lCopy(lSrc);
+      // exercise
+      size_t numRemoved = lCopy.remove_if([](int v) { return v % 2 == 0; });
+      // verify
+      assertUnit(numRemoved == 2);
+      assertUnit(lCopy.size() == 2);
+      assertUnit(lSrc.size() == 4);
+   }  // teardown
+
+   // edit() hands over a list owned by this handle alone
+   void test_edit_clones()
+   {  // setup
+      custom::cow_list<int> lSrc{ 3, 2, 1 };
+      custom::cow_list<int> lCopy(lSrc);
+      // exercise
+      lCopy.edit([](custom::list<int> & items)
+      {
+         items.reverse();
+         items.front() = 0;
+      });
+      // verify
+      assertUnit(lCopy.front() == 0);
+      assertUnit(lCopy.back() == 3);
+      assertUnit(lSrc.front() == 3);
+   }  // teardown
+
+   // clearing a shared handle lets go without cloning or freeing
+   void test_clear_letsGo()
+   {  // setup
+      custom::cow_list<Spy> lSrc(makeSpies(5));
+      custom::cow_list<Spy> lCopy(lSrc);
+      Spy::reset();
+      // exercise
+      lCopy.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(lCopy.empty());
+      assertUnit(lSrc.size() == 5);
+      assertUnit(lSrc.use_count() == 1);
+   }  // teardown
+
+   /***************************************
+    * ASSIGN
+    ***************************************/
+
+   // assigning shares, and the old chain goes with its last handle
+   void test_assign_shares()
+   {  // setup
+      Spy::reset();
+      {
+         custom::cow_list<Spy> lSrc(makeSpies(3));
+         custom::cow_list<Spy> lDes(makeSpies(4));
+         // exercise
+         lDes = lSrc;
+         // verify
+         assertUnit(lDes.pBody == lSrc.pBody);
+         assertUnit(lSrc.use_count() == 2);
+         assertUnit(lDes.size() == 3);
+      }
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+   }  // teardown
+
+   // assigning a handle to itself changes nothing
+   void test_assign_self()
+   {  // setup
+      custom::cow_list<int> l{ 1, 2 };
+      custom::cow_list<int> & lAlias = l;
+      // exercise
+      l = lAlias;
+      // verify
+      assertUnit(l.use_count() == 1);
+      assertUnit(isSequence(l, 1, 3));
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // hundreds of threads each get their own copy and only read it
+   void test_threads_readCopies()
+   {  // setup
+      custom::cow_list<int> routes{ 1, 2, 3, 4, 5 };
+      std::vector<long> sums(200, 0);
+      // exercise
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 200; t++)
+         threads.emplace_back([&sums, t](custom::cow_list<int> mine)
+         {
+            for (int value : mine)
+               sums[t] += value;
+         }, routes);
+      for (std::thread & thread : threads)
+         thread.join();
+      // verify
+      bool right = true;
+      for (long sum : sums)
+         right = right && sum == 15;
+      assertUnit(right);
+      assertUnit(routes.use_count() == 1);
+   }  // teardown
+
+   // threads that write clone, and never disturb each other
+   void test_threads_writeCopies()
+   {  // setup
+      custom::cow_list<int> shared{ 1, 2, 3 };
+      std::vector<size_t> sizes(16, 0);
+      // exercise
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 16; t++)
+         threads.emplace_back([&sizes, t](custom::cow_list<int> mine)
+         {
+            for (int i = 0; i < t; i++)
+               mine.push_back(i);
+            sizes[t] = mine.size();
+         }, shared);
+      for (std::thread & thread : threads)
+         thread.join();
+      // verify
+      bool right = true;
+      for (int t = 0; t < 16; t++)
+         right = right && sizes[t] == (size_t)(3 + t);
+      assertUnit(right);
+      assertUnit(isSequence(shared, 1, 4));
+      assertUnit(shared.use_count() == 1);
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // a list of Spy(0), Spy(1), ... Spy(num-1)
+   static custom::list<Spy> makeSpies(int num)
+   {
+      custom::list<Spy> items;
+      for (int i = 0; i < num; i++)
+         items.push_back(Spy(i));
+      return items;
+   }
+
+   // does the list hold first, first+1, ... last-1 ?
+   bool isSequence(const custom::cow_list<int>& l, int first, int last)
+   {
+      int value = first;
+      for (auto it = l.begin(); it != l.end(); ++it)
+         if (*it != value++)
+            return false;
+      return value == last && l.size() == (size_t)(last - first);
+   }
+};
+
+#endif // DEBUG
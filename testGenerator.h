@@ -0,0 +1,241 @@
+/***********************************************************************
+ * Header:
+ *    TEST GENERATOR
+ * Summary:
+ *    Unit tests for generator, the lazy stages, and list as a range
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "generator.h"  // functions under test
+#include "list.h"       // the list they run over
+#include "unitTest.h"   // unit test baseclass
+
+#ifdef GENERATOR_HAS_COROUTINES
+
+#include <ranges>       // for std::ranges::bidirectional_range
+#include <stdexcept>    // for std::runtime_error
+#include <string>       // for std::string
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST GENERATOR
+ * Unit tests for generator and the lazy stages
+ ***********************************************/
+class TestGenerator : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Ranges
+      test_list_isRange();
+      test_list_stdViews();
+
+      // Generator
+      test_generator_empty();
+      test_generator_lazy();
+      test_generator_exception();
+
+      // Stages
+      test_filter_list();
+      test_transform_list();
+      test_take_stopsEarly();
+      test_chain_noTemporaries();
+      test_chain_stdViews();
+
+      report("Generator");
+   }
+
+   /***************************************
+    * RANGES
+    ***************************************/
+
+   // list works with every range algorithm that needs two-way iterators
+   void test_list_isRange()
+   {  // setup
+      // exercise
+      // verify
+      static_assert(std::ranges::bidirectional_range<custom::list<int>>);
+      static_assert(std::ranges::bidirectional_range<const custom::list<int>>);
+      static_assert(std::ranges::common_range<custom::list<int>>);
+      static_assert(std::ranges::sized_range<custom::list<int>>);
+      static_assert(std::ranges::view<custom::generator<int>>);
+      static_assert(std::ranges::input_range<custom::generator<int>>);
+      assertUnit(true);
+   }  // teardown
+
+   // the std::views adaptors run straight over a list
+   void test_list_stdViews()
+   {  // setup
+      custom::list<int> l{ 1, 2, 3, 4, 5, 6 };
+      // exercise
+      std::vector<int> got;
+      for (int value : l | std::views::reverse
+                         | std::views::filter([](int v) { return v % 2 == 0; }))
+         got.push_back(value);
+      // verify
+      assertUnit(got == std::vector<int>({ 6, 4, 2 }));
+   }  // teardown
+
+   /***************************************
+    * GENERATOR
+    ***************************************/
+
+   // a coroutine that yields nothing is an empty range
+   void test_generator_empty()
+   {  // setup
+      custom::generator<int> gen = countTo(0, nullptr);
+      // exercise
+      int num = 0;
+      for (int value : gen)
+         num += value + 1;
+      // verify
+      assertUnit(num == 0);
+   }  // teardown
+
+   // nothing runs until an item is asked for
+   void test_generator_lazy()
+   {  // setup
+      int numMade = 0;
+      custom::generator<int> gen = countTo(100, &numMade);
+      assertUnit(numMade == 0);
+      // exercise
+      auto it = gen.begin();
+      ++it;
+      // verify
+      assertUnit(numMade == 2);
+      assertUnit(*it == 1);
+   }  // teardown
+
+   // an exception in the coroutine reaches whoever stepped it
+   void test_generator_exception()
+   {  // setup
+      custom::generator<int> gen = throwAfter(3);
+      std::vector<int> got;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         for (int value : gen)
+            got.push_back(value);
+      }
+      catch (const std::runtime_error &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(got == std::vector<int>({ 0, 1, 2 }));
+   }  // teardown
+
+   /***************************************
+    * STAGES
+    ***************************************/
+
+   // keep the odd items of a list
+   void test_filter_list()
+   {  // setup
+      custom::list<int> l{ 1, 2, 3, 4, 5 };
+      // exercise
+      std::vector<int> got = collect(custom::lazy_filter(l, [](int v) { return v % 2 == 1; }));
+      // verify
+      assertUnit(got == std::vector<int>({ 1, 3, 5 }));
+   }  // teardown
+
+   // change the type of every item
+   void test_transform_list()
+   {  // setup
+      custom::list<int> l{ 1, 22, 333 };
+      // exercise
+      std::vector<size_t> got;
+      for (size_t value : custom::lazy_transform(l, [](int v) { return std::to_string(v); })
+                        | custom::transform([](const std::string & s) { return s.size(); }))
+         got.push_back(value);
+      // verify
+      assertUnit(got == std::vector<size_t>({ 1, 2, 3 }));
+   }  // teardown
+
+   // take() never asks for the item after the last one taken
+   void test_take_stopsEarly()
+   {  // setup
+      int numMade = 0;
+      // exercise
+      std::vector<int> got = collect(countTo(1000000, &numMade) | custom::take(3));
+      // verify
+      assertUnit(got == std::vector<int>({ 0, 1, 2 }));
+      assertUnit(numMade == 3);
+   }  // teardown
+
+   // filter, transform, take: each item runs the whole chain, and only as many as needed
+   void test_chain_noTemporaries()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i);
+      int numTested = 0;
+      int numScored = 0;
+      // exercise
+      std::vector<int> got = collect(l
+         | custom::filter([&](int v) { numTested++; return v % 3 == 0; })
+         | custom::transform([&](int v) { numScored++; return v * 10; })
+         | custom::take(4));
+      // verify
+      assertUnit(got == std::vector<int>({ 0, 30, 60, 90 }));
+      assertUnit(numTested == 10);
+      assertUnit(numScored == 4);
+      assertUnit(l.size() == 1000);
+   }  // teardown
+
+   // a generator feeds the std::views adaptors too
+   void test_chain_stdViews()
+   {  // setup
+      custom::list<int> l{ 5, 6, 7, 8, 9 };
+      // exercise
+      std::vector<int> got;
+      for (int value : custom::lazy_transform(l, [](int v) { return v * v; })
+                     | std::views::take(2))
+         got.push_back(value);
+      // verify
+      assertUnit(got == std::vector<int>({ 25, 36 }));
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // yield 0, 1, ... num-1, counting in *pNumMade as each one is made
+   static custom::generator<int> countTo(int num, int * pNumMade)
+   {
+      for (int i = 0; i < num; i++)
+      {
+         if (pNumMade)
+            (*pNumMade)++;
+         co_yield i;
+      }
+   }
+
+   // yield 0, 1, ... num-1 and then throw
+   static custom::generator<int> throwAfter(int num)
+   {
+      for (int i = 0; i < num; i++)
+         co_yield i;
+      throw std::runtime_error("out of items");
+   }
+
+   // the items of a generator, in a vector
+   template <typename T>
+   static std::vector<T> collect(custom::generator<T> && gen)
+   {
+      std::vector<T> items;
+      for (const T & item : gen)
+         items.push_back(item);
+      return items;
+   }
+};
+
+#endif // GENERATOR_HAS_COROUTINES
+#endif // DEBUG
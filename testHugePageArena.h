@@ -0,0 +1,350 @@
+/***********************************************************************
+ * Header:
+ *    TEST HUGE PAGE ARENA
+ * Summary:
+ *    Unit tests for page_arena and arena_allocator
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "hugePageArena.h"  // class under test
+#include "list.h"           // the list that uses it
+#include "spy.h"            // for the Spy class
+#include "unitTest.h"       // unit test baseclass
+
+#include <cstdint>          // for std::uintptr_t
+#include <set>              // for std::set
+#include <vector>           // for std::vector
+
+// a payload small enough that the arena rounds its block up
+struct TinyPayload
+{
+   char data[3];
+};
+namespace custom
+{
+template <> struct node_layout<TinyPayload> { typedef payload_out_of_line type; };
+}
+
+/***********************************************
+ * TEST HUGE PAGE ARENA
+ * Unit tests for the page_arena class
+ ***********************************************/
+class TestHugePageArena : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Arena
+      test_arena_lazy();
+      test_arena_reuse();
+      test_arena_sizesKeptApart();
+      test_arena_aligned();
+      test_arena_grow();
+      test_arena_tooLarge();
+      test_arena_hugePagesOff();
+      test_arena_stats();
+
+      // Allocator
+      test_allocator_rebindEqual();
+      test_allocator_otherArena();
+      test_allocator_largeToHeap();
+
+      // List
+      test_list_nodesInArena();
+      test_list_popReuses();
+      test_list_spliceOtherArena();
+      test_list_memoryUsage();
+
+      report("HugePageArena");
+   }
+
+   /***************************************
+    * ARENA
+    ***************************************/
+
+   // nothing is mapped until something is asked for
+   void test_arena_lazy()
+   {  // setup
+      // exercise
+      custom::page_arena arena;
+      // verify
+      assertUnit(arena.bytes_mapped() == 0);
+      assertUnit(arena.pChunks == nullptr);
+   }  // teardown
+
+   // a freed block is the next one of its size handed out
+   void test_arena_reuse()
+   {  // setup
+      custom::page_arena arena;
+      void * p = arena.allocate(24);
+      arena.allocate(24);
+      arena.deallocate(p, 24);
+      // exercise
+      void * pAgain = arena.allocate(24);
+      // verify
+      assertUnit(pAgain == p);
+      assertUnit(arena.bytes_mapped() == custom::page_arena::CHUNK_SIZE);
+   }  // teardown
+
+   // a freed block is never handed out for another size
+   void test_arena_sizesKeptApart()
+   {  // setup
+      custom::page_arena arena;
+      void * p = arena.allocate(24);
+      arena.deallocate(p, 24);
+      // exercise
+      void * pOther = arena.allocate(32);
+      // verify
+      assertUnit(pOther != p);
+      assertUnit(arena.allocate(20) == p);   // 20 and 24 round to the same size
+   }  // teardown
+
+   // blocks are aligned to what any type of their size could need
+   void test_arena_aligned()
+   {  // setup
+      custom::page_arena arena;
+      std::vector<std::uintptr_t> odd;
+      std::vector<std::uintptr_t> even;
+      // exercise
+      for (int i = 0; i < 100; i++)
+      {
+         odd.push_back((std::uintptr_t)arena.allocate(24));
+         even.push_back((std::uintptr_t)arena.allocate(48));
+      }
+      // verify
+      bool aligned = true;
+      for (std::uintptr_t p : odd)
+         aligned = aligned && p % 8 == 0;
+      for (std::uintptr_t p : even)
+         aligned = aligned && p % alignof(std::max_align_t) == 0;
+      assertUnit(aligned);
+#ifndef _WIN32
+      assertUnit((std::uintptr_t)arena.pChunks % custom::page_arena::HUGE_PAGE == 0);
+#endif // _WIN32
+   }  // teardown
+
+   // more than a chunk of blocks maps another chunk; none overlap
+   void test_arena_grow()
+   {  // setup
+      custom::page_arena arena;
+      const size_t size = custom::page_arena::MAX_BLOCK;
+      const size_t num = custom::page_arena::CHUNK_SIZE / size + 10;
+      std::set<char *> blocks;
+      // exercise
+      for (size_t i = 0; i < num; i++)
+         blocks.insert(static_cast<char *>(arena.allocate(size)));
+      // verify
+      assertUnit(blocks.size() == num);
+      assertUnit(arena.numChunks == 2);
+      assertUnit(arena.bytes_mapped() == 2 * custom::page_arena::CHUNK_SIZE);
+      bool apart = true;
+      char * pPrev = nullptr;
+      for (char * p : blocks)
+      {
+         apart = apart && (pPrev == nullptr || pPrev + size <= p);
+         pPrev = p;
+      }
+      assertUnit(apart);
+   }  // teardown
+
+   // blocks bigger than the free lists cover are refused
+   void test_arena_tooLarge()
+   {  // setup
+      custom::page_arena arena;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         arena.allocate(custom::page_arena::MAX_BLOCK + 1);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(arena.bytes_mapped() == 0);
+   }  // teardown
+
+   // an arena told not to use huge pages never claims them
+   void test_arena_hugePagesOff()
+   {  // setup
+      custom::page_arena arena(false /*hugePages*/);
+      // exercise
+      int * p = static_cast<int *>(arena.allocate(sizeof(int)));
+      *p = 7;
+      // verify
+      assertUnit(!arena.huge_pages());
+      assertUnit(*p == 7);
+   }  // teardown
+
+   // live blocks, the peak, and what rounding costs
+   void test_arena_stats()
+   {  // setup
+      custom::page_arena arena;
+      std::vector<void *> blocks;
+      for (int i = 0; i < 4; i++)
+         blocks.push_back(arena.allocate(20));
+      // exercise
+      arena.deallocate(blocks[0], 20);
+      arena.deallocate(blocks[1], 20);
+      // verify
+      custom::allocator_stats s = arena.stats();
+      assertUnit(s.live_blocks == 2);
+      assertUnit(s.peak_blocks == 4);
+      assertUnit(s.bytes_requested == 2 * 20);
+      assertUnit(s.bytes_in_blocks == 2 * 24);
+      assertUnit(s.bytes_reserved == custom::page_arena::CHUNK_SIZE);
+   }  // teardown
+
+   /***************************************
+    * ALLOCATOR
+    ***************************************/
+
+   // rebound copies share the arena, as a node allocator must
+   void test_allocator_rebindEqual()
+   {  // setup
+      custom::page_arena arena;
+      custom::arena_allocator<int> allocInt(arena);
+      // exercise
+      custom::arena_allocator<double> allocDouble(allocInt);
+      // verify
+      assertUnit(allocDouble.arena() == &arena);
+      assertUnit(allocInt == allocDouble);
+      assertUnit(!(allocInt != allocDouble));
+   }  // teardown
+
+   // allocators over different arenas cannot free each other's blocks
+   void test_allocator_otherArena()
+   {  // setup
+      custom::page_arena arena1;
+      custom::page_arena arena2;
+      // exercise
+      custom::arena_allocator<int> alloc1(arena1);
+      custom::arena_allocator<int> alloc2(arena2);
+      // verify
+      assertUnit(alloc1 != alloc2);
+      assertUnit(!(alloc1 == alloc2));
+   }  // teardown
+
+   // arrays and large types go to the heap
+   void test_allocator_largeToHeap()
+   {  // setup
+      struct Big { char data[custom::page_arena::MAX_BLOCK * 2]; };
+      custom::page_arena arena;
+      custom::arena_allocator<Big> allocBig(arena);
+      custom::arena_allocator<int> allocInt(arena);
+      // exercise
+      Big * pBig = allocBig.allocate(1);
+      int * pArray = allocInt.allocate(1000);
+      pArray[999] = 999;
+      // verify
+      assertUnit(arena.bytes_mapped() == 0);
+      assertUnit(pArray[999] == 999);
+      // teardown
+      allocBig.deallocate(pBig, 1);
+      allocInt.deallocate(pArray, 1000);
+   }
+
+   /***************************************
+    * LIST
+    ***************************************/
+
+   // a list over the arena keeps every node inside its chunk
+   void test_list_nodesInArena()
+   {  // setup
+      custom::page_arena arena;
+      custom::arena_allocator<int> alloc(arena);
+      custom::list<int, custom::arena_allocator<int>> l(alloc);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i);
+      // verify
+      char * pBegin = reinterpret_cast<char *>(arena.pChunks);
+      char * pEnd = pBegin + custom::page_arena::CHUNK_SIZE;
+      bool inside = true;
+      bool inOrder = true;
+      int expected = 0;
+      for (const int & value : l)
+      {
+         const char * p = reinterpret_cast<const char *>(&value);
+         inside = inside && p >= pBegin && p < pEnd;
+         inOrder = inOrder && value == expected++;
+      }
+      assertUnit(inside);
+      assertUnit(inOrder);
+      assertUnit(expected == 1000);
+      assertUnit(arena.numChunks == 1);
+   }  // teardown
+
+   // a popped node is the one the next insert gets
+   void test_list_popReuses()
+   {  // setup
+      custom::page_arena arena;
+      custom::arena_allocator<int> alloc(arena);
+      custom::list<int, custom::arena_allocator<int>> l(alloc);
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      const int * pOld = &l.front();
+      // exercise
+      l.pop_front();
+      l.push_back(99);
+      // verify
+      assertUnit(&l.back() == pOld);
+      assertUnit(l.size() == 10);
+      assertUnit(l.front() == 1);
+      assertUnit(arena.numChunks == 1);
+   }  // teardown
+
+   // splicing across arenas moves the items rather than the nodes
+   void test_list_spliceOtherArena()
+   {  // setup
+      custom::page_arena arena1;
+      custom::page_arena arena2;
+      custom::arena_allocator<Spy> alloc1(arena1);
+      custom::arena_allocator<Spy> alloc2(arena2);
+      custom::list<Spy, custom::arena_allocator<Spy>> l1(alloc1);
+      custom::list<Spy, custom::arena_allocator<Spy>> l2(alloc2);
+      l1.push_back(Spy(1));
+      l2.push_back(Spy(2));
+      l2.push_back(Spy(3));
+      Spy::reset();
+      // exercise
+      l1.splice(l1.end(), l2);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 2);
+      assertUnit(l1.size() == 3);
+      assertUnit(l2.empty());
+      assertUnit(l1.back() == Spy(3));
+      char * pBegin = reinterpret_cast<char *>(arena1.pChunks);
+      char * p = reinterpret_cast<char *>(&l1.back());
+      assertUnit(p >= pBegin && p < pBegin + custom::page_arena::CHUNK_SIZE);
+   }  // teardown
+
+   // the list learns the arena's rounding from the allocator
+   void test_list_memoryUsage()
+   {  // setup
+      custom::page_arena arena;
+      custom::arena_allocator<TinyPayload> alloc(arena);
+      custom::list<TinyPayload, custom::arena_allocator<TinyPayload>> l(alloc);
+      for (int i = 0; i < 5; i++)
+         l.push_back(TinyPayload());
+      // exercise
+      custom::list_memory m = l.memory_usage();
+      // verify
+      assertUnit(m.payload_bytes == 5 * sizeof(TinyPayload));
+      assertUnit(m.slack_bytes == 5 * (custom::page_arena::GRANULE - sizeof(TinyPayload)));
+      custom::allocator_stats s = arena.stats();
+      assertUnit(s.live_blocks == 10);
+      assertUnit(s.bytes_requested == m.node_bytes);
+      assertUnit(s.bytes_in_blocks == m.node_bytes + m.slack_bytes);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -2,7 +2,7 @@
  * Header:
  *    Test
  * Summary:
- *    Driver to test list.h
+ *    Driver to test list.h, and to time it when BENCHMARK is defined
  * Author
  *    Br. Helfrich
  ************************************************************************/
@@ -11,8 +11,30 @@
 #define DEBUG   // Remove this to skip the unit tests
 #endif // DEBUG
 
+// #define BENCHMARK   // Add this (and build optimized) to run the benchmarks
+
 #include "testList.h"       // for the list unit tests
 #include "testSpy.h"        // for the spy unit tests
+#include "testMappedList.h" // for the mapped list unit tests
+#include "testUnrolledList.h" // for the unrolled list unit tests
+#include "testParallel.h"   // for the parallel algorithm unit tests
+#include "testMagazineAllocator.h" // for the magazine allocator unit tests
+#include "testStaticList.h" // for the static list unit tests
+#include "testChannel.h"    // for the channel unit tests
+#include "testGenerator.h"  // for the generator unit tests
+#include "testReclaimer.h"  // for the reclaimer unit tests
+#include "testCowList.h"    // for the copy-on-write list unit tests
+#include "testPersistentList.h" // for the persistent list unit tests
+#include "testRcuList.h"    // for the rcu list unit tests
+#include "testShardedList.h" // for the sharded list unit tests
+#include "testReclamation.h" // for the reclamation unit tests
+#include "testHugePageArena.h" // for the huge page arena unit tests
+#ifdef BENCHMARK
+#include "benchAllocator.h" // for the allocator benchmark
+#include "benchLayout.h"    // for the node layout benchmark
+#include "benchReclamation.h" // for the reclamation benchmark
+#include "benchHugePage.h"   // for the huge page benchmark
+#endif // BENCHMARK
 int Spy::counters[] = {};
 
 
@@ -26,7 +48,35 @@ int main()
    // unit tests
    TestSpy().run();
    TestList().run();
+#ifndef _WIN32
+   TestMappedList().run();
+#endif // _WIN32
+   TestUnrolledList().run();
+   TestParallel().run();
+   TestMagazineAllocator().run();
+   TestStaticList().run();
+#ifdef CHANNEL_HAS_COROUTINES
+   TestChannel().run();
+#endif // CHANNEL_HAS_COROUTINES
+#ifdef GENERATOR_HAS_COROUTINES
+   TestGenerator().run();
+#endif // GENERATOR_HAS_COROUTINES
+   TestReclaimer().run();
+   TestCowList().run();
+   TestPersistentList().run();
+   TestRcuList().run();
+   TestShardedList().run();
+   TestReclamation().run();
+   TestHugePageArena().run();
 #endif // DEBUG
+
+#ifdef BENCHMARK
+   // benchmarks
+   benchAllocator();
+   benchLayout();
+   benchReclamation();
+   benchHugePage();
+#endif // BENCHMARK
    
    return 0;
 }
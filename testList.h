@@ -20,6 +20,30 @@
 #include <cassert>
 #include <memory>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+
+// payload types that ask list for the other node layouts
+struct PayloadFirstInt
+{
+   int value;
+};
+struct OutOfLineSpy : public Spy
+{
+   OutOfLineSpy(int value) : Spy(value) { }
+};
+namespace custom
+{
+template <> struct node_layout<PayloadFirstInt> { typedef payload_first       type; };
+template <> struct node_layout<OutOfLineSpy>    { typedef payload_out_of_line type; };
+}
 
 class TestList : public UnitTest
 {
@@ -62,6 +86,12 @@ public:
       test_iterator_increment_standardMiddle();
       test_iterator_dereference_read();
       test_iterator_dereference_update();
+      test_iterator_decrement_end();
+      test_iterator_decrement_standardMiddle();
+      test_constIterator_standard();
+      test_reverseIterator_standard();
+      test_reverseIterator_empty();
+      test_iterator_algorithms();
       
       // Access
       test_front_empty();
@@ -87,6 +117,11 @@ public:
       test_insertMove_empty();
       test_insertMove_standardFront();
       test_insertMove_standardMiddle();
+      test_appendRange_empty();
+      test_appendRange_ontoEmpty();
+      test_appendRange_ontoStandard();
+      test_pushBackN_standard();
+      test_pushBackN_throws();
 
       // Remove
       test_clear_empty();
@@ -105,6 +140,84 @@ public:
       test_size_three();
       test_empty_empty();
       test_empty_three();
+      test_memoryUsage_empty();
+      test_memoryUsage_three();
+      test_memoryUsage_outOfLine();
+
+      // Stats
+      test_stats_noneIsFree();
+      test_stats_nodes();
+      test_stats_increments();
+      test_stats_walks();
+      test_stats_quadratic();
+      test_stats_notCopied();
+
+
+      // Serialize
+      test_save_empty();
+      test_save_standard();
+      test_load_empty();
+      test_load_standard();
+      test_load_replaces();
+      test_load_badHeader();
+      test_load_truncated();
+
+
+      // Remove matching
+      test_remove_empty();
+      test_remove_standardMiddle();
+      test_remove_standardEnds();
+      test_remove_missing();
+      test_removeIf_all();
+      test_removeIf_throws();
+      test_unique_empty();
+      test_unique_runs();
+      test_unique_predicate();
+
+
+      // Reorder
+      test_swap_emptyToStandard();
+      test_swap_standardToStandard();
+      test_swap_nonMember();
+      test_assignMove_standardToStandard();
+      test_reverse_empty();
+      test_reverse_one();
+      test_reverse_standard();
+      test_splitAt_standardMiddle();
+      test_splitAt_begin();
+      test_splitAt_end();
+      test_splitAt_count();
+      test_splitHalf_odd();
+      test_splitHalf_recursive();
+      test_splice_end();
+      test_splice_middle();
+      test_splice_empty();
+
+      // Polymorphic allocator
+#ifdef __cpp_lib_memory_resource
+      test_pmr_monotonic();
+      test_pmr_moveConstruct();
+      test_pmr_moveConstructOther();
+      test_pmr_copyConstruct();
+      test_pmr_moveAssignOther();
+      test_pmr_moveAssignSame();
+      test_pmr_spliceOther();
+      test_pmr_copyAssign();
+      test_pmr_swap();
+#endif // __cpp_lib_memory_resource
+
+      // Constant evaluation
+#ifdef LIST_HAS_CONSTEXPR
+      test_constexpr_pushBack();
+      test_constexpr_edit();
+      test_constexpr_copy();
+#endif // LIST_HAS_CONSTEXPR
+
+      // Node layout
+      test_layout_linksFirst();
+      test_layout_payloadFirst();
+      test_layout_outOfLine();
+      test_layout_outOfLineSpy();
 
       report("List");
    }
@@ -582,6 +695,175 @@ public:
       teardownStandardFixture(l);
    }
 
+   // an empty list costs only itself
+   void test_memoryUsage_empty()
+   {  // setup
+      custom::list<Spy> l;
+      // exercise
+      custom::list_memory m = l.memory_usage();
+      // verify
+      assertUnit(m.list_bytes == sizeof(l));
+      assertUnit(m.node_bytes == 0);
+      assertUnit(m.payload_bytes == 0);
+      assertUnit(m.link_bytes == 0);
+      assertUnit(m.slack_bytes == 0);
+      assertUnit(m.total() == sizeof(l));
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // each node is its payload and two links
+   void test_memoryUsage_three()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      Spy::reset();
+      // exercise
+      custom::list_memory m = l.memory_usage();
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(m.node_bytes == 3 * sizeof(custom::list<Spy>::Node));
+      assertUnit(m.payload_bytes == 3 * sizeof(Spy));
+      assertUnit(m.link_bytes >= 3 * 2 * sizeof(void *));
+      assertUnit(m.node_bytes == m.payload_bytes + m.link_bytes);
+      assertUnit(m.slack_bytes == 0);   // std::allocator does not say
+      assertUnit(m.total() == sizeof(l) + m.node_bytes);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // an out-of-line payload is a block of its own, beside the links
+   void test_memoryUsage_outOfLine()
+   {  // setup
+      typedef custom::list<OutOfLineSpy> List;
+      List l;
+      for (int i = 0; i < 4; i++)
+         l.push_back(OutOfLineSpy(i));
+      // exercise
+      custom::list_memory m = l.memory_usage();
+      // verify
+      assertUnit(m.node_bytes == 4 * (sizeof(List::Node) + sizeof(OutOfLineSpy)));
+      assertUnit(m.payload_bytes == 4 * sizeof(OutOfLineSpy));
+      assertUnit(m.link_bytes == 4 * 3 * sizeof(void *));
+   }  // teardown
+
+   /***************************************
+    * STATS
+    ***************************************/
+
+   // the default policy takes no room in the list
+   void test_stats_noneIsFree()
+   {  // setup
+      struct Members
+      {
+         std::allocator<int> alloc;
+         size_t numElements;
+         void * pHead;
+         void * pTail;
+         bool backgroundClear;
+      };
+      // exercise
+      custom::list<int> l;
+      // verify
+      assertUnit(std::is_empty<custom::no_stats>::value);
+      assertUnit(sizeof(l) == sizeof(Members));
+   }  // teardown
+
+   // allocations, frees and the links they rewrite
+   void test_stats_nodes()
+   {  // setup
+      custom::list<int, std::allocator<int>, custom::counting_stats> l;
+      // exercise
+      l.push_back(1);   // no links
+      l.push_back(2);   // 1 <-> 2
+      l.push_front(0);  // 0 <-> 1
+      l.pop_back();     // 1 -> NULL
+      // verify
+      assertUnit(l.stats().allocations == 3);
+      assertUnit(l.stats().frees == 1);
+      assertUnit(l.stats().relinks == 5);
+      assertUnit(l.stats().increments == 0);
+      assertUnit(l.stats().walks == 0);
+   }  // teardown
+
+   // iterators count every step, either way
+   void test_stats_increments()
+   {  // setup
+      custom::list<int, std::allocator<int>, custom::counting_stats> l;
+      for (int i = 0; i < 5; i++)
+         l.push_back(i);
+      // exercise
+      int sum = 0;
+      for (int value : l)
+         sum += value;
+      auto it = l.cend();
+      --it;
+      it--;
+      // verify
+      assertUnit(sum == 10);
+      assertUnit(l.stats().increments == 5 + 2);
+      assertUnit(l.stats().walks == 0);
+   }  // teardown
+
+   // operations that walk the list themselves say how far
+   void test_stats_walks()
+   {  // setup
+      custom::list<int, std::allocator<int>, custom::counting_stats> l;
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      l.stats().reset();
+      // exercise
+      l.remove_if([](int value) { return value % 2 == 1; });   // walks 10
+      l.reverse();                                             // walks 5
+      l.clear();                                               // walks 5
+      // verify
+      assertUnit(l.stats().walks == 3);
+      assertUnit(l.stats().walked == 20);
+      assertUnit(l.stats().longest_walk == 10);
+      assertUnit(l.stats().frees == 10);
+      assertUnit(l.stats().increments == 0);
+   }  // teardown
+
+   // reaching item i from begin() each time shows up as n^2 / 2 steps
+   void test_stats_quadratic()
+   {  // setup
+      const int num = 100;
+      custom::list<int, std::allocator<int>, custom::counting_stats> l;
+      for (int i = 0; i < num; i++)
+         l.push_back(i);
+      // exercise
+      int sum = 0;
+      for (int i = 0; i < num; i++)
+      {
+         auto it = l.begin();
+         for (int j = 0; j < i; j++)
+            ++it;
+         sum += *it;
+      }
+      // verify
+      assertUnit(sum == num * (num - 1) / 2);
+      assertUnit(l.stats().increments == (size_t)(num * (num - 1) / 2));
+   }  // teardown
+
+   // a copy starts its own count
+   void test_stats_notCopied()
+   {  // setup
+      typedef custom::list<int, std::allocator<int>, custom::counting_stats> List;
+      List l;
+      for (int i = 0; i < 4; i++)
+         l.push_back(i);
+      // exercise
+      List copy(l);
+      // verify
+      assertUnit(l.stats().allocations == 4);
+      assertUnit(copy.stats().allocations == 4);
+      assertUnit(copy.stats().relinks == 1 + 2 * 3 + 2);
+      assertUnit(copy.size() == 4);
+   }  // teardown
+
 
    /***************************************
     * ASSIGN
@@ -2509,6 +2791,1430 @@ public:
       teardownStandardFixture(l);
    }
 
+   // decrement from end() lands on the tail
+   void test_iterator_decrement_end()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                                    it = NULL
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      custom::list<Spy>::iterator it = l.end();
+      Spy::reset();
+      // exercise
+      --it;
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                           it
+      assertUnit(it.p == l.pTail);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // decrement from the middle follows pPrev
+   void test_iterator_decrement_standardMiddle()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                  it
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      custom::list<Spy>::iterator it;
+      it.p = l.pHead->pNext;
+      Spy::reset();
+      // exercise
+      custom::list<Spy>::iterator itOld = it--;
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //         it      itOld
+      assertUnit(it.p == l.pHead);
+      assertUnit(itOld.p == l.pHead->pNext);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // walk a const list with a const_iterator
+   void test_constIterator_standard()
+   {  // setup
+      custom::list<int> l;
+      setupStandardFixture(l);
+      const custom::list<int> & lConst = l;
+      int values[3] = { 0, 0, 0 };
+      int num = 0;
+      // exercise
+      for (custom::list<int>::const_iterator it = lConst.begin(); it != lConst.end(); ++it)
+         values[num++] = *it;
+      // verify
+      assertUnit(num == 3);
+      assertUnit(values[0] == 11);
+      assertUnit(values[1] == 26);
+      assertUnit(values[2] == 31);
+      custom::list<int>::const_iterator itConst = l.begin();   // from a non-const iterator
+      assertUnit(itConst == l.cbegin());
+      assertUnit(*--l.cend() == 31);
+   }  // teardown
+
+   // walk the standard fixture backwards
+   void test_reverseIterator_standard()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      int values[3] = { 0, 0, 0 };
+      int num = 0;
+      // exercise
+      for (custom::list<int>::reverse_iterator it = l.rbegin(); it != l.rend(); ++it)
+         values[num++] = *it;
+      // verify
+      assertUnit(num == 3);
+      assertUnit(values[0] == 31);
+      assertUnit(values[1] == 26);
+      assertUnit(values[2] == 11);
+      const custom::list<int> & lConst = l;
+      assertUnit(*lConst.rbegin() == 31);
+   }  // teardown
+
+   // a reverse walk of an empty list does nothing
+   void test_reverseIterator_empty()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      bool same = l.rbegin() == l.rend();
+      // verify
+      assertUnit(same);
+      assertUnit(l.empty());
+   }  // teardown
+
+   // the standard algorithms work on the list directly
+   void test_iterator_algorithms()
+   {  // setup
+      static_assert(std::is_same<std::iterator_traits<custom::list<int>::iterator>::iterator_category,
+                                 std::bidirectional_iterator_tag>::value,
+                    "list::iterator must be bidirectional");
+      static_assert(std::is_same<std::iterator_traits<custom::list<int>::const_iterator>::reference,
+                                 const int &>::value,
+                    "list::const_iterator must be read-only");
+      custom::list<int> l;
+      setupStandardFixture(l);
+      // exercise
+      custom::list<int>::iterator itFind = std::find(l.begin(), l.end(), 26);
+      int sum = std::accumulate(l.cbegin(), l.cend(), 0);
+      std::ptrdiff_t distance = std::distance(l.begin(), l.end());
+      custom::list<int>::reverse_iterator itLast = std::find(l.rbegin(), l.rend(), 11);
+      // verify
+      assertUnit(itFind != l.end());
+      assertUnit(itFind.p == l.pHead->pNext);
+      assertUnit(sum == 11 + 26 + 31);
+      assertUnit(distance == 3);
+      assertUnit(&*itLast == &l.pHead->data);
+      assertUnit(std::find(l.begin(), l.end(), 99) == l.end());
+   }  // teardown
+
+   /***************************************
+    * APPEND
+    ***************************************/
+
+   // appending an empty range changes nothing
+   void test_appendRange_empty()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      std::vector<Spy> v;
+      Spy::reset();
+      // exercise
+      l.append_range(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // append a range onto an empty list to make the standard fixture
+   void test_appendRange_ontoEmpty()
+   {  // setup
+      custom::list<Spy> l;
+      std::vector<Spy> v{ Spy(11), Spy(26), Spy(31) };
+      Spy::reset();
+      // exercise
+      l.append_range(v.begin(), v.end());
+      // verify
+      assertUnit(Spy::numCopy() == 3);       // copy-construct [11][26][31]
+      assertUnit(Spy::numAlloc() == 3);      // allocate [11][26][31]
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // append a range after the items already there
+   void test_appendRange_ontoStandard()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::Node * pOldTail = l.pTail;
+      int values[] = { 42, 43 };
+      // exercise
+      l.append_range(values, values + 2);
+      // verify
+      //        pHead                               pTail
+      //       +----+   +----+   +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 | - | 42 | - | 43 |
+      //       +----+   +----+   +----+   +----+   +----+
+      assertUnit(l.numElements == 5);
+      assertUnit(pOldTail->pNext != nullptr);
+      if (pOldTail->pNext)
+      {
+         assertUnit(pOldTail->pNext->data == 42);
+         assertUnit(pOldTail->pNext->pPrev == pOldTail);
+         assertUnit(pOldTail->pNext->pNext == l.pTail);
+      }
+      assertUnit(l.pTail->data == 43);
+      assertUnit(l.pTail->pNext == nullptr);
+      assertUnit(l.pTail->pPrev->data == 42);
+   }  // teardown
+
+   // push_back_n calls the generator once per new item
+   void test_pushBackN_standard()
+   {  // setup
+      custom::list<int> l;
+      l.push_back(1);
+      int next = 10;
+      // exercise
+      l.push_back_n(4, [&]() { return next++; });
+      // verify
+      assertUnit(l.numElements == 5);
+      assertUnit(next == 14);
+      int expected[] = { 1, 10, 11, 12, 13 };
+      int i = 0;
+      bool same = true;
+      for (custom::list<int>::iterator it = l.begin(); it != l.end(); ++it)
+         same = same && i < 5 && *it == expected[i++];
+      assertUnit(same);
+      assertUnit(i == 5);
+      assertUnit(l.pTail->data == 13);
+   }  // teardown
+
+   // a generator that throws part way leaves the list as it was
+   void test_pushBackN_throws()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      int num = 0;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.push_back_n(5, [&]() -> int
+         {
+            if (num == 3)
+               throw "ERROR: out of values";
+            return num++;
+         });
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertStandardFixture(l);
+   }  // teardown
+
+   /***************************************
+    * REMOVE MATCHING
+    ***************************************/
+
+   // remove from an empty list
+   void test_remove_empty()
+   {  // setup
+      custom::list<Spy> l;
+      Spy s(26);
+      Spy::reset();
+      // exercise
+      size_t num = l.remove(s);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // remove the middle item of the standard fixture
+   void test_remove_standardMiddle()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      Spy s(26);
+      Spy::reset();
+      // exercise
+      size_t num = l.remove(s);
+      // verify
+      assertUnit(num == 1);
+      assertUnit(Spy::numEquals() == 3);      // compare [11][26][31]
+      assertUnit(Spy::numDestructor() == 1);  // destroy [26]
+      assertUnit(Spy::numDelete() == 1);      // delete [26]
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      //        pHead    pTail
+      //       +----+   +----+
+      //       | 11 | - | 31 |
+      //       +----+   +----+
+      assertUnit(l.numElements == 2);
+      assertUnit(l.pHead != nullptr);
+      assertUnit(l.pTail != nullptr);
+      if (l.pHead && l.pTail)
+      {
+         assertUnit(l.pHead->data == Spy(11));
+         assertUnit(l.pHead->pPrev == nullptr);
+         assertUnit(l.pHead->pNext == l.pTail);
+         assertUnit(l.pTail->data == Spy(31));
+         assertUnit(l.pTail->pPrev == l.pHead);
+         assertUnit(l.pTail->pNext == nullptr);
+      }
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // remove items at both ends, leaving only the middle
+   void test_remove_standardEnds()
+   {  // setup
+      //       +----+   +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 | - | 11 |
+      //       +----+   +----+   +----+   +----+
+      custom::list<Spy> l;
+      l.push_back(Spy(11));
+      l.push_back(Spy(26));
+      l.push_back(Spy(31));
+      l.push_back(Spy(11));
+      Spy s(11);
+      Spy::reset();
+      // exercise
+      size_t num = l.remove(s);
+      num += l.remove(Spy(31));
+      // verify
+      assertUnit(num == 3);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      //       pHead
+      //       pTail
+      //       +----+
+      //       | 26 |
+      //       +----+
+      assertUnit(l.numElements == 1);
+      assertUnit(l.pHead != nullptr);
+      assertUnit(l.pHead == l.pTail);
+      if (l.pHead)
+      {
+         assertUnit(l.pHead->data == Spy(26));
+         assertUnit(l.pHead->pPrev == nullptr);
+         assertUnit(l.pHead->pNext == nullptr);
+      }
+   }  // teardown
+
+   // remove something that is not there
+   void test_remove_missing()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      Spy s(99);
+      Spy::reset();
+      // exercise
+      size_t num = l.remove(s);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(Spy::numEquals() == 3);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numDelete() == 0);
+      assertStandardFixture(l);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // remove every item
+   void test_removeIf_all()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      Spy::reset();
+      // exercise
+      size_t num = l.remove_if([](const Spy & s) { return !s.empty(); });
+      // verify
+      assertUnit(num == 3);
+      assertUnit(Spy::numDestructor() == 3);
+      assertUnit(Spy::numDelete() == 3);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // a predicate that throws part of the way through
+   void test_removeIf_throws()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      Spy::reset();
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.remove_if([](const Spy & s)
+         {
+            if (s.get() == 31)
+               throw "stop";
+            return s.get() == 11;
+         });
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(Spy::numDestructor() == 1);  // [11] was already removed
+      //        pHead    pTail
+      //       +----+   +----+
+      //       | 26 | - | 31 |
+      //       +----+   +----+
+      assertUnit(l.numElements == 2);
+      assertUnit(l.pHead != nullptr && l.pHead->data == Spy(26));
+      assertUnit(l.pTail != nullptr && l.pTail->data == Spy(31));
+      if (l.pHead)
+         assertUnit(l.pHead->pPrev == nullptr);
+   }  // teardown
+
+   // unique on an empty list
+   void test_unique_empty()
+   {  // setup
+      custom::list<Spy> l;
+      Spy::reset();
+      // exercise
+      size_t num = l.unique();
+      // verify
+      assertUnit(num == 0);
+      assertUnit(Spy::numEquals() == 0);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // collapse runs of equal items
+   void test_unique_runs()
+   {  // setup
+      //       +----+   +----+   +----+   +----+   +----+   +----+   +----+
+      //       | 11 | - | 11 | - | 26 | - | 26 | - | 26 | - | 31 | - | 31 |
+      //       +----+   +----+   +----+   +----+   +----+   +----+   +----+
+      custom::list<Spy> l;
+      int values[] = { 11, 11, 26, 26, 26, 31, 31 };
+      for (int value : values)
+         l.push_back(Spy(value));
+      Spy::reset();
+      // exercise
+      size_t num = l.unique();
+      // verify
+      assertUnit(num == 4);
+      assertUnit(Spy::numEquals() == 6);
+      assertUnit(Spy::numDestructor() == 4);
+      assertUnit(Spy::numDelete() == 4);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      assertStandardFixture(l);
+   }  // teardown
+
+   // collapse with a custom predicate: close enough counts as equal
+   void test_unique_predicate()
+   {  // setup
+      custom::list<int> l;
+      int values[] = { 11, 12, 13, 26, 29, 31, 40 };
+      for (int value : values)
+         l.push_back(value);
+      // exercise
+      size_t num = l.unique([](int kept, int next) { return next - kept < 5; });
+      // verify
+      //    +----+   +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 | - | 40 |
+      //    +----+   +----+   +----+   +----+
+      assertUnit(num == 3);
+      assertUnit(l.numElements == 4);
+      int expected[] = { 11, 26, 31, 40 };
+      int i = 0;
+      for (auto p = l.pHead; p && i < 4; p = p->pNext)
+         assertUnit(p->data == expected[i++]);
+      assertUnit(i == 4);
+      assertUnit(l.pTail != nullptr && l.pTail->data == 40);
+   }  // teardown
+
+   /***************************************
+    * REORDER
+    ***************************************/
+
+   // swap an empty list with the standard fixture
+   void test_swap_emptyToStandard()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<Spy> lLHS;
+      custom::list<Spy> lRHS;
+      setupStandardFixture(lRHS);
+      Spy::reset();
+      // exercise
+      lLHS.swap(lRHS);
+      // verify
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numSwap() == 0);
+      assertStandardFixture(lLHS);
+      assertEmptyFixture(lRHS);
+      // teardown
+      teardownStandardFixture(lLHS);
+   }
+
+   // swap two non-empty lists: the nodes change owners, not places
+   void test_swap_standardToStandard()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+         +----+
+      //       | 11 | - | 26 | - | 31 |         | 99 |
+      //       +----+   +----+   +----+         +----+
+      custom::list<Spy> lLHS;
+      setupStandardFixture(lLHS);
+      custom::list<Spy> lRHS;
+      lRHS.push_back(Spy(99));
+      custom::list<Spy>::Node * pHeadLHS = lLHS.pHead;
+      custom::list<Spy>::Node * pHeadRHS = lRHS.pHead;
+      Spy::reset();
+      // exercise
+      lLHS.swap(lRHS);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(lLHS.pHead == pHeadRHS);
+      assertUnit(lRHS.pHead == pHeadLHS);
+      assertUnit(lLHS.numElements == 1);
+      assertUnit(lLHS.pTail == lLHS.pHead);
+      assertStandardFixture(lRHS);
+      // teardown
+      teardownStandardFixture(lRHS);
+   }
+
+   // the non-member swap is the same O(1) exchange
+   void test_swap_nonMember()
+   {  // setup
+      custom::list<Spy> lLHS;
+      setupStandardFixture(lLHS);
+      custom::list<Spy> lRHS;
+      Spy::reset();
+      // exercise
+      custom::swap(lLHS, lRHS);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertEmptyFixture(lLHS);
+      assertStandardFixture(lRHS);
+      // teardown
+      teardownStandardFixture(lRHS);
+   }
+
+   // move-assign the standard fixture over a non-empty list
+   void test_assignMove_standardToStandard()
+   {  // setup
+      custom::list<Spy> lSrc;
+      setupStandardFixture(lSrc);
+      custom::list<Spy> lDest;
+      lDest.push_back(Spy(99));
+      Spy::reset();
+      // exercise
+      lDest = std::move(lSrc);
+      // verify
+      assertUnit(Spy::numDestructor() == 1);   // destroy [99]
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertEmptyFixture(lSrc);
+      assertStandardFixture(lDest);
+      // teardown
+      teardownStandardFixture(lDest);
+   }
+
+   // reverse an empty list
+   void test_reverse_empty()
+   {  // setup
+      custom::list<Spy> l;
+      Spy::reset();
+      // exercise
+      l.reverse();
+      // verify
+      assertUnit(Spy::numDestructor() == 0);
+      assertEmptyFixture(l);
+   }  // teardown
+
+   // reverse a list of one item
+   void test_reverse_one()
+   {  // setup
+      custom::list<Spy> l;
+      l.push_back(Spy(11));
+      custom::list<Spy>::Node * p = l.pHead;
+      Spy::reset();
+      // exercise
+      l.reverse();
+      // verify
+      assertUnit(l.pHead == p);
+      assertUnit(l.pTail == p);
+      assertUnit(p->pNext == nullptr);
+      assertUnit(p->pPrev == nullptr);
+      assertUnit(l.numElements == 1);
+   }  // teardown
+
+   // reverse the standard fixture: the nodes stay put, the links flip
+   void test_reverse_standard()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      custom::list<Spy>::Node * p11 = l.pHead;
+      custom::list<Spy>::Node * p26 = l.pHead->pNext;
+      custom::list<Spy>::Node * p31 = l.pTail;
+      Spy::reset();
+      // exercise
+      l.reverse();
+      // verify
+      assertUnit(Spy::numDefault() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numAssignMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numSwap() == 0);
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 31 | - | 26 | - | 11 |
+      //       +----+   +----+   +----+
+      assertUnit(l.numElements == 3);
+      assertUnit(l.pHead == p31);
+      assertUnit(l.pTail == p11);
+      assertUnit(p31->pPrev == nullptr);
+      assertUnit(p31->pNext == p26);
+      assertUnit(p26->pPrev == p31);
+      assertUnit(p26->pNext == p11);
+      assertUnit(p11->pPrev == p26);
+      assertUnit(p11->pNext == nullptr);
+      // teardown
+      l.reverse();
+      assertStandardFixture(l);
+      teardownStandardFixture(l);
+   }
+
+   // split the standard fixture in the middle
+   void test_splitAt_standardMiddle()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                  it
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      custom::list<Spy>::Node * p11 = l.pHead;
+      custom::list<Spy>::Node * p26 = l.pHead->pNext;
+      custom::list<Spy>::Node * p31 = l.pTail;
+      custom::list<Spy>::iterator it = l.begin();
+      ++it;
+      Spy::reset();
+      // exercise
+      custom::list<Spy> lTail = l.split_at(it);
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //        pHead    pTail      pHead    pTail
+      //       +----+              +----+   +----+
+      //       | 11 |              | 26 | - | 31 |
+      //       +----+              +----+   +----+
+      assertUnit(l.numElements == 1);
+      assertUnit(l.pHead == p11);
+      assertUnit(l.pTail == p11);
+      assertUnit(p11->pNext == nullptr);
+      assertUnit(lTail.numElements == 2);
+      assertUnit(lTail.pHead == p26);
+      assertUnit(lTail.pTail == p31);
+      assertUnit(p26->pPrev == nullptr);
+      assertUnit(p26->pNext == p31);
+   }  // teardown
+
+   // splitting at begin() moves everything
+   void test_splitAt_begin()
+   {  // setup
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      Spy::reset();
+      // exercise
+      custom::list<Spy> lTail = l.split_at(l.begin());
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertEmptyFixture(l);
+      assertStandardFixture(lTail);
+      // teardown
+      teardownStandardFixture(lTail);
+   }
+
+   // splitting at end() moves nothing
+   void test_splitAt_end()
+   {  // setup
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      Spy::reset();
+      // exercise
+      custom::list<Spy> lTail = l.split_at(l.end());
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      assertStandardFixture(l);
+      assertEmptyFixture(lTail);
+      // teardown
+      teardownStandardFixture(l);
+   }
+
+   // the caller supplies the size of the tail
+   void test_splitAt_count()
+   {  // setup
+      //        pHead             pTail
+      //       +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 |
+      //       +----+   +----+   +----+
+      //                           it
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<int>::iterator it = --l.end();
+      // exercise
+      custom::list<int> lTail = l.split_at(it, 1);
+      // verify
+      assertUnit(l.numElements == 2);
+      assertUnit(l.pTail->data == 26);
+      assertUnit(l.pTail->pNext == nullptr);
+      assertUnit(lTail.numElements == 1);
+      assertUnit(lTail.pHead == lTail.pTail);
+      assertUnit(lTail.pHead->data == 31);
+      assertUnit(lTail.pHead->pPrev == nullptr);
+   }  // teardown
+
+   // split an odd count in half: the extra item stays in front
+   void test_splitHalf_odd()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 7; i++)
+         l.push_back(i);
+      // exercise
+      custom::list<int> lBack = l.split_half();
+      // verify
+      assertUnit(l.size() == 4);
+      assertUnit(lBack.size() == 3);
+      assertUnit(l.back() == 3);
+      assertUnit(lBack.front() == 4);
+      assertUnit(lBack.back() == 6);
+      assertUnit(std::distance(l.begin(), l.end()) == 4);
+      assertUnit(std::distance(lBack.begin(), lBack.end()) == 3);
+   }  // teardown
+
+   // halves of halves cover the list exactly once
+   void test_splitHalf_recursive()
+   {  // setup
+      custom::list<int> l;
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      // exercise
+      custom::list<int> lBack  = l.split_half();
+      custom::list<int> lFront = std::move(l);
+      custom::list<int> lQuarter = lBack.split_half();
+      // verify
+      assertUnit(lFront.size() == 50);
+      assertUnit(lBack.size() == 25);
+      assertUnit(lQuarter.size() == 25);
+      assertUnit(std::accumulate(lFront.begin(), lFront.end(), 0) == 1225);
+      assertUnit(std::accumulate(lBack.begin(), lBack.end(), 0) == 1550);
+      assertUnit(std::accumulate(lQuarter.begin(), lQuarter.end(), 0) == 2175);
+      custom::list<int> lEmpty;
+      assertUnit(lEmpty.split_half().empty());
+   }  // teardown
+
+   // splice onto the end of the standard fixture
+   void test_splice_end()
+   {  // setup
+      //        pHead             pTail      pHead    pTail
+      //       +----+   +----+   +----+     +----+   +----+
+      //       | 11 | - | 26 | - | 31 |     | 40 | - | 50 |
+      //       +----+   +----+   +----+     +----+   +----+
+      custom::list<Spy> l;
+      setupStandardFixture(l);
+      custom::list<Spy> lSrc{ Spy(40), Spy(50) };
+      custom::list<Spy>::Node * p31 = l.pTail;
+      custom::list<Spy>::Node * p40 = lSrc.pHead;
+      custom::list<Spy>::Node * p50 = lSrc.pTail;
+      Spy::reset();
+      // exercise
+      l.splice(l.end(), lSrc);
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(Spy::numDestructor() == 0);
+      //        pHead                                 pTail
+      //       +----+   +----+   +----+   +----+   +----+
+      //       | 11 | - | 26 | - | 31 | - | 40 | - | 50 |
+      //       +----+   +----+   +----+   +----+   +----+
+      assertUnit(l.numElements == 5);
+      assertUnit(p31->pNext == p40);
+      assertUnit(p40->pPrev == p31);
+      assertUnit(l.pTail == p50);
+      assertEmptyFixture(lSrc);
+   }  // teardown
+
+   // splice into the middle and at the front
+   void test_splice_middle()
+   {  // setup
+      custom::list<int> l{ 1, 4 };
+      custom::list<int> lMiddle{ 2, 3 };
+      custom::list<int> lFront{ 0 };
+      // exercise
+      l.splice(++l.begin(), lMiddle);
+      l.splice(l.begin(), lFront);
+      // verify
+      assertUnit(l.size() == 5);
+      int value = 0;
+      for (int item : l)
+         assertUnit(item == value++);
+      value = 4;
+      for (auto it = l.rbegin(); it != l.rend(); ++it)
+         assertUnit(*it == value--);
+      assertUnit(l.pHead->pPrev == nullptr);
+      assertUnit(lMiddle.empty());
+      assertUnit(lFront.empty());
+   }  // teardown
+
+   // splicing an empty list, or a list into itself, changes nothing
+   void test_splice_empty()
+   {  // setup
+      custom::list<int> l{ 1, 2 };
+      custom::list<int> lEmpty;
+      // exercise
+      l.splice(l.begin(), lEmpty);
+      l.splice(l.end(), l);
+      lEmpty.splice(lEmpty.end(), l);
+      // verify
+      assertUnit(l.empty());
+      assertUnit(lEmpty.size() == 2);
+      assertUnit(lEmpty.front() == 1);
+      assertUnit(lEmpty.back() == 2);
+   }  // teardown
+
+#ifdef __cpp_lib_memory_resource
+   /***************************************
+    * PMR
+    ***************************************/
+
+   // every node comes from the resource, none from the heap
+   void test_pmr_monotonic()
+   {  // setup
+      alignas(std::max_align_t) unsigned char buffer[4096];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::list<int> l(&resource);
+      // exercise
+      for (int i = 0; i < 100; i++)
+         l.push_back(i);
+      // verify
+      assertUnit(l.size() == 100);
+      assertUnit(l.get_allocator().resource() == &resource);
+      assertUnit(isInside(l, buffer, sizeof(buffer)));
+   }  // teardown
+
+   // the moved-to list keeps the nodes and the resource they came from
+   void test_pmr_moveConstruct()
+   {  // setup
+      alignas(std::max_align_t) unsigned char buffer[1024];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::list<int> lSrc(&resource);
+      setupStandardFixture(lSrc);
+      custom::pmr::list<int>::Node * pHead = lSrc.pHead;
+      // exercise
+      custom::pmr::list<int> lDest(std::move(lSrc));
+      // verify
+      assertUnit(lDest.get_allocator().resource() == &resource);
+      assertUnit(lDest.pHead == pHead);
+      assertUnit(lDest.size() == 3);
+      assertUnit(lSrc.empty());
+   }  // teardown
+
+   // moving onto another resource moves each item into a new node there
+   void test_pmr_moveConstructOther()
+   {  // setup
+      alignas(std::max_align_t) unsigned char bufferSrc[1024];
+      alignas(std::max_align_t) unsigned char bufferDest[1024];
+      std::pmr::monotonic_buffer_resource resourceSrc(bufferSrc, sizeof(bufferSrc),
+                                                      std::pmr::null_memory_resource());
+      std::pmr::monotonic_buffer_resource resourceDest(bufferDest, sizeof(bufferDest),
+                                                       std::pmr::null_memory_resource());
+      custom::pmr::list<int> lSrc(&resourceSrc);
+      setupStandardFixture(lSrc);
+      // exercise
+      custom::pmr::list<int> lDest(std::move(lSrc), &resourceDest);
+      // verify
+      assertUnit(lDest.get_allocator().resource() == &resourceDest);
+      assertUnit(isInside(lDest, bufferDest, sizeof(bufferDest)));
+      assertUnit(lDest.size() == 3);
+      assertUnit(lDest.front() == 11);
+      assertUnit(lDest.back() == 31);
+      assertUnit(lSrc.empty());
+   }  // teardown
+
+   // a copy does not inherit the resource, just like std::pmr::list
+   void test_pmr_copyConstruct()
+   {  // setup
+      alignas(std::max_align_t) unsigned char buffer[1024];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::list<int> lSrc(&resource);
+      setupStandardFixture(lSrc);
+      // exercise
+      custom::pmr::list<int> lDest(lSrc);
+      // verify
+      assertUnit(lDest.get_allocator().resource() == std::pmr::get_default_resource());
+      assertUnit(!isInside(lDest, buffer, sizeof(buffer)));
+      assertStandardFixture(lDest);
+      assertStandardFixture(lSrc);
+   }  // teardown
+
+   // move-assign across resources: the left side keeps its own
+   void test_pmr_moveAssignOther()
+   {  // setup
+      alignas(std::max_align_t) unsigned char bufferSrc[1024];
+      alignas(std::max_align_t) unsigned char bufferDest[1024];
+      std::pmr::monotonic_buffer_resource resourceSrc(bufferSrc, sizeof(bufferSrc),
+                                                      std::pmr::null_memory_resource());
+      std::pmr::monotonic_buffer_resource resourceDest(bufferDest, sizeof(bufferDest),
+                                                       std::pmr::null_memory_resource());
+      custom::pmr::list<int> lSrc(&resourceSrc);
+      setupStandardFixture(lSrc);
+      custom::pmr::list<int> lDest(&resourceDest);
+      lDest.push_back(99);
+      // exercise
+      lDest = std::move(lSrc);
+      // verify
+      assertUnit(lDest.get_allocator().resource() == &resourceDest);
+      assertUnit(isInside(lDest, bufferDest, sizeof(bufferDest)));
+      assertStandardFixture(lDest);
+      assertUnit(lSrc.empty());
+   }  // teardown
+
+   // splice across resources: the items are moved into our own nodes
+   void test_pmr_spliceOther()
+   {  // setup
+      alignas(std::max_align_t) unsigned char bufferSrc[1024];
+      alignas(std::max_align_t) unsigned char bufferDest[1024];
+      std::pmr::monotonic_buffer_resource resourceSrc(bufferSrc, sizeof(bufferSrc),
+                                                      std::pmr::null_memory_resource());
+      std::pmr::monotonic_buffer_resource resourceDest(bufferDest, sizeof(bufferDest),
+                                                       std::pmr::null_memory_resource());
+      custom::pmr::list<int> lSrc(&resourceSrc);
+      setupStandardFixture(lSrc);
+      custom::pmr::list<int> lDest(&resourceDest);
+      // exercise
+      lDest.splice(lDest.end(), lSrc);
+      // verify
+      assertUnit(isInside(lDest, bufferDest, sizeof(bufferDest)));
+      assertStandardFixture(lDest);
+      assertUnit(lSrc.empty());
+   }  // teardown
+
+   // move-assign within one resource just takes the nodes
+   void test_pmr_moveAssignSame()
+   {  // setup
+      alignas(std::max_align_t) unsigned char buffer[1024];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::list<int> lSrc(&resource);
+      setupStandardFixture(lSrc);
+      custom::pmr::list<int>::Node * pHead = lSrc.pHead;
+      custom::pmr::list<int> lDest(&resource);
+      // exercise
+      lDest = std::move(lSrc);
+      // verify
+      assertUnit(lDest.pHead == pHead);
+      assertStandardFixture(lDest);
+      assertUnit(lSrc.empty());
+   }  // teardown
+
+   // copy-assign keeps the left side's resource
+   void test_pmr_copyAssign()
+   {  // setup
+      alignas(std::max_align_t) unsigned char buffer[1024];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      custom::pmr::list<int> lDest(&resource);
+      // exercise
+      lDest = lSrc;
+      // verify
+      assertUnit(lDest.get_allocator().resource() == &resource);
+      assertUnit(isInside(lDest, buffer, sizeof(buffer)));
+      assertStandardFixture(lDest);
+   }  // teardown
+
+   // swap exchanges the nodes but each list keeps its resource
+   void test_pmr_swap()
+   {  // setup
+      alignas(std::max_align_t) unsigned char buffer[1024];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      custom::pmr::list<int> lLHS(&resource);
+      setupStandardFixture(lLHS);
+      custom::pmr::list<int> lRHS(&resource);
+      // exercise
+      lLHS.swap(lRHS);
+      // verify
+      assertUnit(lLHS.empty());
+      assertStandardFixture(lRHS);
+      assertUnit(lLHS.get_allocator().resource() == &resource);
+      assertUnit(lRHS.get_allocator().resource() == &resource);
+   }  // teardown
+
+   // do all the nodes of the list live in the buffer?
+   template <class List>
+   bool isInside(const List & l, const unsigned char * buffer, size_t size)
+   {
+      for (auto p = l.pHead; p; p = p->pNext)
+      {
+         const unsigned char * pByte = reinterpret_cast<const unsigned char *>(p);
+         if (pByte < buffer || pByte >= buffer + size)
+            return false;
+      }
+      return true;
+   }
+#endif // __cpp_lib_memory_resource
+
+#ifdef LIST_HAS_CONSTEXPR
+   /***************************************
+    * CONSTEXPR
+    ***************************************/
+
+   // squares pushed into a list at compile time, baked into an array
+   static constexpr std::array<int, 5> constexprSquares()
+   {
+      custom::list<int> l;
+      for (int i = 1; i <= 5; i++)
+         l.push_back(i * i);
+      std::array<int, 5> table {};
+      size_t i = 0;
+      for (int value : l)
+         table[i++] = value;
+      return table;
+   }
+
+   // insert, remove, reverse and clear during constant evaluation
+   static constexpr int constexprEdit()
+   {
+      custom::list<int> l{ 1, 2, 3, 4, 5 };
+      l.insert(l.begin(), 0);                           // 0 1 2 3 4 5
+      l.remove_if([](int value) { return value % 2; }); // 0 2 4
+      l.reverse();                                      // 4 2 0
+      int digits = 0;
+      for (int value : l)
+         digits = digits * 10 + value;
+      l.clear();
+      return l.empty() ? digits : -1;
+   }
+
+   // copy, push_front and split during constant evaluation
+   static constexpr size_t constexprCopy()
+   {
+      custom::list<int> lSrc{ 1, 2, 3 };
+      custom::list<int> l(lSrc);
+      l.push_front(0);                                  // 0 1 2 3
+      custom::list<int> lBack = l.split_half();         // 0 1 | 2 3
+      return l.size() * 100 + lBack.size() * 10 + (size_t)lBack.back();
+   }
+
+   // a table built by the list is a compile-time constant
+   void test_constexpr_pushBack()
+   {  // setup
+      // exercise
+      constexpr std::array<int, 5> table = constexprSquares();
+      // verify
+      static_assert(table[0] == 1 && table[4] == 25, "built at compile time");
+      assertUnit(table[0] == 1);
+      assertUnit(table[1] == 4);
+      assertUnit(table[2] == 9);
+      assertUnit(table[3] == 16);
+      assertUnit(table[4] == 25);
+   }  // teardown
+
+   // editing a list at compile time
+   void test_constexpr_edit()
+   {  // setup
+      // exercise
+      constexpr int digits = constexprEdit();
+      // verify
+      static_assert(digits == 420, "edited at compile time");
+      assertUnit(digits == 420);
+   }  // teardown
+
+   // copying and splitting a list at compile time
+   void test_constexpr_copy()
+   {  // setup
+      // exercise
+      constexpr size_t code = constexprCopy();
+      // verify
+      static_assert(code == 223, "copied at compile time");
+      assertUnit(code == 223);
+   }  // teardown
+#endif // LIST_HAS_CONSTEXPR
+
+   /***************************************
+    * NODE LAYOUT
+    ***************************************/
+
+   // by default the links open the node, ahead of the payload
+   void test_layout_linksFirst()
+   {  // setup
+      custom::list<std::array<char, 256>> l;
+      // exercise
+      l.push_back(std::array<char, 256>());
+      // verify
+      auto * p = l.pHead;
+      assertUnit(static_cast<void *>(&p->pNext) == static_cast<void *>(p));
+      assertUnit(reinterpret_cast<char *>(&p->data) > reinterpret_cast<char *>(&p->pPrev));
+   }  // teardown
+
+   // a type can ask for the payload to come first
+   void test_layout_payloadFirst()
+   {  // setup
+      custom::list<PayloadFirstInt> l;
+      // exercise
+      l.push_back(PayloadFirstInt{ 7 });
+      l.push_back(PayloadFirstInt{ 8 });
+      // verify
+      auto * p = l.pHead;
+      assertUnit(static_cast<void *>(&p->data) == static_cast<void *>(p));
+      assertUnit(l.front().value == 7);
+      assertUnit(l.back().value == 8);
+   }  // teardown
+
+   // an out-of-line node holds only links and a reference
+   void test_layout_outOfLine()
+   {  // setup
+      typedef custom::list<OutOfLineSpy> List;
+      List l;
+      // exercise
+      for (int i = 0; i < 5; i++)
+         l.push_back(OutOfLineSpy(i));
+      l.insert(l.begin(), OutOfLineSpy(-1));
+      l.remove_if([](const OutOfLineSpy & s) { return s.get() % 2 == 0; });
+      // verify
+      //    +----+    +----+    +----+
+      //    | -1 | -- |  1 | -- |  3 |
+      //    +----+    +----+    +----+
+      assertUnit(sizeof(List::Node) == 3 * sizeof(void *));
+      assertUnit(l.size() == 3);
+      assertUnit(l.front().get() == -1);
+      assertUnit(l.back().get() == 3);
+      auto * p = l.pHead;
+      char * pNode = reinterpret_cast<char *>(p);
+      char * pData = reinterpret_cast<char *>(&p->data);
+      assertUnit(pData < pNode || pData >= pNode + sizeof(List::Node));
+   }  // teardown
+
+   // every out-of-line payload is freed with its node
+   void test_layout_outOfLineSpy()
+   {  // setup
+      Spy::reset();
+      {
+         custom::list<OutOfLineSpy> lSrc;
+         for (int i = 0; i < 6; i++)
+            lSrc.push_back(OutOfLineSpy(i));
+         // exercise
+         custom::list<OutOfLineSpy> lCopy(lSrc);
+         lSrc.remove_if([](const OutOfLineSpy & s) { return s.get() == 0; });
+         lCopy = lSrc;
+         lCopy.reverse();
+         lSrc.clear();
+         // verify
+         assertUnit(lCopy.size() == 5);
+         assertUnit(lCopy.front().get() == 5);
+         assertUnit(lCopy.back().get() == 1);
+      }
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+   }  // teardown
+
+   /***************************************
+    * SERIALIZE
+    ***************************************/
+
+   // save an empty list: just the header
+   void test_save_empty()
+   {  // setup
+      custom::list<int> l;
+      std::stringstream ss;
+      // exercise
+      l.save(ss);
+      // verify
+      std::string s = ss.str();
+      assertUnit(s.size() == 2 * sizeof(std::uint64_t));
+      std::uint64_t header[2] = { 99, 99 };
+      std::memcpy(header, s.data(), sizeof(header));
+      assertUnit(header[0] == 0);
+      assertUnit(header[1] == sizeof(int));
+      assertUnit(l.numElements == 0);
+   }  // teardown
+
+   // save a three element list: the header followed by the payloads
+   void test_save_standard()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::stringstream ss;
+      // exercise
+      l.save(ss);
+      // verify
+      std::string s = ss.str();
+      assertUnit(s.size() == 2 * sizeof(std::uint64_t) + 3 * sizeof(int));
+      std::uint64_t header[2] = { 99, 99 };
+      int payload[3] = { 0, 0, 0 };
+      std::memcpy(header, s.data(), sizeof(header));
+      std::memcpy(payload, s.data() + sizeof(header), sizeof(payload));
+      assertUnit(header[0] == 3);
+      assertUnit(header[1] == sizeof(int));
+      assertUnit(payload[0] == 11);
+      assertUnit(payload[1] == 26);
+      assertUnit(payload[2] == 31);
+      assertStandardFixture(l);
+   }  // teardown
+
+   // load an empty list
+   void test_load_empty()
+   {  // setup
+      custom::list<int> lSrc;
+      custom::list<int> lDest;
+      std::stringstream ss;
+      lSrc.save(ss);
+      // exercise
+      lDest.load(ss);
+      // verify
+      assertUnit(!ss.fail());
+      assertUnit(lDest.numElements == 0);
+      assertUnit(lDest.pHead == nullptr);
+      assertUnit(lDest.pTail == nullptr);
+   }  // teardown
+
+   // load a list large enough to span several blocks
+   void test_load_standard()
+   {  // setup
+      custom::list<int> lSrc;
+      for (int i = 0; i < 10000; i++)
+         lSrc.push_back(i);
+      custom::list<int> lDest;
+      std::stringstream ss;
+      lSrc.save(ss);
+      // exercise
+      lDest.load(ss);
+      // verify
+      assertUnit(!ss.fail());
+      assertUnit(lDest.numElements == 10000);
+      assertUnit(lDest.pHead != nullptr);
+      assertUnit(lDest.pTail != nullptr);
+      if (lDest.pHead && lDest.pTail)
+      {
+         assertUnit(lDest.pHead->pPrev == nullptr);
+         assertUnit(lDest.pTail->pNext == nullptr);
+         int value = 0;
+         bool inOrder = true;
+         for (auto p = lDest.pHead; p; p = p->pNext)
+            inOrder = inOrder && p->data == value++ && (p->pNext == nullptr || p->pNext->pPrev == p);
+         assertUnit(inOrder);
+         assertUnit(value == 10000);
+      }
+   }  // teardown
+
+   // load into a list that already has data: the old data is replaced
+   void test_load_replaces()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<int> lSrc;
+      setupStandardFixture(lSrc);
+      custom::list<int> lDest;
+      lDest.push_back(99);
+      lDest.push_back(98);
+      std::stringstream ss;
+      lSrc.save(ss);
+      // exercise
+      lDest.load(ss);
+      // verify
+      assertUnit(!ss.fail());
+      assertStandardFixture(lDest);
+      assertStandardFixture(lSrc);
+   }  // teardown
+
+   // load a stream written for a different element size
+   void test_load_badHeader()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      custom::list<double> lOther;
+      lOther.push_back(1.5);
+      std::stringstream ss;
+      lOther.save(ss);
+      // exercise
+      l.load(ss);
+      // verify
+      assertUnit(ss.fail());
+      assertStandardFixture(l);
+   }  // teardown
+
+   // load a stream that ends part of the way through the payloads
+   void test_load_truncated()
+   {  // setup
+      //    +----+   +----+   +----+
+      //    | 11 | - | 26 | - | 31 |
+      //    +----+   +----+   +----+
+      custom::list<int> l;
+      setupStandardFixture(l);
+      std::stringstream ssFull;
+      l.save(ssFull);
+      std::string s = ssFull.str();
+      std::stringstream ss(s.substr(0, s.size() - sizeof(int)));
+      // exercise
+      l.load(ss);
+      // verify
+      assertUnit(ss.fail());
+      assertStandardFixture(l);
+   }  // teardown
+
+   /****************************************************************
+    * Setup Standard Fixture
+    *        pHead             pTail
+    *       +----+   +----+   +----+
+    *       | 11 | - | 26 | - | 31 |
+    *       +----+   +----+   +----+
+    ****************************************************************/
+   template <class A>
+   void setupStandardFixture(custom::list<int, A>& l)
+   {
+      l.clear();
+      l.push_back(11);
+      l.push_back(26);
+      l.push_back(31);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture for a list of integers
+    ****************************************************************/
+   template <class A>
+   void assertStandardFixtureParameters(const custom::list<int, A>& l, int line, const char* function)
+   {
+      assertIndirect(l.numElements == 3);
+      assertIndirect(l.pHead != nullptr);
+      assertIndirect(l.pTail != nullptr);
+      if (l.pHead && l.pHead->pNext && l.pHead->pNext->pNext)
+      {
+         assertIndirect(l.pHead->data == 11);
+         assertIndirect(l.pHead->pPrev == nullptr);
+         assertIndirect(l.pHead->pNext->data == 26);
+         assertIndirect(l.pHead->pNext->pPrev == l.pHead);
+         assertIndirect(l.pHead->pNext->pNext->data == 31);
+         assertIndirect(l.pHead->pNext->pNext == l.pTail);
+         assertIndirect(l.pTail->pNext == nullptr);
+      }
+   }
+
    /****************************************************************
     * Setup Standard Fixture
     *        pHead             pTail
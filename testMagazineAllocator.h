@@ -0,0 +1,319 @@
+/***********************************************************************
+ * Header:
+ *    TEST MAGAZINE ALLOCATOR
+ * Summary:
+ *    Unit tests for magazine_allocator and its per-thread caches
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "magazineAllocator.h"  // class under test
+#include "list.h"               // the list that uses it
+#include "unitTest.h"           // unit test baseclass
+
+#include <cstdint>              // for std::uintptr_t
+#include <set>                  // for std::set
+#include <thread>               // for std::thread
+#include <vector>               // for std::vector
+
+// a type no other test allocates, so its pool's stats start at zero
+template <int N>
+struct StatsBlock
+{
+   char data[40 + N];
+};
+
+/***********************************************
+ * TEST MAGAZINE ALLOCATOR
+ * Unit tests for the magazine_allocator class
+ ***********************************************/
+class TestMagazineAllocator : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Allocate
+      test_allocate_reuse();
+      test_allocate_distinct();
+      test_allocate_aligned();
+      test_allocate_array();
+      test_rebind_equal();
+
+      // Threads
+      test_threads_crossFree();
+      test_threads_exitFlushes();
+
+      // Stats
+      test_stats_magazineOut();
+      test_stats_threadExits();
+      test_blockSize_padded();
+
+      // List
+      test_list_standard();
+      test_list_threads();
+
+      report("MagazineAllocator");
+   }
+
+   /***************************************
+    * ALLOCATE
+    ***************************************/
+
+   // a freed block is the next one handed out on this thread
+   void test_allocate_reuse()
+   {  // setup
+      custom::magazine_allocator<double> alloc;
+      double * p = alloc.allocate(1);
+      alloc.deallocate(p, 1);
+      // exercise
+      double * pAgain = alloc.allocate(1);
+      // verify
+      assertUnit(pAgain == p);
+      // teardown
+      alloc.deallocate(pAgain, 1);
+   }
+
+   // more than a magazine's worth of live blocks never overlap
+   void test_allocate_distinct()
+   {  // setup
+      typedef custom::magazine_allocator<std::int64_t> Alloc;
+      Alloc alloc;
+      const size_t num = Alloc::Pool::MAGAZINE_SIZE * 5 + 3;
+      std::vector<std::int64_t *> blocks;
+      // exercise
+      for (size_t i = 0; i < num; i++)
+      {
+         blocks.push_back(alloc.allocate(1));
+         *blocks.back() = (std::int64_t)i;
+      }
+      // verify
+      std::set<std::int64_t *> unique(blocks.begin(), blocks.end());
+      assertUnit(unique.size() == num);
+      bool intact = true;
+      for (size_t i = 0; i < num; i++)
+         intact = intact && *blocks[i] == (std::int64_t)i;
+      assertUnit(intact);
+      // teardown
+      for (std::int64_t * p : blocks)
+         alloc.deallocate(p, 1);
+   }
+
+   // blocks of an odd-sized type are still aligned for it
+   void test_allocate_aligned()
+   {  // setup
+      struct Odd { double d; char c; };
+      custom::magazine_allocator<Odd> alloc;
+      std::vector<Odd *> blocks;
+      // exercise
+      for (int i = 0; i < 100; i++)
+         blocks.push_back(alloc.allocate(1));
+      // verify
+      bool aligned = true;
+      for (Odd * p : blocks)
+         aligned = aligned && reinterpret_cast<std::uintptr_t>(p) % alignof(Odd) == 0;
+      assertUnit(aligned);
+      // teardown
+      for (Odd * p : blocks)
+         alloc.deallocate(p, 1);
+   }
+
+   // arrays bypass the pool
+   void test_allocate_array()
+   {  // setup
+      custom::magazine_allocator<int> alloc;
+      // exercise
+      int * p = alloc.allocate(1000);
+      for (int i = 0; i < 1000; i++)
+         p[i] = i;
+      // verify
+      assertUnit(p[999] == 999);
+      // teardown
+      alloc.deallocate(p, 1000);
+   }
+
+   // rebound copies compare equal, as a node allocator must
+   void test_rebind_equal()
+   {  // setup
+      custom::magazine_allocator<int> allocInt;
+      // exercise
+      custom::magazine_allocator<double> allocDouble(allocInt);
+      // verify
+      assertUnit(allocInt == allocDouble);
+      assertUnit(!(allocInt != allocDouble));
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // blocks allocated on one thread may be freed on another
+   void test_threads_crossFree()
+   {  // setup
+      typedef custom::magazine_allocator<std::int64_t> Alloc;
+      const size_t num = Alloc::Pool::MAGAZINE_SIZE * 3;
+      std::vector<std::int64_t *> blocks(num);
+      // exercise
+      std::thread producer([&]()
+      {
+         Alloc alloc;
+         for (size_t i = 0; i < num; i++)
+            *(blocks[i] = alloc.allocate(1)) = (std::int64_t)i;
+      });
+      producer.join();
+      std::thread consumer([&]()
+      {
+         Alloc alloc;
+         for (std::int64_t * p : blocks)
+            alloc.deallocate(p, 1);
+      });
+      consumer.join();
+      // verify
+      Alloc alloc;
+      std::int64_t * p = alloc.allocate(1);
+      assertUnit(p != nullptr);
+      alloc.deallocate(p, 1);
+   }  // teardown
+
+   // a thread's cached blocks go back to the depot when it exits
+   void test_threads_exitFlushes()
+   {  // setup
+      typedef custom::magazine_allocator<long double> Alloc;
+      std::vector<long double *> freed;
+      std::thread worker([&]()
+      {
+         Alloc alloc;
+         for (int i = 0; i < 10; i++)
+            freed.push_back(alloc.allocate(1));
+         for (long double * p : freed)
+            alloc.deallocate(p, 1);
+      });
+      worker.join();
+      // exercise
+      bool reused = false;
+      std::thread next([&]()
+      {
+         Alloc alloc;
+         long double * p = alloc.allocate(1);
+         for (long double * pFreed : freed)
+            reused = reused || p == pFreed;
+         alloc.deallocate(p, 1);
+      });
+      next.join();
+      // verify
+      assertUnit(reused);
+   }  // teardown
+
+   /***************************************
+    * STATS
+    ***************************************/
+
+   // the first allocation takes a whole magazine out of the depot
+   void test_stats_magazineOut()
+   {  // setup
+      typedef custom::magazine_allocator<StatsBlock<1>> Alloc;
+      Alloc alloc;
+      std::vector<StatsBlock<1> *> blocks;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         blocks.push_back(alloc.allocate(1));
+      for (StatsBlock<1> * p : blocks)
+         alloc.deallocate(p, 1);
+      // verify
+      custom::allocator_stats s = Alloc::stats();
+      size_t num = Alloc::Pool::MAGAZINE_SIZE;
+      assertUnit(s.live_blocks == num);
+      assertUnit(s.peak_blocks == num);
+      assertUnit(s.bytes_requested == num * sizeof(StatsBlock<1>));
+      assertUnit(s.bytes_in_blocks == num * Alloc::Pool::STRIDE);
+      assertUnit(s.bytes_reserved == (num + 1) * Alloc::Pool::STRIDE);
+   }  // teardown
+
+   // an exiting thread's magazines go back, but the peak stays
+   void test_stats_threadExits()
+   {  // setup
+      typedef custom::magazine_allocator<StatsBlock<2>> Alloc;
+      size_t num = Alloc::Pool::MAGAZINE_SIZE;
+      Alloc alloc;
+      alloc.deallocate(alloc.allocate(1), 1);
+      // exercise
+      std::thread([]()
+      {
+         Alloc alloc;
+         alloc.deallocate(alloc.allocate(1), 1);
+      }).join();
+      // verify
+      custom::allocator_stats s = Alloc::stats();
+      assertUnit(s.live_blocks == num);
+      assertUnit(s.peak_blocks == 2 * num);
+      assertUnit(s.bytes_reserved == 2 * (num + 1) * Alloc::Pool::STRIDE);
+   }  // teardown
+
+   // a block too small for the free-list link is padded out to one
+   void test_blockSize_padded()
+   {  // setup
+      custom::magazine_allocator<char> allocChar;
+      custom::magazine_allocator<double> allocDouble;
+      // exercise
+      size_t sizeChar = allocChar.block_size();
+      size_t sizeDouble = allocDouble.block_size();
+      // verify
+      assertUnit(sizeChar == sizeof(void *));
+      assertUnit(sizeDouble == sizeof(double));
+   }  // teardown
+
+   /***************************************
+    * LIST
+    ***************************************/
+
+   // a list built on the magazine allocator behaves like any other
+   void test_list_standard()
+   {  // setup
+      custom::list<int, custom::magazine_allocator<int>> l;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i);
+      size_t numRemoved = l.remove_if([](int value) { return value % 3 != 0; });
+      // verify
+      assertUnit(numRemoved == 666);
+      assertUnit(l.size() == 334);
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 999);
+   }  // teardown
+
+   // many threads filling their own lists at once
+   void test_list_threads()
+   {  // setup
+      const int numThreads = 8;
+      std::vector<long long> sums(numThreads, 0);
+      std::vector<std::thread> threads;
+      // exercise
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&sums, t]()
+         {
+            custom::list<int, custom::magazine_allocator<int>> l;
+            for (int round = 0; round < 5; round++)
+            {
+               for (int i = 0; i < 2000; i++)
+                  l.push_back(i);
+               l.clear();
+            }
+            for (int i = 0; i < 100; i++)
+               l.push_back(i + t);
+            for (int value : l)
+               sums[t] += value;
+         });
+      for (std::thread & thread : threads)
+         thread.join();
+      // verify
+      bool right = true;
+      for (int t = 0; t < numThreads; t++)
+         right = right && sums[t] == 4950 + 100 * t;
+      assertUnit(right);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,330 @@
+/***********************************************************************
+ * Header:
+ *    TEST MAPPED LIST
+ * Summary:
+ *    Unit tests for mapped_list
+ ************************************************************************/
+
+#pragma once
+
+#if defined(DEBUG) && !defined(_WIN32)
+
+#include "mappedList.h"   // class under test
+#include "unitTest.h"     // unit test baseclass
+
+#include <cstdint>        // for std::uint64_t and SIZE_MAX
+#include <cstdio>         // for std::remove
+
+/***********************************************
+ * TEST MAPPED LIST
+ * Unit tests for the mapped_list class
+ ***********************************************/
+class TestMappedList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_new();
+      test_construct_reopen();
+      test_construct_wrongType();
+      test_construct_badOffset();
+      test_construct_hugeCapacity();
+
+      // Insert
+      test_pushback_grow();
+      test_insert_middle();
+      test_reserve_tooLarge();
+
+      // Remove
+      test_erase_reuse();
+      test_clear_reopen();
+
+      report("MappedList");
+   }
+
+   /***************************************
+    * CONSTRUCTOR
+    ***************************************/
+
+   // create a list in a file that does not exist yet
+   void test_construct_new()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         // exercise
+         custom::mapped_list<int> l(FILE_NAME);
+         // verify
+         assertUnit(l.size() == 0);
+         assertUnit(l.empty());
+         assertUnit(l.pHeader->head == 0);
+         assertUnit(l.pHeader->tail == 0);
+         assertUnit(l.begin() == l.end());
+      }
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   // write the standard fixture, close the file, and open it again
+   void test_construct_reopen()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+      }
+      {
+         // exercise
+         custom::mapped_list<int> l(FILE_NAME);
+         // verify
+         //    +----+   +----+   +----+
+         //    | 11 | - | 26 | - | 31 |
+         //    +----+   +----+   +----+
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   // open a file that was written for a different element type
+   void test_construct_wrongType()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<double> l(FILE_NAME);
+         l.push_back(1.5);
+      }
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+      }
+      catch (const char * sError)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   // open a file whose head points past the slots in use
+   void test_construct_badOffset()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         l.push_back(11);
+         l.pHeader->head += 10 * sizeof(custom::mapped_list<int>::Node);
+      }
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   // open a file claiming more slots than could ever fit in memory
+   void test_construct_hugeCapacity()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         l.push_back(11);
+         l.pHeader->capacity = ~std::uint64_t(0) / 2;
+      }
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // push enough items that the file is remapped several times
+   void test_pushback_grow()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         // exercise
+         for (int i = 0; i < 1000; i++)
+            l.push_back(i);
+         // verify
+         assertUnit(l.size() == 1000);
+         assertUnit(l.capacity() >= 1000);
+         int value = 0;
+         bool inOrder = true;
+         for (custom::mapped_list<int>::iterator it = l.begin(); it != l.end(); ++it)
+            inOrder = inOrder && *it == value++;
+         assertUnit(inOrder);
+         assertUnit(value == 1000);
+         assertUnit(l.front() == 0);
+         assertUnit(l.back() == 999);
+      }
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   // insert into the middle and the front of the list
+   void test_insert_middle()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         l.push_back(11);
+         l.push_back(31);
+         custom::mapped_list<int>::iterator it = l.begin();
+         ++it;
+         // exercise
+         it = l.insert(it, 26);
+         // verify
+         assertUnit(*it == 26);
+         assertStandardFixture(l);
+         l.push_front(1);
+         assertUnit(l.front() == 1);
+         assertUnit(l.size() == 4);
+      }
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase a node and see its slot used for the next insert
+   void test_erase_reuse()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         l.push_back(11);
+         l.push_back(99);
+         l.push_back(26);
+         l.push_back(31);
+         size_t numUsed = (size_t)l.pHeader->numUsed;
+         custom::mapped_list<int>::iterator it = l.begin();
+         ++it;
+         // exercise
+         it = l.erase(it);
+         // verify
+         assertUnit(*it == 26);
+         assertStandardFixture(l);
+         l.push_back(42);
+         assertUnit(l.pHeader->numUsed == numUsed);
+         l.pop_back();
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   // a grow that cannot happen leaves the list as it was
+   void test_reserve_tooLarge()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+         size_t capacity = l.capacity();
+         bool thrown = false;
+         // exercise
+         try
+         {
+            l.reserve(SIZE_MAX);
+         }
+         catch (const char *)
+         {
+            thrown = true;
+         }
+         // verify
+         assertUnit(thrown);
+         assertUnit(l.capacity() == capacity);
+         assertStandardFixture(l);
+      }
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   // clear a list and re-open it: it stays empty
+   void test_clear_reopen()
+   {  // setup
+      std::remove(FILE_NAME);
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         l.push_back(11);
+         l.push_back(26);
+         // exercise
+         l.clear();
+         assertUnit(l.empty());
+      }
+      {
+         custom::mapped_list<int> l(FILE_NAME);
+         // verify
+         assertUnit(l.empty());
+         assertUnit(l.begin() == l.end());
+         l.push_back(11);
+         l.push_back(26);
+         l.push_back(31);
+         assertStandardFixture(l);
+         assertUnit(l.pHeader->numUsed == 3);
+      }
+      // teardown
+      std::remove(FILE_NAME);
+   }
+
+   /****************************************************************
+    * Verify Standard Fixture
+    *    +----+   +----+   +----+
+    *    | 11 | - | 26 | - | 31 |
+    *    +----+   +----+   +----+
+    ****************************************************************/
+   void assertStandardFixtureParameters(custom::mapped_list<int>& l, int line, const char* function)
+   {
+      assertIndirect(l.size() == 3);
+      custom::mapped_list<int>::iterator it = l.begin();
+      assertIndirect(it != l.end() && *it == 11);
+      ++it;
+      assertIndirect(it != l.end() && *it == 26);
+      ++it;
+      assertIndirect(it != l.end() && *it == 31);
+      ++it;
+      assertIndirect(it == l.end());
+      --it;
+      assertIndirect(*it == 31);
+   }
+
+   const char * FILE_NAME = "testMappedList.dat";
+};
+
+#endif // DEBUG && !_WIN32
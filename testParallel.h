@@ -0,0 +1,245 @@
+/***********************************************************************
+ * Header:
+ *    TEST PARALLEL
+ * Summary:
+ *    Unit tests for parallel_for_each and parallel_reduce
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "parallel.h"   // functions under test
+#include "list.h"       // the list they run over
+#include "unitTest.h"   // unit test baseclass
+
+#include <atomic>       // for std::atomic
+#include <set>          // for std::set
+#include <stdexcept>    // for std::runtime_error
+#include <string>       // for std::string
+#include <mutex>        // for std::mutex
+
+/***********************************************
+ * TEST PARALLEL
+ * Unit tests for the parallel algorithms
+ ***********************************************/
+class TestParallel : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Split
+      test_split_even();
+      test_split_uneven();
+
+      // For each
+      test_forEach_empty();
+      test_forEach_standard();
+      test_forEach_moreThreadsThanItems();
+      test_forEach_usesThreads();
+      test_forEach_exception();
+      test_forEach_counted();
+
+      // Reduce
+      test_reduce_empty();
+      test_reduce_sum();
+      test_reduce_order();
+
+      report("Parallel");
+   }
+
+   /***************************************
+    * SPLIT
+    ***************************************/
+
+   // split nine items three ways
+   void test_split_even()
+   {  // setup
+      custom::list<int> l;
+      fill(l, 9);
+      // exercise
+      auto splits = custom::splitPoints(l, 3);
+      // verify
+      assertUnit(splits.size() == 4);
+      assertUnit(*splits[0] == 0);
+      assertUnit(*splits[1] == 3);
+      assertUnit(*splits[2] == 6);
+      assertUnit(splits[3] == l.end());
+   }  // teardown
+
+   // split ten items four ways: the first two parts get the extra items
+   void test_split_uneven()
+   {  // setup
+      custom::list<int> l;
+      fill(l, 10);
+      // exercise
+      auto splits = custom::splitPoints(l, 4);
+      // verify
+      assertUnit(splits.size() == 5);
+      assertUnit(*splits[0] == 0);
+      assertUnit(*splits[1] == 3);
+      assertUnit(*splits[2] == 6);
+      assertUnit(*splits[3] == 8);
+      assertUnit(splits[4] == l.end());
+   }  // teardown
+
+   /***************************************
+    * FOR EACH
+    ***************************************/
+
+   // nothing to do for an empty list
+   void test_forEach_empty()
+   {  // setup
+      custom::list<int> l;
+      int numCalls = 0;
+      // exercise
+      custom::parallel_for_each(l, [&](int &) { numCalls++; }, 4);
+      // verify
+      assertUnit(numCalls == 0);
+   }  // teardown
+
+   // every item is visited exactly once
+   void test_forEach_standard()
+   {  // setup
+      custom::list<int> l;
+      fill(l, 10000);
+      // exercise
+      custom::parallel_for_each(l, [](int & value) { value *= 2; }, 8);
+      // verify
+      int expected = 0;
+      bool allDoubled = true;
+      for (custom::list<int>::iterator it = l.begin(); it != l.end(); ++it, expected += 2)
+         allDoubled = allDoubled && *it == expected;
+      assertUnit(allDoubled);
+      assertUnit(expected == 20000);
+   }  // teardown
+
+   // more threads than items
+   void test_forEach_moreThreadsThanItems()
+   {  // setup
+      custom::list<int> l;
+      fill(l, 3);
+      std::atomic<int> sum(0);
+      // exercise
+      custom::parallel_for_each(l, [&](int & value) { sum += value + 1; }, 16);
+      // verify
+      assertUnit(sum == 6);
+   }  // teardown
+
+   // the work really is spread over several threads
+   void test_forEach_usesThreads()
+   {  // setup
+      custom::list<int> l;
+      fill(l, 4000);
+      std::mutex lock;
+      std::set<std::thread::id> ids;
+      // exercise
+      custom::parallel_for_each(l, [&](int &)
+      {
+         std::lock_guard<std::mutex> guard(lock);
+         ids.insert(std::this_thread::get_id());
+      }, 4);
+      // verify
+      assertUnit(ids.size() >= 2);   // ids of finished threads may be reused
+   }  // teardown
+
+   // an exception in one thread reaches the caller
+   void test_forEach_exception()
+   {  // setup
+      custom::list<int> l;
+      fill(l, 100);
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::parallel_for_each(l, [](int & value)
+         {
+            if (value == 77)
+               throw std::runtime_error("bad item");
+         }, 4);
+      }
+      catch (const std::runtime_error &)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // a counted list can be walked by every thread at once without losing a step
+   void test_forEach_counted()
+   {  // setup
+      custom::list<int, std::allocator<int>, custom::counting_stats> l;
+      for (int i = 0; i < 10000; i++)
+         l.push_back(i);
+      l.stats().reset();
+      std::atomic<long long> sum(0);
+      // exercise
+      custom::parallel_for_each(l, [&](int & value) { sum += value; }, 8);
+      // verify
+      assertUnit(sum == 49995000LL);
+      assertUnit(l.stats().increments == 2 * 10000);   // once to split, once to visit
+      long long total = custom::parallel_reduce(l, 0LL,
+                           [](long long a, long long b) { return a + b; }, 8);
+      assertUnit(total == 49995000LL);
+      assertUnit(l.stats().increments == 4 * 10000);
+   }  // teardown
+
+   /***************************************
+    * REDUCE
+    ***************************************/
+
+   // reducing an empty list gives back init
+   void test_reduce_empty()
+   {  // setup
+      custom::list<int> l;
+      // exercise
+      long sum = custom::parallel_reduce(l, 42L, [](long a, long b) { return a + b; }, 4);
+      // verify
+      assertUnit(sum == 42);
+   }  // teardown
+
+   // sum a large list
+   void test_reduce_sum()
+   {  // setup
+      custom::list<int> l;
+      fill(l, 10000);
+      // exercise
+      long long sum = custom::parallel_reduce(l, 5LL,
+                         [](long long a, long long b) { return a + b; }, 7);
+      // verify
+      assertUnit(sum == 49995000LL + 5);
+   }  // teardown
+
+   // a non-commutative op sees the items in list order
+   void test_reduce_order()
+   {  // setup
+      custom::list<std::string> l;
+      const char * letters[] = { "a", "b", "c", "d", "e", "f", "g" };
+      for (const char * letter : letters)
+      {
+         std::string s(letter);
+         l.push_back(s);
+      }
+      // exercise
+      std::string all = custom::parallel_reduce(l, std::string(">"),
+                           [](const std::string & a, const std::string & b) { return a + b; }, 3);
+      // verify
+      assertUnit(all == ">abcdefg");
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // fill a list with 0, 1, 2, ... num-1
+   void fill(custom::list<int>& l, int num)
+   {
+      for (int i = 0; i < num; i++)
+         l.push_back(i);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,323 @@
+/***********************************************************************
+ * Header:
+ *    TEST PERSISTENT LIST
+ * Summary:
+ *    Unit tests for persistent_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "persistentList.h"   // class under test
+#include "spy.h"              // for the Spy class
+#include "unitTest.h"         // unit test baseclass
+
+#include <atomic>             // for std::atomic
+#include <thread>             // for std::thread
+#include <vector>             // for std::vector
+
+/***********************************************
+ * TEST PERSISTENT LIST
+ * Unit tests for the persistent_list class
+ ***********************************************/
+class TestPersistentList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_range();
+      test_snapshot_noCopies();
+
+      // Versions
+      test_pushfront_sharesTail();
+      test_popfront_sharesTail();
+      test_popfront_empty();
+      test_insert_copiesPrefix();
+      test_insert_front();
+      test_erase_middle();
+      test_erase_end();
+
+      // Reclaim
+      test_release_onlyUnshared();
+      test_release_longChain();
+      test_assign_lastHandle();
+
+      // Threads
+      test_threads_snapshots();
+
+      report("PersistentList");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // an empty version has no nodes
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::persistent_list<int> l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(l.begin() == l.end());
+      assertUnit(l.pHead == nullptr);
+   }  // teardown
+
+   // a range keeps its order
+   void test_construct_range()
+   {  // setup
+      std::vector<int> v{ 1, 2, 3 };
+      // exercise
+      custom::persistent_list<int> l(v.begin(), v.end());
+      // verify
+      assertUnit(isSequence(l, 1, 4));
+      assertUnit(l.front() == 1);
+      assertUnit(l.pHead->refs == 1);
+   }  // teardown
+
+   // a snapshot is another handle on the same nodes
+   void test_snapshot_noCopies()
+   {  // setup
+      custom::persistent_list<Spy> live = makeSpies(100);
+      Spy::reset();
+      // exercise
+      custom::persistent_list<Spy> snapshot(live);
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(snapshot.pHead == live.pHead);
+      assertUnit(live.pHead->refs == 2);
+      assertUnit(snapshot.size() == 100);
+   }  // teardown
+
+   /***************************************
+    * VERSIONS
+    ***************************************/
+
+   // push_front builds one node in front of the old version
+   void test_pushfront_sharesTail()
+   {  // setup
+      custom::persistent_list<int> v1{ 1, 2, 3 };
+      // exercise
+      custom::persistent_list<int> v2 = v1.push_front(0);
+      // verify
+      assertUnit(v2.pHead->pNext == v1.pHead);
+      assertUnit(v1.pHead->refs == 2);
+      assertUnit(isSequence(v1, 1, 4));
+      assertUnit(isSequence(v2, 0, 4));
+   }  // teardown
+
+   // pop_front starts at the old version's second node
+   void test_popfront_sharesTail()
+   {  // setup
+      custom::persistent_list<int> v1{ 0, 1, 2 };
+      // exercise
+      custom::persistent_list<int> v2 = v1.pop_front();
+      // verify
+      assertUnit(v2.pHead == v1.pHead->pNext);
+      assertUnit(isSequence(v1, 0, 3));
+      assertUnit(isSequence(v2, 1, 3));
+   }  // teardown
+
+   // there is nothing to pop from an empty version
+   void test_popfront_empty()
+   {  // setup
+      custom::persistent_list<int> l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.pop_front();
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // insert copies the nodes in front of it and shares the rest
+   void test_insert_copiesPrefix()
+   {  // setup
+      custom::persistent_list<Spy> v1 = makeSpies(10);
+      auto it = v1.begin();
+      for (int i = 0; i < 3; i++)
+         ++it;
+      Spy::reset();
+      // exercise
+      custom::persistent_list<Spy> v2 = v1.insert(it, Spy(99));
+      // verify
+      assertUnit(Spy::numCopy() == 4);   // three in front, and the new one
+      assertUnit(v2.size() == 11);
+      assertUnit(v1.size() == 10);
+      auto it2 = v2.begin();
+      for (int i = 0; i < 3; i++)
+         ++it2;
+      assertUnit(*it2 == Spy(99));
+      ++it2;
+      assertUnit(it2 == it);
+   }  // teardown
+
+   // inserting at the front copies nothing at all
+   void test_insert_front()
+   {  // setup
+      custom::persistent_list<int> v1{ 1, 2 };
+      // exercise
+      custom::persistent_list<int> v2 = v1.insert(v1.begin(), 0);
+      // verify
+      assertUnit(v2.pHead->pNext == v1.pHead);
+      assertUnit(isSequence(v2, 0, 3));
+   }  // teardown
+
+   // erase copies the nodes in front and shares what follows
+   void test_erase_middle()
+   {  // setup
+      custom::persistent_list<int> v1{ 0, 1, 99, 2, 3 };
+      auto it = v1.begin();
+      ++it;
+      ++it;
+      // exercise
+      custom::persistent_list<int> v2 = v1.erase(it);
+      // verify
+      assertUnit(v2.size() == 4);
+      assertUnit(v1.size() == 5);
+      assertUnit(v2.pHead != v1.pHead);
+      assertUnit(v2.pHead->pNext->pNext == it.p->pNext);
+      int expected[] = { 0, 1, 2, 3 };
+      int i = 0;
+      for (int value : v2)
+         assertUnit(value == expected[i++]);
+   }  // teardown
+
+   // there is nothing to erase at the end
+   void test_erase_end()
+   {  // setup
+      custom::persistent_list<int> l{ 1 };
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.erase(l.end());
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.size() == 1);
+   }  // teardown
+
+   /***************************************
+    * RECLAIM
+    ***************************************/
+
+   // dropping a version frees only the nodes no other version reaches
+   void test_release_onlyUnshared()
+   {  // setup
+      custom::persistent_list<Spy> v1 = makeSpies(5);
+      custom::persistent_list<Spy> v2 = v1.push_front(Spy(-1)).push_front(Spy(-2));
+      Spy::reset();
+      // exercise
+      v2 = custom::persistent_list<Spy>();
+      // verify
+      assertUnit(Spy::numDestructor() == 2);
+      assertUnit(Spy::numDelete() == 2);
+      assertUnit(v1.size() == 5);
+      assertUnit(v1.pHead->refs == 1);
+   }  // teardown
+
+   // freeing a long chain walks it rather than recursing
+   void test_release_longChain()
+   {  // setup
+      custom::persistent_list<int> l;
+      for (int i = 0; i < 1000000; i++)
+         l = l.push_front(i);
+      // exercise
+      l = custom::persistent_list<int>();
+      // verify
+      assertUnit(l.empty());
+   }  // teardown
+
+   // the last handle on a version takes every node with it
+   void test_assign_lastHandle()
+   {  // setup
+      Spy::reset();
+      {
+         custom::persistent_list<Spy> v1 = makeSpies(4);
+         custom::persistent_list<Spy> v2 = v1.pop_front().pop_front();
+         custom::persistent_list<Spy> v3 = v2.push_front(Spy(7));
+         // exercise
+         v1 = v3;
+         v2 = v3;
+         // verify
+         assertUnit(v1.pHead == v3.pHead);
+      }
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // readers walk snapshots while the writer keeps moving on
+   void test_threads_snapshots()
+   {  // setup
+      custom::persistent_list<int> live;
+      std::atomic<bool> right(true);
+      std::vector<std::thread> readers;
+      // exercise
+      for (int i = 0; i < 2000; i++)
+      {
+         live = live.push_front(i);
+         if (i % 3 == 0)
+            live = live.pop_front();
+         if (i % 100 == 0)
+            readers.emplace_back([&right](custom::persistent_list<int> snapshot)
+            {
+               size_t num = 0;
+               for (auto it = snapshot.begin(); it != snapshot.end(); ++it)
+                  num++;
+               if (num != snapshot.size())
+                  right = false;
+            }, live);
+      }
+      for (std::thread & reader : readers)
+         reader.join();
+      // verify
+      assertUnit(right);
+      assertUnit(live.size() == 1333);
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // a version holding Spy(0), Spy(1), ... Spy(num-1)
+   static custom::persistent_list<Spy> makeSpies(int num)
+   {
+      std::vector<Spy> items;
+      for (int i = 0; i < num; i++)
+         items.push_back(Spy(i));
+      return custom::persistent_list<Spy>(items.begin(), items.end());
+   }
+
+   // does the version hold first, first+1, ... last-1 ?
+   bool isSequence(const custom::persistent_list<int>& l, int first, int last)
+   {
+      int value = first;
+      for (int item : l)
+         if (item != value++)
+            return false;
+      return value == last && l.size() == (size_t)(last - first);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,372 @@
+/***********************************************************************
+ * Header:
+ *    TEST RCU LIST
+ * Summary:
+ *    Unit tests for rcu_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "rcuList.h"    // class under test
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+
+#include <atomic>       // for std::atomic
+#include <chrono>       // for std::chrono::milliseconds
+#include <thread>       // for std::thread
+#include <vector>       // for std::vector
+
+/***********************************************
+ * TEST RCU LIST
+ * Unit tests for the rcu_list class
+ ***********************************************/
+class TestRcuList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Write
+      test_push_order();
+      test_remove_retires();
+      test_remove_tail();
+      test_replace_inPlace();
+      test_clear_freesAll();
+      test_retire_batch();
+
+      // Grace periods
+      test_reader_keepsNode();
+      test_synchronize_waitsForReader();
+      test_synchronize_skipsOffline();
+      test_write_whileOnline();
+      test_synchronize_otherWrites();
+      test_reader_withdraws();
+
+      // Threads
+      test_threads_readWhileWriting();
+
+      report("RcuList");
+   }
+
+   /***************************************
+    * WRITE
+    ***************************************/
+
+   // items pushed at either end are read back in order
+   void test_push_order()
+   {  // setup
+      custom::rcu_list<int> l;
+      // exercise
+      l.push_back(2);
+      l.push_front(1);
+      l.push_back(3);
+      // verify
+      assertUnit(isSequence(l, 1, 4));
+      assertUnit(l.pTail->data == 3);
+   }  // teardown
+
+   // a removed node waits for a grace period rather than being freed
+   void test_remove_retires()
+   {  // setup
+      custom::rcu_list<Spy> l;
+      for (int i = 0; i < 4; i++)
+         l.push_back(Spy(i));
+      Spy target(2);
+      Spy::reset();
+      // exercise
+      size_t numRemoved = l.remove(target);
+      // verify
+      assertUnit(numRemoved == 1);
+      assertUnit(l.size() == 3);
+      assertUnit(l.numRetired == 1);
+      assertUnit(Spy::numDelete() == 0);
+      l.synchronize();
+      assertUnit(Spy::numDelete() == 1);
+      assertUnit(l.numRetired == 0);
+   }  // teardown
+
+   // removing the last item moves the tail back
+   void test_remove_tail()
+   {  // setup
+      custom::rcu_list<int> l;
+      for (int i = 0; i < 3; i++)
+         l.push_back(i);
+      // exercise
+      l.remove(2);
+      l.push_back(3);
+      // verify
+      int expected[] = { 0, 1, 3 };
+      int i = 0;
+      for (int value : l)
+         assertUnit(value == expected[i++]);
+      assertUnit(i == 3);
+   }  // teardown
+
+   // a replaced item keeps its place
+   void test_replace_inPlace()
+   {  // setup
+      custom::rcu_list<int> l;
+      for (int i = 0; i < 3; i++)
+         l.push_back(i);
+      // exercise
+      size_t numReplaced = l.replace_if([](int v) { return v == 2; }, 20);
+      l.push_back(30);
+      // verify
+      assertUnit(numReplaced == 1);
+      int expected[] = { 0, 1, 20, 30 };
+      int i = 0;
+      for (int value : l)
+         assertUnit(value == expected[i++]);
+      assertUnit(i == 4);
+   }  // teardown
+
+   // clear waits out the grace period itself
+   void test_clear_freesAll()
+   {  // setup
+      custom::rcu_list<Spy> l;
+      for (int i = 0; i < 10; i++)
+         l.push_back(Spy(i));
+      Spy::reset();
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(Spy::numDelete() == 10);
+      assertUnit(l.pTail == nullptr);
+   }  // teardown
+
+   // enough retired nodes set off a grace period on their own
+   void test_retire_batch()
+   {  // setup
+      custom::rcu_list<int> l;
+      int num = (int)custom::rcu_list<int>::RETIRE_BATCH;
+      for (int i = 0; i < num; i++)
+         l.push_back(i);
+      // exercise
+      for (int i = 0; i < num - 1; i++)
+         l.remove(i);
+      size_t numBefore = l.numRetired;
+      l.remove(num - 1);
+      // verify
+      assertUnit(numBefore == custom::rcu_list<int>::RETIRE_BATCH - 1);
+      assertUnit(l.numRetired == 0);
+      assertUnit(l.empty());
+   }  // teardown
+
+   /***************************************
+    * GRACE PERIODS
+    ***************************************/
+
+   // a reader standing on a removed node can still read it and walk on
+   void test_reader_keepsNode()
+   {  // setup
+      custom::rcu_list<int> l;
+      for (int i = 0; i < 3; i++)
+         l.push_back(i);
+      custom::rcu_list<int>::reader r(l);
+      auto it = l.begin();
+      ++it;
+      // exercise
+      l.remove(1);
+      // verify
+      assertUnit(*it == 1);
+      ++it;
+      assertUnit(*it == 2);
+      assertUnit(l.numRetired == 1);
+      r.offline();
+      l.synchronize();
+      assertUnit(l.numRetired == 0);
+   }  // teardown
+
+   // a grace period lasts until every online reader is quiescent
+   void test_synchronize_waitsForReader()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(1);
+      std::atomic<bool> removed(false);
+      std::atomic<bool> synced(false);
+      std::atomic<bool> syncedEarly(false);
+      // exercise
+      std::thread readerThread([&]()
+      {
+         custom::rcu_list<int>::reader r(l);
+         auto it = l.begin();
+         removed = true;
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+         syncedEarly = synced.load();
+         volatile int value = *it;
+         (void)value;
+         r.quiescent();
+      });
+      while (!removed)
+         std::this_thread::yield();
+      l.remove(1);
+      l.synchronize();
+      synced = true;
+      readerThread.join();
+      // verify
+      assertUnit(!syncedEarly);
+      assertUnit(l.empty());
+   }  // teardown
+
+   // an offline reader does not hold up a grace period
+   void test_synchronize_skipsOffline()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(1);
+      custom::rcu_list<int>::reader r(l);
+      r.offline();
+      // exercise
+      l.remove(1);
+      l.synchronize();
+      // verify
+      assertUnit(l.numRetired == 0);
+      r.online();
+      assertUnit(l.empty());
+   }  // teardown
+
+   // a thread that reads and writes does not wait on its own reader
+   void test_write_whileOnline()
+   {  // setup
+      custom::rcu_list<int> l;
+      int num = (int)custom::rcu_list<int>::RETIRE_BATCH;
+      for (int i = 0; i < num + 5; i++)
+         l.push_back(i);
+      custom::rcu_list<int>::reader r(l);
+      // exercise
+      l.remove_if([num](int value) { return value < num; });
+      l.replace_if([](int value) { return value % 2 == 0; }, -1);
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.numRetired == (size_t)num + 5 + 3);
+      r.offline();
+      l.synchronize();
+      assertUnit(l.numRetired == 0);
+   }  // teardown
+
+   // a reader on another thread can write while a grace period waits for it
+   void test_synchronize_otherWrites()
+   {  // setup
+      custom::rcu_list<int> l;
+      l.push_back(1);
+      std::atomic<bool> ready(false);
+      std::atomic<bool> syncing(false);
+      // exercise
+      std::thread readerThread([&]()
+      {
+         custom::rcu_list<int>::reader r(l);
+         ready = true;
+         while (!syncing)
+            std::this_thread::yield();
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+         l.push_back(2);
+         r.quiescent();
+      });
+      while (!ready)
+         std::this_thread::yield();
+      l.remove(1);
+      syncing = true;
+      l.synchronize();
+      readerThread.join();
+      // verify
+      assertUnit(l.numRetired == 0);
+      assertUnit(l.size() == 1);
+      assertUnit(*l.begin() == 2);
+   }  // teardown
+
+   // a reader drops out when it goes away
+   void test_reader_withdraws()
+   {  // setup
+      custom::rcu_list<int> l;
+      // exercise
+      {
+         custom::rcu_list<int>::reader r1(l);
+         custom::rcu_list<int>::reader r2(l);
+         assertUnit(l.pReaders == &r2.slot);
+         assertUnit(l.pReaders->pNext == &r1.slot);
+      }
+      // verify
+      assertUnit(l.pReaders == nullptr);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // readers keep walking the routes while a writer swaps them out
+   void test_threads_readWhileWriting()
+   {  // setup
+      custom::rcu_list<int> routes;
+      for (int i = 0; i < 100; i++)
+         routes.push_back(i);
+      std::atomic<bool> done(false);
+      std::atomic<bool> right(true);
+      std::atomic<long> numWalks(0);
+      std::atomic<int> numReady(0);
+      // exercise
+      std::vector<std::thread> readers;
+      for (int t = 0; t < 4; t++)
+         readers.emplace_back([&]()
+         {
+            custom::rcu_list<int>::reader r(routes);
+            numReady++;
+            while (!done)
+            {
+               // every route is in 0..999, and there are never more than 101
+               int num = 0;
+               for (int route : routes)
+               {
+                  if (route < 0 || route >= 1000)
+                     right = false;
+                  num++;
+               }
+               if (num > 101)
+                  right = false;
+               numWalks++;
+               r.quiescent();
+            }
+         });
+      while (numReady < 4)
+         std::this_thread::yield();
+      for (int i = 0; i < 500; i++)
+      {
+         int old = i % 100;
+         routes.replace_if([old](int v) { return v % 100 == old; }, (i + 100) % 1000);
+         if (i % 50 == 0)
+         {
+            routes.push_back(999);
+            routes.remove(999);
+         }
+      }
+      routes.synchronize();
+      done = true;
+      for (std::thread & reader : readers)
+         reader.join();
+      // verify
+      assertUnit(right);
+      assertUnit(routes.size() == 100);
+      assertUnit(routes.numRetired == 0);
+      assertUnit(numWalks > 0);
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // does the list hold first, first+1, ... last-1 ?
+   bool isSequence(const custom::rcu_list<int>& l, int first, int last)
+   {
+      int value = first;
+      for (int item : l)
+         if (item != value++)
+            return false;
+      return value == last && l.size() == (size_t)(last - first);
+   }
+};
+
+#endif // DEBUG
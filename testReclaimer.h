@@ -0,0 +1,282 @@
+/***********************************************************************
+ * Header:
+ *    TEST RECLAIMER
+ * Summary:
+ *    Unit tests for reclaimer and lists in background clear mode
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "reclaimer.h"  // class under test
+#include "list.h"       // the list that posts to it
+#include "spy.h"        // for the Spy class
+#include "unitTest.h"   // unit test baseclass
+
+#include <atomic>       // for std::atomic
+
+/***********************************************
+ * TEST RECLAIMER
+ * Unit tests for the reclaimer class
+ ***********************************************/
+class TestReclaimer : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Reclaimer
+      test_post_freesInBatches();
+      test_post_inOrder();
+      test_stats_peak();
+
+      // List
+      test_list_offByDefault();
+      test_clear_detaches();
+      test_clear_shortInline();
+      test_destructor_deferred();
+      test_moveAssign_deferred();
+      test_reuse_afterClear();
+#ifdef __cpp_lib_memory_resource
+      test_pmr_inline();
+#endif // __cpp_lib_memory_resource
+
+      report("Reclaimer");
+   }
+
+   /***************************************
+    * RECLAIMER
+    ***************************************/
+
+   // a job is asked for one batch at a time until it is done
+   void test_post_freesInBatches()
+   {  // setup
+      custom::reclaimer & r = custom::reclaimer::global();
+      r.wait_reclaimed();
+      custom::reclaimer::Stats before = r.stats();
+      std::atomic<int> numCalls(0);
+      std::atomic<size_t> numFreed(0);
+      const size_t num = custom::reclaimer::BATCH * 2 + 5;
+      // exercise
+      r.post(new CountingJob(num, numCalls, numFreed));
+      r.wait_reclaimed();
+      // verify
+      custom::reclaimer::Stats after = r.stats();
+      assertUnit(numCalls == 3);
+      assertUnit(numFreed == num);
+      assertUnit(after.numJobs == before.numJobs + 1);
+      assertUnit(after.numFreed == before.numFreed + num);
+      assertUnit(after.numQueued == 0);
+      assertUnit(after.numPending == 0);
+   }  // teardown
+
+   // chains are freed in the order they were posted
+   void test_post_inOrder()
+   {  // setup
+      custom::reclaimer & r = custom::reclaimer::global();
+      std::atomic<int> order(0);
+      int first = -1;
+      int second = -1;
+      // exercise
+      r.post(new OrderJob(order, first));
+      r.post(new OrderJob(order, second));
+      r.wait_reclaimed();
+      // verify
+      assertUnit(first == 0);
+      assertUnit(second == 1);
+   }  // teardown
+
+   // the most nodes ever waiting is remembered
+   void test_stats_peak()
+   {  // setup
+      custom::reclaimer & r = custom::reclaimer::global();
+      r.wait_reclaimed();
+      custom::list<int> l1((size_t)20000, 1);
+      custom::list<int> l2((size_t)30000, 2);
+      l1.reclaim_in_background(true);
+      l2.reclaim_in_background(true);
+      // exercise
+      l1.clear();
+      l2.clear();
+      custom::reclaimer::Stats during = r.stats();
+      r.wait_reclaimed();
+      // verify
+      custom::reclaimer::Stats after = r.stats();
+      assertUnit(during.maxPending >= during.numPending);
+      assertUnit(after.maxPending >= 30000);
+      assertUnit(after.numPending == 0);
+      assertUnit(after.numQueued == 0);
+   }  // teardown
+
+   /***************************************
+    * LIST
+    ***************************************/
+
+   // a list frees its own nodes unless asked not to
+   void test_list_offByDefault()
+   {  // setup
+      custom::list<int> l((size_t)5000, 7);
+      custom::reclaimer::Stats before = custom::reclaimer::global().stats();
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(!l.reclaims_in_background());
+      assertUnit(custom::reclaimer::global().stats().numJobs == before.numJobs);
+      assertUnit(l.empty());
+   }  // teardown
+
+   // clear() leaves the list empty at once and the items are destroyed later
+   void test_clear_detaches()
+   {  // setup
+      custom::reclaimer::global().wait_reclaimed();
+      custom::list<Spy> l;
+      for (int i = 0; i < 5000; i++)
+         l.push_back(Spy(i));
+      l.reclaim_in_background(true);
+      Spy::reset();
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+      custom::reclaimer::global().wait_reclaimed();
+      assertUnit(Spy::numDestructor() == 5000);
+      assertUnit(Spy::numDelete() == 5000);
+   }  // teardown
+
+   // a short list is not worth posting
+   void test_clear_shortInline()
+   {  // setup
+      custom::list<Spy> l;
+      for (int i = 0; i < 10; i++)
+         l.push_back(Spy(i));
+      l.reclaim_in_background(true);
+      custom::reclaimer::Stats before = custom::reclaimer::global().stats();
+      Spy::reset();
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 10);
+      assertUnit(custom::reclaimer::global().stats().numJobs == before.numJobs);
+   }  // teardown
+
+   // the destructor posts too
+   void test_destructor_deferred()
+   {  // setup
+      custom::reclaimer & r = custom::reclaimer::global();
+      r.wait_reclaimed();
+      custom::reclaimer::Stats before = r.stats();
+      // exercise
+      {
+         custom::list<int> l((size_t)10000, 3);
+         l.reclaim_in_background(true);
+      }
+      r.wait_reclaimed();
+      // verify
+      custom::reclaimer::Stats after = r.stats();
+      assertUnit(after.numJobs == before.numJobs + 1);
+      assertUnit(after.numFreed == before.numFreed + 10000);
+   }  // teardown
+
+   // the nodes a move-assign replaces are posted as well
+   void test_moveAssign_deferred()
+   {  // setup
+      custom::reclaimer & r = custom::reclaimer::global();
+      r.wait_reclaimed();
+      custom::reclaimer::Stats before = r.stats();
+      custom::list<int> lDes((size_t)8000, 1);
+      custom::list<int> lSrc((size_t)3, 2);
+      lDes.reclaim_in_background(true);
+      // exercise
+      lDes = std::move(lSrc);
+      r.wait_reclaimed();
+      // verify
+      assertUnit(lDes.size() == 3);
+      assertUnit(lDes.front() == 2);
+      assertUnit(r.stats().numJobs == before.numJobs + 1);
+   }  // teardown
+
+   // the list is ready for new items while the old ones are freed
+   void test_reuse_afterClear()
+   {  // setup
+      custom::list<int> l((size_t)50000, 9);
+      l.reclaim_in_background(true);
+      // exercise
+      l.clear();
+      for (int i = 0; i < 3; i++)
+         l.push_back(i);
+      // verify
+      assertUnit(l.size() == 3);
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 2);
+      custom::reclaimer::global().wait_reclaimed();
+      assertUnit(l.size() == 3);
+   }  // teardown
+
+#ifdef __cpp_lib_memory_resource
+   // a resource the owner may destroy is never left to the reclaimer
+   void test_pmr_inline()
+   {  // setup
+      custom::reclaimer & r = custom::reclaimer::global();
+      r.wait_reclaimed();
+      custom::reclaimer::Stats before = r.stats();
+      std::pmr::monotonic_buffer_resource resource;
+      custom::pmr::list<Spy> l(&resource);
+      for (int i = 0; i < 5000; i++)
+         l.push_back(Spy(i));
+      l.reclaim_in_background(true);
+      Spy::reset();
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(Spy::numDestructor() == 5000);
+      assertUnit(r.stats().numJobs == before.numJobs);
+   }  // teardown
+#endif // __cpp_lib_memory_resource
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // pretends to free num nodes, counting the calls
+   class CountingJob : public custom::reclaimer::Job
+   {
+   public:
+      CountingJob(size_t num, std::atomic<int> & numCalls, std::atomic<size_t> & numFreed) :
+         custom::reclaimer::Job(num), numLeft(num), numCalls(numCalls), numFreed(numFreed) { }
+      size_t reclaim(size_t num) override
+      {
+         size_t n = num < numLeft ? num : numLeft;
+         numLeft -= n;
+         numCalls++;
+         numFreed += n;
+         return n;
+      }
+   private:
+      size_t numLeft;
+      std::atomic<int> & numCalls;
+      std::atomic<size_t> & numFreed;
+   };
+
+   // notes when it was freed relative to the other OrderJobs
+   class OrderJob : public custom::reclaimer::Job
+   {
+   public:
+      OrderJob(std::atomic<int> & order, int & position) :
+         custom::reclaimer::Job(1), order(order), position(position) { }
+      size_t reclaim(size_t) override
+      {
+         position = order++;
+         return 1;
+      }
+   private:
+      std::atomic<int> & order;
+      int & position;
+   };
+};
+
+#endif // DEBUG
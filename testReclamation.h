@@ -0,0 +1,338 @@
+/***********************************************************************
+ * Header:
+ *    TEST RECLAMATION
+ * Summary:
+ *    Unit tests for the reclamation domains and the lock-free stack
+ *    that plugs into them
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "reclamation.h"     // classes under test
+#include "lockfreeStack.h"   // a container that uses them
+#include "spy.h"             // for the Spy class
+#include "unitTest.h"        // unit test baseclass
+
+#include <atomic>            // for std::atomic
+#include <thread>            // for std::thread
+#include <vector>            // for std::vector
+
+/***********************************************
+ * TEST RECLAMATION
+ * Unit tests for hazard_domain, epoch_domain and
+ * lockfree_stack
+ ***********************************************/
+class TestReclamation : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Hazard pointers
+      test_hazard_protectedKept();
+      test_hazard_scanThreshold();
+      test_hazard_recordReused();
+      test_hazard_destructorFrees();
+
+      // Epochs
+      test_epoch_advances();
+      test_epoch_pinnedHoldsBack();
+      test_epoch_destructorFrees();
+
+      // Stack
+      test_stack_lifo();
+      test_stack_popEmpty();
+      test_stack_noLeaks();
+      test_stack_threadsHazard();
+      test_stack_threadsEpoch();
+
+      report("Reclamation");
+   }
+
+   /***************************************
+    * HAZARD POINTERS
+    ***************************************/
+
+   // a scan frees nothing that a hazard pointer names
+   void test_hazard_protectedKept()
+   {  // setup
+      custom::hazard_domain domain;
+      std::atomic<int *> src(new int(7));
+      int numBefore = numDeleted();
+      custom::hazard_domain::guard reader(domain);
+      int * p = reader.protect(0, src);
+      // exercise
+      {
+         custom::hazard_domain::guard writer(domain);
+         src.store(nullptr);
+         writer.retire(p, &countingDelete);
+         writer.scan();
+         // verify
+         assertUnit(numDeleted() == numBefore);
+         assertUnit(*p == 7);
+         reader.clear(0);
+         writer.scan();
+      }
+      assertUnit(numDeleted() == numBefore + 1);
+      assertUnit(domain.num_freed() == 1);
+      assertUnit(domain.num_pending() == 0);
+   }  // teardown
+
+   // retiring enough sets off a scan on its own
+   void test_hazard_scanThreshold()
+   {  // setup
+      custom::hazard_domain domain;
+      custom::hazard_domain::guard g(domain);
+      size_t num = custom::hazard_domain::SCAN_AT_LEAST;
+      // exercise
+      for (size_t i = 0; i < num - 1; i++)
+         g.retire(new int(0), &countingDelete);
+      size_t numBefore = domain.num_pending();
+      g.retire(new int(0), &countingDelete);
+      // verify
+      assertUnit(numBefore == num - 1);
+      assertUnit(domain.num_pending() == 0);
+      assertUnit(domain.num_freed() == num);
+   }  // teardown
+
+   // one thread opening guard after guard keeps one record
+   void test_hazard_recordReused()
+   {  // setup
+      custom::hazard_domain domain;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         custom::hazard_domain::guard g(domain);
+      // verify
+      assertUnit(domain.records.size() == 1);
+   }  // teardown
+
+   // whatever is still pending goes with the domain
+   void test_hazard_destructorFrees()
+   {  // setup
+      int numBefore = numDeleted();
+      // exercise
+      {
+         custom::hazard_domain domain;
+         custom::hazard_domain::guard g(domain);
+         for (int i = 0; i < 5; i++)
+            g.retire(new int(i), &countingDelete);
+         assertUnit(numDeleted() == numBefore);
+      }
+      // verify
+      assertUnit(numDeleted() == numBefore + 5);
+   }  // teardown
+
+   /***************************************
+    * EPOCHS
+    ***************************************/
+
+   // with nobody else in, two epochs on frees what was retired
+   void test_epoch_advances()
+   {  // setup
+      custom::epoch_domain domain;
+      std::uint64_t e = domain.current_epoch();
+      // exercise
+      {
+         custom::epoch_domain::guard g(domain);
+         g.retire(new int(1), &countingDelete);
+         g.scan();
+         g.scan();   // our own guard is still in epoch e
+         assertUnit(domain.current_epoch() == e + 1);
+         assertUnit(domain.num_pending() == 1);
+      }
+      scanOnce(domain);
+      // verify
+      assertUnit(domain.current_epoch() == e + 2);
+      assertUnit(domain.num_pending() == 0);
+      assertUnit(domain.num_freed() == 1);
+   }  // teardown
+
+   // a guard left open holds back everything retired after it
+   void test_epoch_pinnedHoldsBack()
+   {  // setup
+      custom::epoch_domain domain;
+      int numBefore = numDeleted();
+      std::atomic<bool> pinned(false);
+      std::atomic<bool> done(false);
+      std::thread stalled([&]()
+      {
+         custom::epoch_domain::guard g(domain);
+         pinned = true;
+         while (!done)
+            std::this_thread::yield();
+      });
+      while (!pinned)
+         std::this_thread::yield();
+      // exercise
+      {
+         custom::epoch_domain::guard g(domain);
+         for (int i = 0; i < 1000; i++)
+            g.retire(new int(i), &countingDelete);
+         g.scan();
+         g.scan();
+      }
+      // verify
+      assertUnit(numDeleted() == numBefore);
+      assertUnit(domain.num_pending() == 1000);
+      done = true;
+      stalled.join();
+      scanOnce(domain);
+      scanOnce(domain);
+      assertUnit(numDeleted() == numBefore + 1000);
+   }  // teardown
+
+   // whatever is still pending goes with the domain
+   void test_epoch_destructorFrees()
+   {  // setup
+      int numBefore = numDeleted();
+      // exercise
+      {
+         custom::epoch_domain domain;
+         custom::epoch_domain::guard g(domain);
+         for (int i = 0; i < 5; i++)
+            g.retire(new int(i), &countingDelete);
+      }
+      // verify
+      assertUnit(numDeleted() == numBefore + 5);
+   }  // teardown
+
+   /***************************************
+    * STACK
+    ***************************************/
+
+   // last in, first out
+   void test_stack_lifo()
+   {  // setup
+      custom::hazard_domain domain;
+      custom::lockfree_stack<int> s(domain);
+      // exercise
+      for (int i = 0; i < 3; i++)
+         s.push(i);
+      // verify
+      int value = -1;
+      for (int i = 2; i >= 0; i--)
+      {
+         assertUnit(s.pop(value));
+         assertUnit(value == i);
+      }
+      assertUnit(s.empty());
+   }  // teardown
+
+   // popping an empty stack fails and leaves the output alone
+   void test_stack_popEmpty()
+   {  // setup
+      custom::lockfree_stack<int, custom::epoch_domain> s;
+      int value = 99;
+      // exercise
+      bool popped = s.pop(value);
+      // verify
+      assertUnit(!popped);
+      assertUnit(value == 99);
+   }  // teardown
+
+   // every node is freed, popped or not, once stack and domain are gone
+   void test_stack_noLeaks()
+   {  // setup
+      Spy::reset();
+      // exercise
+      {
+         custom::hazard_domain domain;
+         custom::lockfree_stack<Spy> s(domain);
+         for (int i = 0; i < 10; i++)
+            s.push(Spy(i));
+         Spy spy;
+         for (int i = 0; i < 6; i++)
+            s.pop(spy);
+      }
+      // verify
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+   }  // teardown
+
+   // threads push and pop at once; nothing is lost or popped twice
+   void test_stack_threadsHazard()
+   {  // setup
+      custom::hazard_domain domain;
+      size_t numPopped = churn<custom::hazard_domain>(domain);
+      // verify
+      assertUnit(numPopped == 8 * 2000);
+      assertUnit(domain.num_freed() + domain.num_pending() == numPopped);
+   }  // teardown
+
+   void test_stack_threadsEpoch()
+   {  // setup
+      custom::epoch_domain domain;
+      size_t numPopped = churn<custom::epoch_domain>(domain);
+      // verify
+      assertUnit(numPopped == 8 * 2000);
+      assertUnit(domain.num_freed() + domain.num_pending() == numPopped);
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // deletes an int and counts it
+   static std::atomic<int> & deleted()
+   {
+      static std::atomic<int> num(0);
+      return num;
+   }
+   static int numDeleted() { return deleted().load(); }
+   static void countingDelete(void * p)
+   {
+      delete static_cast<int *>(p);
+      deleted()++;
+   }
+
+   // open a guard just to move the epoch on and collect
+   static void scanOnce(custom::epoch_domain & domain)
+   {
+      custom::epoch_domain::guard g(domain);
+      g.scan();
+   }
+
+   // 8 threads each push 2000 distinct values and pop 2000 of anyone's
+   template <typename Domain>
+   size_t churn(Domain & domain)
+   {
+      const int numThreads = 8;
+      const int numEach = 2000;
+      custom::lockfree_stack<int, Domain> s(domain);
+      std::vector<std::vector<int>> popped(numThreads);
+      std::vector<std::thread> threads;
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&, t]()
+         {
+            for (int i = 0; i < numEach; i++)
+            {
+               s.push(t * numEach + i);
+               int value;
+               if (s.pop(value))
+                  popped[t].push_back(value);
+            }
+         });
+      for (std::thread & thread : threads)
+         thread.join();
+      int value;
+      while (s.pop(value))
+         popped[0].push_back(value);
+
+      std::vector<bool> seen(numThreads * numEach, false);
+      size_t numPopped = 0;
+      bool unique = true;
+      for (const std::vector<int> & values : popped)
+         for (int v : values)
+         {
+            unique = unique && !seen[v];
+            seen[v] = true;
+            numPopped++;
+         }
+      assertUnit(unique);
+      return numPopped;
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,230 @@
+/***********************************************************************
+ * Header:
+ *    TEST SHARDED LIST
+ * Summary:
+ *    Unit tests for sharded_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "shardedList.h"   // class under test
+#include "spy.h"           // for the Spy class
+#include "unitTest.h"      // unit test baseclass
+
+#include <thread>          // for std::thread
+#include <vector>          // for std::vector
+
+/***********************************************
+ * TEST SHARDED LIST
+ * Unit tests for the sharded_list class
+ ***********************************************/
+class TestShardedList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_shards();
+      test_construct_zero();
+
+      // Insert
+      test_pushback_ownShard();
+      test_pushback_threadsSpread();
+
+      // Consume
+      test_collect_noCopies();
+      test_collect_shardOrder();
+      test_forEach_visitsAll();
+      test_clear();
+
+      // Threads
+      test_threads_ingest();
+
+      report("ShardedList");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // every shard starts out empty
+   void test_construct_shards()
+   {  // setup
+      // exercise
+      custom::sharded_list<int> l(8);
+      // verify
+      assertUnit(l.num_shards() == 8);
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      bool allEmpty = true;
+      for (size_t i = 0; i < 8; i++)
+         allEmpty = allEmpty && l.shards[i].items.empty();
+      assertUnit(allEmpty);
+      assertUnit(sizeof(custom::sharded_list<int>::Shard) >= 64 + sizeof(custom::list<int>));
+   }  // teardown
+
+   // there must be somewhere to put things
+   void test_construct_zero()
+   {  // setup
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::sharded_list<int> l(0);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // one thread always lands on the same shard
+   void test_pushback_ownShard()
+   {  // setup
+      custom::sharded_list<int> l(4);
+      size_t mine = l.shard_of_this_thread();
+      // exercise
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      // verify
+      assertUnit(l.size() == 10);
+      assertUnit(l.shards[mine].items.size() == 10);
+      assertUnit(l.shards[mine].items.front() == 0);
+      assertUnit(l.shards[mine].items.back() == 9);
+   }  // teardown
+
+   // as many threads as shards land on different shards
+   void test_pushback_threadsSpread()
+   {  // setup
+      custom::sharded_list<int> l(4);
+      // exercise
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++)
+         threads.emplace_back([&l, t]() { l.push_back(t); });
+      for (std::thread & thread : threads)
+         thread.join();
+      // verify
+      bool spread = true;
+      for (size_t i = 0; i < 4; i++)
+         spread = spread && l.shards[i].items.size() == 1;
+      assertUnit(spread);
+   }  // teardown
+
+   /***************************************
+    * CONSUME
+    ***************************************/
+
+   // collecting relinks the nodes and leaves the shards empty
+   void test_collect_noCopies()
+   {  // setup
+      custom::sharded_list<Spy> l(3);
+      for (int i = 0; i < 9; i++)
+         l.push_back(i % 3, Spy(i));
+      Spy::reset();
+      // exercise
+      custom::list<Spy> all = l.collect();
+      // verify
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numCopyMove() == 0);
+      assertUnit(all.size() == 9);
+      assertUnit(l.empty());
+   }  // teardown
+
+   // shard 0 comes first, and each shard keeps its order
+   void test_collect_shardOrder()
+   {  // setup
+      custom::sharded_list<int> l(3);
+      for (int i = 0; i < 9; i++)
+         l.push_back(i % 3, i);
+      // exercise
+      custom::list<int> all = l.collect();
+      // verify
+      int expected[] = { 0, 3, 6, 1, 4, 7, 2, 5, 8 };
+      int i = 0;
+      for (int value : all)
+         assertUnit(value == expected[i++]);
+      assertUnit(i == 9);
+      assertUnit(all.back() == 8);
+   }  // teardown
+
+   // for_each sees every item and takes none
+   void test_forEach_visitsAll()
+   {  // setup
+      custom::sharded_list<int> l(5);
+      for (int i = 1; i <= 100; i++)
+         l.push_back(i % 5, i);
+      // exercise
+      int sum = 0;
+      l.for_each([&sum](int value) { sum += value; });
+      // verify
+      assertUnit(sum == 5050);
+      assertUnit(l.size() == 100);
+   }  // teardown
+
+   // clear empties every shard
+   void test_clear()
+   {  // setup
+      custom::sharded_list<Spy> l(2);
+      l.push_back(0, Spy(1));
+      l.push_back(1, Spy(2));
+      Spy::reset();
+      // exercise
+      l.clear();
+      // verify
+      assertUnit(l.empty());
+      assertUnit(Spy::numDestructor() == 2);
+   }  // teardown
+
+   /***************************************
+    * THREADS
+    ***************************************/
+
+   // many collectors append at once; one pass consumes everything
+   void test_threads_ingest()
+   {  // setup
+      custom::sharded_list<int> events(8);
+      const int numThreads = 16;
+      const int numEach = 2000;
+      // exercise
+      std::vector<std::thread> threads;
+      for (int t = 0; t < numThreads; t++)
+         threads.emplace_back([&events, t, numEach]()
+         {
+            for (int i = 0; i < numEach; i++)
+               events.push_back(t * numEach + i);
+         });
+      for (std::thread & thread : threads)
+         thread.join();
+      custom::list<int> all = events.collect();
+      // verify
+      assertUnit(all.size() == (size_t)(numThreads * numEach));
+      std::vector<bool> seen(numThreads * numEach, false);
+      std::vector<int> last(numThreads, -1);
+      bool inOrder = true;
+      for (int value : all)
+      {
+         seen[value] = true;
+         int t = value / numEach;
+         inOrder = inOrder && value > last[t];
+         last[t] = value;
+      }
+      bool allSeen = true;
+      for (bool b : seen)
+         allSeen = allSeen && b;
+      assertUnit(allSeen);
+      assertUnit(inOrder);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,404 @@
+/***********************************************************************
+ * Header:
+ *    TEST STATIC LIST
+ * Summary:
+ *    Unit tests for static_list
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "staticList.h"  // class under test
+#include "spy.h"         // for the Spy class
+#include "unitTest.h"    // unit test baseclass
+
+#include <algorithm>     // for std::find
+#include <cstdint>       // for std::uint8_t
+#include <string>        // for std::string
+#include <type_traits>   // for std::is_same
+
+/***********************************************
+ * TEST STATIC LIST
+ * Unit tests for the static_list class
+ ***********************************************/
+class TestStaticList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_initializerList();
+      test_construct_copy();
+      test_construct_move();
+      test_construct_tooMany();
+      test_index_smallest();
+
+      // Insert
+      test_pushback_fill();
+      test_pushback_full();
+      test_pushfront_standard();
+      test_insert_middle();
+
+      // Remove
+      test_erase_reusesSlot();
+      test_pop_both();
+      test_clear_reusesSlots();
+      test_remove_if();
+      test_remove_ownItem();
+
+      // Objects
+      test_spy_destroyed();
+      test_string_moved();
+
+      // Reorder
+      test_assign_shorter();
+      test_swap_uneven();
+      test_reverse_standard();
+      test_iterator_decrementEnd();
+
+      report("StaticList");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // a new list is empty and has touched none of its slots
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::static_list<int, 8> l;
+      // verify
+      assertUnit(l.empty());
+      assertUnit(l.size() == 0);
+      assertUnit(!l.full());
+      assertUnit(l.max_size() == 8);
+      assertUnit(l.numUsed == 0);
+      assertUnit(l.begin() == l.end());
+   }  // teardown
+
+   // build from an initializer list
+   void test_construct_initializerList()
+   {  // setup
+      // exercise
+      custom::static_list<int, 8> l{ 1, 2, 3, 4 };
+      // verify
+      assertUnit(l.size() == 4);
+      assertUnit(isSequence(l, 1, 5));
+   }  // teardown
+
+   // a copy has its own slots
+   void test_construct_copy()
+   {  // setup
+      custom::static_list<int, 8> lSrc{ 1, 2, 3 };
+      // exercise
+      custom::static_list<int, 8> lDes(lSrc);
+      lSrc.front() = 99;
+      // verify
+      assertUnit(isSequence(lDes, 1, 4));
+      assertUnit(lSrc.front() == 99);
+   }  // teardown
+
+   // moving leaves the source empty
+   void test_construct_move()
+   {  // setup
+      custom::static_list<std::string, 4> lSrc{ "a", "b", "c" };
+      // exercise
+      custom::static_list<std::string, 4> lDes(std::move(lSrc));
+      // verify
+      assertUnit(lSrc.empty());
+      assertUnit(lDes.size() == 3);
+      assertUnit(lDes.front() == "a");
+      assertUnit(lDes.back() == "c");
+   }  // teardown
+
+   // more items than fit throws
+   void test_construct_tooMany()
+   {  // setup
+      bool thrown = false;
+      // exercise
+      try
+      {
+         custom::static_list<int, 3> l{ 1, 2, 3, 4 };
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // links are as small as the capacity allows
+   void test_index_smallest()
+   {  // setup
+      // exercise
+      // verify
+      assertUnit((std::is_same<custom::static_list<int, 10>::Index, std::uint8_t>::value));
+      assertUnit((std::is_same<custom::static_list<int, 1000>::Index, std::uint16_t>::value));
+      assertUnit((std::is_same<custom::static_list<int, 100000>::Index, std::uint32_t>::value));
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // fill every slot
+   void test_pushback_fill()
+   {  // setup
+      custom::static_list<int, 5> l;
+      // exercise
+      for (int i = 0; i < 5; i++)
+         l.push_back(i);
+      // verify
+      assertUnit(l.full());
+      assertUnit(l.size() == 5);
+      assertUnit(isSequence(l, 0, 5));
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 4);
+   }  // teardown
+
+   // pushing onto a full list throws and leaves it alone
+   void test_pushback_full()
+   {  // setup
+      custom::static_list<int, 3> l{ 0, 1, 2 };
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.push_back(3);
+      }
+      catch (const char *)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+      assertUnit(l.size() == 3);
+      assertUnit(isSequence(l, 0, 3));
+   }  // teardown
+
+   // push onto the front
+   void test_pushfront_standard()
+   {  // setup
+      custom::static_list<int, 8> l;
+      // exercise
+      for (int i = 4; i >= 0; i--)
+         l.push_front(i);
+      // verify
+      assertUnit(isSequence(l, 0, 5));
+   }  // teardown
+
+   // insert in the middle
+   void test_insert_middle()
+   {  // setup
+      custom::static_list<int, 8> l{ 0, 1, 3, 4 };
+      custom::static_list<int, 8>::iterator it = std::find(l.begin(), l.end(), 3);
+      // exercise
+      it = l.insert(it, 2);
+      // verify
+      assertUnit(*it == 2);
+      assertUnit(isSequence(l, 0, 5));
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // the slot of an erased item is the next one used
+   void test_erase_reusesSlot()
+   {  // setup
+      custom::static_list<int, 4> l{ 0, 1, 2, 3 };
+      custom::static_list<int, 4>::iterator it = std::find(l.begin(), l.end(), 2);
+      size_t slot = it.i;
+      // exercise
+      it = l.erase(it);
+      custom::static_list<int, 4>::iterator itNew = l.insert(it, 2);
+      // verify
+      assertUnit(itNew.i == slot);
+      assertUnit(isSequence(l, 0, 4));
+      assertUnit(l.full());
+   }  // teardown
+
+   // pop from both ends
+   void test_pop_both()
+   {  // setup
+      custom::static_list<int, 8> l{ 0, 1, 2, 3 };
+      // exercise
+      l.pop_front();
+      l.pop_back();
+      // verify
+      assertUnit(isSequence(l, 1, 3));
+      l.pop_back();
+      l.pop_back();
+      l.pop_back();
+      assertUnit(l.empty());
+   }  // teardown
+
+   // after clear every slot can be used again
+   void test_clear_reusesSlots()
+   {  // setup
+      custom::static_list<int, 4> l{ 0, 1, 2, 3 };
+      // exercise
+      l.clear();
+      for (int i = 10; i < 14; i++)
+         l.push_back(i);
+      // verify
+      assertUnit(l.full());
+      assertUnit(l.numUsed == 4);
+      assertUnit(isSequence(l, 10, 14));
+   }  // teardown
+
+   // remove the odd items
+   void test_remove_if()
+   {  // setup
+      custom::static_list<int, 16> l;
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      // exercise
+      size_t numRemoved = l.remove_if([](int value) { return value % 2 == 1; });
+      // verify
+      assertUnit(numRemoved == 5);
+      assertUnit(l.size() == 5);
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 8);
+   }  // teardown
+
+   // removing by one of the list's own items compares against it to the end
+   void test_remove_ownItem()
+   {  // setup
+      custom::static_list<Spy, 8> l;
+      l.push_back(Spy(3));
+      l.push_back(Spy(1));
+      l.push_back(Spy(3));
+      l.push_back(Spy(2));
+      l.push_back(Spy(3));
+      Spy::reset();
+      // exercise
+      size_t numRemoved = l.remove(l.front());
+      // verify
+      assertUnit(numRemoved == 3);
+      assertUnit(Spy::numDestructor() == 3);
+      assertUnit(l.size() == 2);
+      assertUnit(l.front() == Spy(1));
+      assertUnit(l.back() == Spy(2));
+   }  // teardown
+
+   /***************************************
+    * OBJECTS
+    ***************************************/
+
+   // every item constructed is destroyed exactly once
+   void test_spy_destroyed()
+   {  // setup
+      Spy::reset();
+      {
+         custom::static_list<Spy, 6> l;
+         for (int i = 0; i < 6; i++)
+            l.push_back(Spy(i));
+         // exercise
+         l.pop_front();
+         l.erase(++l.begin());
+         l.push_back(Spy(6));
+      }
+      // verify
+      assertUnit(Spy::numAlloc() == Spy::numDelete());
+      assertUnit(Spy::numNondefault() + Spy::numCopy() + Spy::numCopyMove() ==
+                 Spy::numDestructor());
+   }  // teardown
+
+   // an rvalue is moved into its slot
+   void test_string_moved()
+   {  // setup
+      custom::static_list<std::string, 2> l;
+      std::string s(100, 'x');
+      // exercise
+      l.push_back(std::move(s));
+      // verify
+      assertUnit(s.empty());
+      assertUnit(l.front().size() == 100);
+   }  // teardown
+
+   /***************************************
+    * REORDER
+    ***************************************/
+
+   // assigning a shorter list frees the extra slots
+   void test_assign_shorter()
+   {  // setup
+      custom::static_list<int, 8> lSrc{ 7, 8 };
+      custom::static_list<int, 8> lDes{ 0, 1, 2, 3, 4 };
+      // exercise
+      lDes = lSrc;
+      // verify
+      assertUnit(isSequence(lDes, 7, 9));
+      lDes = { 0, 1, 2, 3, 4, 5, 6, 7 };
+      assertUnit(lDes.full());
+   }  // teardown
+
+   // swap lists of different lengths
+   void test_swap_uneven()
+   {  // setup
+      custom::static_list<int, 8> lLong{ 0, 1, 2, 3, 4 };
+      custom::static_list<int, 8> lShort{ 10, 11 };
+      // exercise
+      lLong.swap(lShort);
+      // verify
+      assertUnit(isSequence(lLong, 10, 12));
+      assertUnit(isSequence(lShort, 0, 5));
+      swap(lLong, lShort);
+      assertUnit(isSequence(lLong, 0, 5));
+      assertUnit(isSequence(lShort, 10, 12));
+   }  // teardown
+
+   // reverse in place
+   void test_reverse_standard()
+   {  // setup
+      custom::static_list<int, 8> l{ 4, 3, 2, 1, 0 };
+      // exercise
+      l.reverse();
+      // verify
+      assertUnit(isSequence(l, 0, 5));
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 4);
+   }  // teardown
+
+   // walk backwards from end()
+   void test_iterator_decrementEnd()
+   {  // setup
+      custom::static_list<int, 8> l{ 0, 1, 2 };
+      // exercise
+      int sum = 0;
+      int expected = 2;
+      bool ordered = true;
+      for (auto it = l.rbegin(); it != l.rend(); ++it)
+      {
+         ordered = ordered && *it == expected--;
+         sum += *it;
+      }
+      // verify
+      assertUnit(ordered);
+      assertUnit(sum == 3);
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // does the list hold first, first+1, ... last-1 ?
+   template <size_t N>
+   bool isSequence(const custom::static_list<int, N>& l, int first, int last)
+   {
+      int value = first;
+      for (auto it = l.begin(); it != l.end(); ++it)
+         if (*it != value++)
+            return false;
+      return value == last && l.size() == (size_t)(last - first);
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,390 @@
+/***********************************************************************
+ * Header:
+ *    TEST UNROLLED LIST
+ * Summary:
+ *    Unit tests for unrolled_list and the simd kernels it scans with
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "unrolledList.h"  // class under test
+#include "simd.h"          // kernels under test
+#include "unitTest.h"      // unit test baseclass
+
+#include <cstdint>         // for std::int64_t
+
+/***********************************************
+ * TEST UNROLLED LIST
+ * Unit tests for the unrolled_list class
+ ***********************************************/
+class TestUnrolledList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Insert
+      test_pushback_blocks();
+      test_pushfront_blocks();
+      test_insert_split();
+
+      // Remove
+      test_erase_middle();
+      test_erase_emptiesBlock();
+      test_pop_both();
+
+      // Iterator
+      test_iterator_decrementEnd();
+
+      // Search
+      test_find_int();
+      test_find_missing();
+      test_count_int();
+      test_minmax_int();
+      test_minmax_empty();
+      test_accumulate_int();
+      test_kernels_int64();
+      test_kernels_unsigned();
+      test_kernels_double();
+      test_kernels_float();
+
+      report("UnrolledList");
+   }
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // push more than a block's worth onto the back
+   void test_pushback_blocks()
+   {  // setup
+      custom::unrolled_list<int, 4> l;
+      // exercise
+      for (int i = 0; i < 10; i++)
+         l.push_back(i);
+      // verify
+      //    +---------+   +---------+   +-----+
+      //    | 0 1 2 3 | - | 4 5 6 7 | - | 8 9 |
+      //    +---------+   +---------+   +-----+
+      assertUnit(l.size() == 10);
+      assertUnit(numBlocks(l) == 3);
+      assertUnit(l.pHead->num == 4);
+      assertUnit(l.pTail->num == 2);
+      assertUnit(isSequence(l, 0, 10));
+      assertUnit(l.front() == 0);
+      assertUnit(l.back() == 9);
+   }  // teardown
+
+   // push onto the front of a list with a full first block
+   void test_pushfront_blocks()
+   {  // setup
+      custom::unrolled_list<int, 4> l;
+      for (int i = 4; i < 8; i++)
+         l.push_back(i);
+      // exercise
+      for (int i = 3; i >= 0; i--)
+         l.push_front(i);
+      // verify
+      assertUnit(l.size() == 8);
+      assertUnit(isSequence(l, 0, 8));
+   }  // teardown
+
+   // insert into the middle of a full block
+   void test_insert_split()
+   {  // setup
+      //    +---------+
+      //    | 0 1 3 4 |
+      //    +---------+
+      custom::unrolled_list<int, 4> l;
+      l.push_back(0);
+      l.push_back(1);
+      l.push_back(3);
+      l.push_back(4);
+      custom::unrolled_list<int, 4>::iterator it = l.begin();
+      ++it;
+      ++it;
+      // exercise
+      it = l.insert(it, 2);
+      // verify
+      //    +-------+   +-----+
+      //    | 0 1 2 | - | 3 4 |
+      //    +-------+   +-----+
+      assertUnit(*it == 2);
+      assertUnit(numBlocks(l) == 2);
+      assertUnit(l.pHead->num == 3);
+      assertUnit(l.pTail->num == 2);
+      assertUnit(isSequence(l, 0, 5));
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase from the middle of a block
+   void test_erase_middle()
+   {  // setup
+      custom::unrolled_list<int, 4> l;
+      for (int i = 0; i < 6; i++)
+         l.push_back(i == 2 ? 99 : i);
+      custom::unrolled_list<int, 4>::iterator it = l.find(99);
+      // exercise
+      it = l.erase(it);
+      // verify
+      assertUnit(*it == 3);
+      assertUnit(l.size() == 5);
+      assertUnit(l.count(99) == 0);
+   }  // teardown
+
+   // erase the only item of the last block
+   void test_erase_emptiesBlock()
+   {  // setup
+      custom::unrolled_list<int, 4> l;
+      for (int i = 0; i < 5; i++)
+         l.push_back(i);
+      custom::unrolled_list<int, 4>::iterator it = l.find(4);
+      // exercise
+      it = l.erase(it);
+      // verify
+      assertUnit(it == l.end());
+      assertUnit(numBlocks(l) == 1);
+      assertUnit(l.pTail == l.pHead);
+      assertUnit(isSequence(l, 0, 4));
+   }  // teardown
+
+   // pop everything off both ends
+   void test_pop_both()
+   {  // setup
+      custom::unrolled_list<int, 4> l;
+      for (int i = 0; i < 9; i++)
+         l.push_back(i);
+      // exercise
+      while (l.size() > 1)
+      {
+         l.pop_front();
+         l.pop_back();
+      }
+      // verify
+      assertUnit(l.size() == 1);
+      assertUnit(l.front() == 4);
+      l.pop_back();
+      assertUnit(l.empty());
+      assertUnit(l.pHead == nullptr);
+      assertUnit(l.pTail == nullptr);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walk backwards from end()
+   void test_iterator_decrementEnd()
+   {  // setup
+      custom::unrolled_list<int, 4> l;
+      for (int i = 0; i < 9; i++)
+         l.push_back(i);
+      custom::unrolled_list<int, 4>::iterator it = l.end();
+      // exercise
+      int expected = 8;
+      bool inOrder = true;
+      do
+      {
+         --it;
+         inOrder = inOrder && *it == expected--;
+      } while (it != l.begin());
+      // verify
+      assertUnit(inOrder);
+      assertUnit(expected == -1);
+   }  // teardown
+
+   /***************************************
+    * SEARCH
+    ***************************************/
+
+   // find the first match, which may be in any lane of any block
+   void test_find_int()
+   {  // setup
+      custom::unrolled_list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i % 300);
+      // exercise
+      custom::unrolled_list<int>::iterator it = l.find(257);
+      // verify
+      assertUnit(it != l.end());
+      assertUnit(*it == 257);
+      assertUnit(position(l, it) == 257);
+   }  // teardown
+
+   // look for something that is not there
+   void test_find_missing()
+   {  // setup
+      custom::unrolled_list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i);
+      // exercise
+      custom::unrolled_list<int>::iterator it = l.find(-5);
+      // verify
+      assertUnit(it == l.end());
+   }  // teardown
+
+   // count matches across blocks and leftover lanes
+   void test_count_int()
+   {  // setup
+      custom::unrolled_list<int, 13> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back(i % 7);
+      // exercise
+      size_t num = l.count(3);
+      // verify
+      assertUnit(num == 143);
+      assertUnit(l.count(7) == 0);
+   }  // teardown
+
+   // min and max over many blocks
+   void test_minmax_int()
+   {  // setup
+      custom::unrolled_list<int> l;
+      for (int i = 0; i < 1000; i++)
+         l.push_back((i * 37) % 1001 - 500);
+      // exercise
+      int smallest = l.min();
+      int largest  = l.max();
+      // verify
+      assertUnit(smallest == -500);
+      assertUnit(largest  == 500);
+   }  // teardown
+
+   // min of an empty list throws
+   void test_minmax_empty()
+   {  // setup
+      custom::unrolled_list<int> l;
+      bool thrown = false;
+      // exercise
+      try
+      {
+         l.min();
+      }
+      catch (const char * sError)
+      {
+         thrown = true;
+      }
+      // verify
+      assertUnit(thrown);
+   }  // teardown
+
+   // sum everything, with a starting value
+   void test_accumulate_int()
+   {  // setup
+      custom::unrolled_list<int, 10> l;
+      for (int i = 1; i <= 1000; i++)
+         l.push_back(i);
+      // exercise
+      int sum = l.accumulate(7);
+      // verify
+      assertUnit(sum == 500500 + 7);
+   }  // teardown
+
+   // the 64 bit kernels agree with the scalar loops
+   void test_kernels_int64()
+   {  // setup
+      std::int64_t values[37];
+      for (int i = 0; i < 37; i++)
+         values[i] = ((std::int64_t)(i % 5) << 33) + (i % 3);
+      // exercise and verify
+      for (size_t n = 0; n <= 37; n++)
+      {
+         std::int64_t target = ((std::int64_t)2 << 33) + 1;
+         assertUnit(custom::simd::find (values, n, target) == custom::simd::scalar::find (values, n, target));
+         assertUnit(custom::simd::count(values, n, target) == custom::simd::scalar::count(values, n, target));
+         assertUnit(custom::simd::accumulate(values, n, (std::int64_t)3) ==
+                    custom::simd::scalar::accumulate(values, n, (std::int64_t)3));
+      }
+      // only the high half matches: must not count
+      std::int64_t highOnly = (std::int64_t)2 << 33;
+      assertUnit(custom::simd::count(values, 37, highOnly) == custom::simd::scalar::count(values, 37, highOnly));
+   }  // teardown
+
+   // unsigned min and max compare as unsigned
+   void test_kernels_unsigned()
+   {  // setup
+      custom::unrolled_list<unsigned int> l;
+      for (unsigned int i = 0; i < 100; i++)
+         l.push_back(i == 50 ? 0xFFFFFFF0u : i + 10);
+      // exercise
+      unsigned int smallest = l.min();
+      unsigned int largest  = l.max();
+      // verify
+      assertUnit(smallest == 10);
+      assertUnit(largest  == 0xFFFFFFF0u);
+      assertUnit(l.count(0xFFFFFFF0u) == 1);
+   }  // teardown
+
+   // double equality kernels
+   void test_kernels_double()
+   {  // setup
+      custom::unrolled_list<double> l;
+      for (int i = 0; i < 500; i++)
+         l.push_back(i * 0.5);
+      // exercise
+      custom::unrolled_list<double>::iterator it = l.find(100.5);
+      // verify
+      assertUnit(it != l.end());
+      assertUnit(position(l, it) == 201);
+      assertUnit(l.count(100.5) == 1);
+      assertUnit(l.min() == 0.0);
+      assertUnit(l.max() == 249.5);
+   }  // teardown
+
+   // float equality kernels, including leftover lanes
+   void test_kernels_float()
+   {  // setup
+      float values[23];
+      for (int i = 0; i < 23; i++)
+         values[i] = (float)(i % 4);
+      // exercise and verify
+      for (size_t n = 0; n <= 23; n++)
+      {
+         assertUnit(custom::simd::find (values, n, 3.0f) == custom::simd::scalar::find (values, n, 3.0f));
+         assertUnit(custom::simd::count(values, n, 3.0f) == custom::simd::scalar::count(values, n, 3.0f));
+      }
+   }  // teardown
+
+   /****************************************************************
+    * Helpers
+    ****************************************************************/
+
+   // number of blocks in the list
+   template <typename T, size_t N>
+   size_t numBlocks(const custom::unrolled_list<T, N>& l)
+   {
+      size_t num = 0;
+      for (auto p = l.pHead; p; p = p->pNext)
+         num++;
+      return num;
+   }
+
+   // does the list hold first, first+1, ... last-1 ?
+   template <size_t N>
+   bool isSequence(custom::unrolled_list<int, N>& l, int first, int last)
+   {
+      int value = first;
+      for (auto it = l.begin(); it != l.end(); ++it)
+         if (*it != value++)
+            return false;
+      return value == last && l.size() == (size_t)(last - first);
+   }
+
+   // how far an iterator is from the beginning
+   template <typename T, size_t N>
+   size_t position(custom::unrolled_list<T, N>& l, typename custom::unrolled_list<T, N>::iterator itFind)
+   {
+      size_t num = 0;
+      for (auto it = l.begin(); it != itFind; ++it)
+         num++;
+      return num;
+   }
+};
+
+#endif // DEBUG
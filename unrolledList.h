@@ -0,0 +1,429 @@
+/***********************************************************************
+ * Header:
+ *    UNROLLED LIST
+ * Summary:
+ *    A list that keeps up to N items in each node. Walking it touches
+ *    one node per N items instead of one per item, and the items in a
+ *    node sit side by side so find(), count(), min(), max() and
+ *    accumulate() can hand each block to the vector kernels in simd.h.
+ *
+ *    Items are moved around with memmove when a block is shifted or
+ *    split, so T must be trivially copyable.
+ *
+ *    This will contain the class definition of:
+ *        unrolled_list           : A list of blocks
+ *        unrolled_list::iterator : An iterator through the unrolled list
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>       // for ASSERT
+#include <cstddef>       // for size_t
+#include <cstring>       // for std::memmove
+#include <new>           // for placement new
+#include <type_traits>   // for std::is_trivially_copyable
+#include "simd.h"        // for the block kernels
+
+namespace custom
+{
+
+/**************************************************
+ * UNROLLED LIST
+ * A doubly linked list of blocks of N items
+ **************************************************/
+template <typename T, size_t N = 64>
+class unrolled_list
+{
+   static_assert(std::is_trivially_copyable<T>::value,
+                 "unrolled_list requires a trivially copyable type");
+   static_assert(N >= 2, "unrolled_list needs at least two items per block");
+public:
+
+   //
+   // Construct
+   //
+
+   unrolled_list() : numElements(0), pHead(nullptr), pTail(nullptr) { }
+   unrolled_list(const unrolled_list &) = delete;
+   unrolled_list & operator = (const unrolled_list &) = delete;
+   ~unrolled_list() { clear(); }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() { return iterator(this, pHead, 0); }
+   iterator end()   { return iterator(this, nullptr, 0); }
+
+   //
+   // Access
+   //
+
+   T & front();
+   T & back();
+
+   //
+   // Insert
+   //
+
+   void push_front(const T & data) { insert(begin(), data); }
+   void push_back (const T & data);
+   iterator insert(iterator it, const T & data);
+
+   //
+   // Remove
+   //
+
+   void pop_back();
+   void pop_front();
+   void clear();
+   iterator erase(const iterator & it);
+
+   //
+   // Search, one block at a time
+   //
+
+   iterator find(const T & value);
+   size_t   count(const T & value) const;
+   T        min() const;
+   T        max() const;
+   T        accumulate(T init) const;
+
+   //
+   // Status
+   //
+
+   bool   empty() const { return numElements == 0; }
+   size_t size()  const { return numElements;      }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+
+   // a node holding up to N items in a row
+   struct Block
+   {
+      Block() : pNext(nullptr), pPrev(nullptr), num(0) { }
+      T       * data()       { return reinterpret_cast<T       *>(storage); }
+      const T * data() const { return reinterpret_cast<const T *>(storage); }
+
+      Block * pNext;
+      Block * pPrev;
+      size_t  num;
+      alignas(T) unsigned char storage[N * sizeof(T)];
+   };
+
+   Block * newBlockAfter(Block * pBlock);
+
+   size_t  numElements; // items in all the blocks
+   Block * pHead;       // first block
+   Block * pTail;       // last block
+};
+
+/*************************************************
+ * UNROLLED LIST ITERATOR
+ * A block and a position within it
+ ************************************************/
+template <typename T, size_t N>
+class unrolled_list <T, N> ::iterator
+{
+   friend class unrolled_list <T, N>;
+public:
+   iterator() : pList(nullptr), pBlock(nullptr), index(0) { }
+   iterator(unrolled_list * pList, Block * pBlock, size_t index) :
+      pList(pList), pBlock(pBlock), index(index) { }
+
+   bool operator == (const iterator & rhs) const
+   {
+      return pBlock == rhs.pBlock && index == rhs.index;
+   }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs); }
+
+   T & operator * () { return pBlock->data()[index]; }
+
+   iterator & operator ++ ()
+   {
+      if (++index == pBlock->num)
+      {
+         pBlock = pBlock->pNext;
+         index = 0;
+      }
+      return *this;
+   }
+   iterator operator ++ (int postfix)
+   {
+      iterator itOld(*this);
+      ++(*this);
+      return itOld;
+   }
+   iterator & operator -- ()
+   {
+      if (pBlock == nullptr)
+      {
+         pBlock = pList->pTail;
+         index = pBlock->num - 1;
+      }
+      else if (index == 0)
+      {
+         pBlock = pBlock->pPrev;
+         index = pBlock->num - 1;
+      }
+      else
+         index--;
+      return *this;
+   }
+   iterator operator -- (int postfix)
+   {
+      iterator itOld(*this);
+      --(*this);
+      return itOld;
+   }
+
+#ifdef DEBUG // make this visible to the unit tests
+public:
+#else
+private:
+#endif
+   unrolled_list * pList;
+   Block * pBlock;
+   size_t  index;
+};
+
+/*****************************************
+ * UNROLLED LIST :: NEW BLOCK AFTER
+ * Link an empty block after pBlock, or at the
+ * front when pBlock is NULL
+ ****************************************/
+template <typename T, size_t N>
+typename unrolled_list <T, N> ::Block * unrolled_list <T, N> ::newBlockAfter(Block * pBlock)
+{
+   Block * pNew = new Block;
+   pNew->pPrev = pBlock;
+   pNew->pNext = pBlock ? pBlock->pNext : pHead;
+   if (pNew->pNext)
+      pNew->pNext->pPrev = pNew;
+   else
+      pTail = pNew;
+   if (pBlock)
+      pBlock->pNext = pNew;
+   else
+      pHead = pNew;
+   return pNew;
+}
+
+/*****************************************
+ * UNROLLED LIST :: FRONT and BACK
+ ****************************************/
+template <typename T, size_t N>
+T & unrolled_list <T, N> ::front()
+{
+   if (pHead == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return pHead->data()[0];
+}
+
+template <typename T, size_t N>
+T & unrolled_list <T, N> ::back()
+{
+   if (pTail == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   return pTail->data()[pTail->num - 1];
+}
+
+/*****************************************
+ * UNROLLED LIST :: PUSH BACK
+ * Fill the last block, starting a new one when full
+ *     COST : O(1)
+ ****************************************/
+template <typename T, size_t N>
+void unrolled_list <T, N> ::push_back(const T & data)
+{
+   if (pTail == nullptr || pTail->num == N)
+      newBlockAfter(pTail);
+   new (pTail->data() + pTail->num) T(data);
+   pTail->num++;
+   numElements++;
+}
+
+/*****************************************
+ * UNROLLED LIST :: INSERT
+ * Put data before it. A full block is split in half
+ * first so later inserts nearby are cheap
+ *     COST : O(N)
+ ****************************************/
+template <typename T, size_t N>
+typename unrolled_list <T, N> ::iterator unrolled_list <T, N> ::insert(iterator it,
+                                                                      const T & data)
+{
+   if (it.pBlock == nullptr)
+   {
+      push_back(data);
+      return iterator(this, pTail, pTail->num - 1);
+   }
+
+   Block * pBlock = it.pBlock;
+   size_t index = it.index;
+   if (pBlock->num == N)
+   {
+      Block * pNew = newBlockAfter(pBlock);
+      size_t keep = N / 2;
+      std::memcpy(pNew->data(), pBlock->data() + keep, (N - keep) * sizeof(T));
+      pNew->num = N - keep;
+      pBlock->num = keep;
+      if (index > keep)
+      {
+         pBlock = pNew;
+         index -= keep;
+      }
+   }
+
+   T * p = pBlock->data();
+   std::memmove(p + index + 1, p + index, (pBlock->num - index) * sizeof(T));
+   new (p + index) T(data);
+   pBlock->num++;
+   numElements++;
+   return iterator(this, pBlock, index);
+}
+
+/*****************************************
+ * UNROLLED LIST :: ERASE
+ * Remove the item at it. A block that becomes empty
+ * is unlinked and freed
+ *     COST : O(N)
+ ****************************************/
+template <typename T, size_t N>
+typename unrolled_list <T, N> ::iterator unrolled_list <T, N> ::erase(const iterator & it)
+{
+   if (it.pBlock == nullptr)
+      return end();
+
+   Block * pBlock = it.pBlock;
+   T * p = pBlock->data();
+   std::memmove(p + it.index, p + it.index + 1, (pBlock->num - it.index - 1) * sizeof(T));
+   pBlock->num--;
+   numElements--;
+
+   if (pBlock->num == 0)
+   {
+      Block * pNext = pBlock->pNext;
+      if (pBlock->pPrev)
+         pBlock->pPrev->pNext = pNext;
+      else
+         pHead = pNext;
+      if (pNext)
+         pNext->pPrev = pBlock->pPrev;
+      else
+         pTail = pBlock->pPrev;
+      delete pBlock;
+      return iterator(this, pNext, 0);
+   }
+
+   if (it.index == pBlock->num)
+      return iterator(this, pBlock->pNext, 0);
+   return iterator(this, pBlock, it.index);
+}
+
+/*****************************************
+ * UNROLLED LIST :: POP FRONT and POP BACK
+ ****************************************/
+template <typename T, size_t N>
+void unrolled_list <T, N> ::pop_front()
+{
+   if (!empty())
+      erase(begin());
+}
+
+template <typename T, size_t N>
+void unrolled_list <T, N> ::pop_back()
+{
+   if (!empty())
+      erase(iterator(this, pTail, pTail->num - 1));
+}
+
+/*****************************************
+ * UNROLLED LIST :: CLEAR
+ *     COST : O(n/N)
+ ****************************************/
+template <typename T, size_t N>
+void unrolled_list <T, N> ::clear()
+{
+   while (pHead)
+   {
+      Block * pDelete = pHead;
+      pHead = pHead->pNext;
+      delete pDelete;
+   }
+   pTail = nullptr;
+   numElements = 0;
+}
+
+/*****************************************
+ * UNROLLED LIST :: FIND
+ * The first item equal to value, or end()
+ ****************************************/
+template <typename T, size_t N>
+typename unrolled_list <T, N> ::iterator unrolled_list <T, N> ::find(const T & value)
+{
+   for (Block * p = pHead; p; p = p->pNext)
+   {
+      size_t index = simd::find(p->data(), p->num, value);
+      if (index != p->num)
+         return iterator(this, p, index);
+   }
+   return end();
+}
+
+/*****************************************
+ * UNROLLED LIST :: COUNT
+ * The number of items equal to value
+ ****************************************/
+template <typename T, size_t N>
+size_t unrolled_list <T, N> ::count(const T & value) const
+{
+   size_t num = 0;
+   for (const Block * p = pHead; p; p = p->pNext)
+      num += simd::count(p->data(), p->num, value);
+   return num;
+}
+
+/*****************************************
+ * UNROLLED LIST :: MIN and MAX
+ ****************************************/
+template <typename T, size_t N>
+T unrolled_list <T, N> ::min() const
+{
+   if (pHead == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   T best = pHead->data()[0];
+   for (const Block * p = pHead; p; p = p->pNext)
+      best = simd::min(p->data(), p->num, best);
+   return best;
+}
+
+template <typename T, size_t N>
+T unrolled_list <T, N> ::max() const
+{
+   if (pHead == nullptr)
+      throw "ERROR: unable to access data from an empty list";
+   T best = pHead->data()[0];
+   for (const Block * p = pHead; p; p = p->pNext)
+      best = simd::max(p->data(), p->num, best);
+   return best;
+}
+
+/*****************************************
+ * UNROLLED LIST :: ACCUMULATE
+ * init plus every item, like std::accumulate
+ ****************************************/
+template <typename T, size_t N>
+T unrolled_list <T, N> ::accumulate(T init) const
+{
+   for (const Block * p = pHead; p; p = p->pNext)
+      init = simd::accumulate(p->data(), p->num, init);
+   return init;
+}
+
+} // namespace custom